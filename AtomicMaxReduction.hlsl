@@ -0,0 +1,52 @@
+// Single pass max reduction - every thread group reduces its tile in groupshared memory and
+// merges the result into one global UINT with InterlockedMax, no intermediate buffer and no
+// reduction of partials afterwards. outputBuffer[0] has to be cleared to 0 before the dispatch.
+//
+// Input - R8_UNORM/uint inputTexture
+// Output - uint - Max value of the whole texture in outputBuffer[0]
+//
+// API - DX12 12_0
+// Shader Model - cs_5_1
+// Root signature - same as CompuetShader.hlsl, SRV table (t0), UAV table (u0), the root constants are unused
+//
+// built at compile time into ShaderPermutations.cpp, one permutation per ShaderPermutation item in test1.vcxproj
+// equivalent cmdline - fxc /T cs_5_1 /D THREAD_GROUP_SIZE=16 /Vn g_AtomicMaxReduction16x16x1 /Fh AtomicMaxReduction16x16x1.h /E CSMain AtomicMaxReduction.hlsl
+
+// thread group size - 8/16/32, passed with /D for each permutation
+#ifndef THREAD_GROUP_SIZE
+#define THREAD_GROUP_SIZE 32
+#endif
+#define THREAD_COUNT (THREAD_GROUP_SIZE * THREAD_GROUP_SIZE)
+
+// input texture
+Texture2D<uint> inputTexture : register(t0);
+
+// output buffer, a single element
+RWStructuredBuffer<uint> outputBuffer : register(u0);
+
+groupshared uint sharedData[THREAD_COUNT];
+
+[numthreads(THREAD_GROUP_SIZE, THREAD_GROUP_SIZE, 1)]
+void CSMain(uint3 DTid : SV_DispatchThreadID, uint GI : SV_GroupIndex)
+{
+    // out of bounds loads return 0, the identity for max
+    sharedData[GI] = inputTexture.Load(int3(DTid.xy, 0)).r;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    // tree reduction over the whole tile, not only along x
+    for (uint stride = THREAD_COUNT / 2; stride > 0; stride >>= 1)
+    {
+        if (GI < stride)
+        {
+            sharedData[GI] = max(sharedData[GI], sharedData[GI + stride]);
+        }
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    // one global atomic per group
+    if (GI == 0)
+    {
+        InterlockedMax(outputBuffer[0], sharedData[0]);
+    }
+}
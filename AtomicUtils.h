@@ -0,0 +1,23 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// std::atomic<T>::fetch_max for C++17 (the member only arrives with C++26).
+// Returns the previous value, retries receives the number of failed compare-exchanges,
+// which is the contention cost of the update.
+template <typename T>
+T AtomicFetchMax(std::atomic<T>& target, T value, uint64_t* retries = nullptr)
+{
+    T previous = target.load(std::memory_order_relaxed);
+    uint64_t failed = 0;
+    while (previous < value && !target.compare_exchange_weak(previous, value, std::memory_order_relaxed))
+    {
+        ++failed;
+    }
+    if (retries)
+    {
+        *retries += failed;
+    }
+    return previous;
+}
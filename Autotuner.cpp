@@ -0,0 +1,200 @@
+#include "Autotuner.h"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    const char* const TuningDatabaseHeader = "# ReductionTuningDatabase 3";
+
+    const char* GetTexelFormatName(TexelFormat format)
+    {
+        switch (format)
+        {
+        case TexelFormat::R8:
+            return "r8";
+        case TexelFormat::R16:
+            return "r16";
+        case TexelFormat::R32:
+            return "r32";
+        }
+        return "unknown";
+    }
+
+    TexelFormat ParseTexelFormat(const std::string& name)
+    {
+        for (TexelFormat format : { TexelFormat::R8, TexelFormat::R16, TexelFormat::R32 })
+        {
+            if (name == GetTexelFormatName(format))
+            {
+                return format;
+            }
+        }
+        throw std::runtime_error("Unknown texel format in tuning database: " + name);
+    }
+
+    std::string MakeKeyString(const TuningKey& key)
+    {
+        return key.deviceId + "\t" + key.backend + "\t" + key.strategy + "\t" + GetTexelFormatName(key.format) + "\t" +
+            std::to_string(key.width) + "\t" + std::to_string(key.height);
+    }
+}
+
+void TuningDatabase::Load(const std::string& filename)
+{
+    std::ifstream file(filename);
+    if (!file.is_open())
+    {
+        return;
+    }
+
+    std::string line;
+    while (std::getline(file, line))
+    {
+        if (!line.empty() && line.back() == '\r')
+        {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] == '#')
+        {
+            continue;
+        }
+
+        std::vector<std::string> fields;
+        std::istringstream columns(line);
+        std::string field;
+        while (std::getline(columns, field, '\t'))
+        {
+            fields.push_back(field);
+        }
+        if (fields.size() < 9 || fields.size() > 11)
+        {
+            throw std::runtime_error("Malformed tuning database entry in " + filename + ": " + line);
+        }
+
+        TuningEntry entry;
+        try
+        {
+            entry.key.deviceId = fields[0];
+            entry.key.backend = fields[1];
+            entry.key.strategy = fields[2];
+            entry.key.format = ParseTexelFormat(fields[3]);
+            entry.key.width = static_cast<uint32_t>(std::stoul(fields[4]));
+            entry.key.height = static_cast<uint32_t>(std::stoul(fields[5]));
+            entry.variant.threadGroupSize = static_cast<uint32_t>(std::stoul(fields[6]));
+            entry.variant.workerCount = static_cast<unsigned int>(std::stoul(fields[7]));
+            if (fields.size() == 11)
+            {
+                entry.variant.tileWidth = static_cast<uint32_t>(std::stoul(fields[8]));
+                entry.variant.tileHeight = static_cast<uint32_t>(std::stoul(fields[9]));
+            }
+            entry.medianMs = std::stod(fields.back());
+        }
+        catch (const std::logic_error&)
+        {
+            throw std::runtime_error("Malformed tuning database entry in " + filename + ": " + line);
+        }
+        Store(entry);
+    }
+}
+
+void TuningDatabase::Save(const std::string& filename) const
+{
+    std::ofstream file(filename, std::ios::trunc);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open " + filename + " for writing");
+    }
+
+    file << TuningDatabaseHeader << std::endl;
+    for (const auto& entry : m_entries)
+    {
+        file << entry.first << "\t" << entry.second.variant.threadGroupSize << "\t" << entry.second.variant.workerCount
+            << "\t" << entry.second.variant.tileWidth << "\t" << entry.second.variant.tileHeight << "\t" << entry.second.medianMs << std::endl;
+    }
+    if (!file)
+    {
+        throw std::runtime_error("Failed to write " + filename);
+    }
+}
+
+const TuningEntry* TuningDatabase::Find(const TuningKey& key) const
+{
+    auto it = m_entries.find(MakeKeyString(key));
+    return it != m_entries.end() ? &it->second : nullptr;
+}
+
+void TuningDatabase::Store(const TuningEntry& entry)
+{
+    // Tabs and line breaks would split the entry when it is read back
+    const std::string keyString = MakeKeyString(entry.key);
+    if (keyString.find('\n') != std::string::npos || std::count(keyString.begin(), keyString.end(), '\t') != 5)
+    {
+        throw std::runtime_error("Tuning key fields must not contain tabs or line breaks");
+    }
+    m_entries[keyString] = entry;
+}
+
+BenchmarkOptions ReductionAutotuner::GetDefaultTuningOptions()
+{
+    BenchmarkOptions options;
+    options.warmupRuns = 2;
+    options.minRuns = 5;
+    options.maxRuns = 30;
+    options.targetRelativeCi = 0.05;
+    return options;
+}
+
+ReductionAutotuner::ReductionAutotuner(TuningDatabase& database, const BenchmarkOptions& options)
+    : m_database(database), m_options(options)
+{
+}
+
+TuningVariant ReductionAutotuner::Select(IReductionBackend& backend, const TuningKey& key, bool* tuned)
+{
+    if (tuned)
+    {
+        *tuned = false;
+    }
+    if (const TuningEntry* entry = m_database.Find(key))
+    {
+        backend.ApplyTuningVariant(entry->variant);
+        return entry->variant;
+    }
+
+    const std::vector<TuningVariant> variants = backend.GetTuningVariants();
+    if (variants.empty())
+    {
+        throw std::runtime_error(std::string("Backend ") + backend.GetName() + " has no tuning variants");
+    }
+
+    // Median, not mean: a single preempted run must not decide the winner
+    TuningEntry best;
+    best.key = key;
+    bool first = true;
+    for (const TuningVariant& variant : variants)
+    {
+        backend.ApplyTuningVariant(variant);
+        BenchmarkStats stats = RunBenchmark(m_options, [&]()
+        {
+            backend.Dispatch(variant.threadGroupSize);
+            return backend.GetLastDispatchTimeMs();
+        });
+        if (first || stats.medianMs < best.medianMs)
+        {
+            best.variant = variant;
+            best.medianMs = stats.medianMs;
+            first = false;
+        }
+    }
+
+    m_database.Store(best);
+    backend.ApplyTuningVariant(best.variant);
+    if (tuned)
+    {
+        *tuned = true;
+    }
+    return best.variant;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "BenchmarkHarness.h"
+#include "ReductionBackend.h"
+#include "SimdReduction.h"
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <string>
+
+// Picks the fastest TuningVariant of a backend once per (device, backend, strategy, format, size)
+// and remembers it in a tuning database file, so later runs skip the sweep. IReductionBackend::SetAutotuner
+// consults it per texture size behind Dispatch and Submit.
+
+struct TuningEntry
+{
+    TuningKey key;
+    TuningVariant variant;
+    double medianMs = 0.0;      // of the winning variant when it was tuned
+};
+
+// Text file, one tab separated entry per line:
+// deviceId backend strategy format width height threadGroupSize workerCount tileWidth tileHeight medianMs
+// Entries of older files, tuned over threadGroupSize wide CPU tiles, load with the default host tile.
+class TuningDatabase
+{
+public:
+    // A missing file is an empty database, a malformed one throws
+    void Load(const std::string& filename);
+    void Save(const std::string& filename) const;
+
+    const TuningEntry* Find(const TuningKey& key) const;
+    void Store(const TuningEntry& entry);
+
+    size_t Size() const { return m_entries.size(); }
+
+private:
+    std::map<std::string, TuningEntry> m_entries;
+};
+
+class ReductionAutotuner
+{
+public:
+    // Tuning runs are shorter than a full benchmark, they only have to rank the variants
+    static BenchmarkOptions GetDefaultTuningOptions();
+
+    explicit ReductionAutotuner(TuningDatabase& database, const BenchmarkOptions& options = GetDefaultTuningOptions());
+
+    // Variant for key, applied to backend. On a database miss every GetTuningVariants() candidate is
+    // benchmarked on the texture currently uploaded to backend and the lowest median is stored.
+    // tuned reports whether this call ran the sweep.
+    TuningVariant Select(IReductionBackend& backend, const TuningKey& key, bool* tuned = nullptr);
+
+private:
+    TuningDatabase& m_database;
+    BenchmarkOptions m_options;
+};
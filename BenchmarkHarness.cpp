@@ -0,0 +1,249 @@
+#include "BenchmarkHarness.h"
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace
+{
+    // Linear interpolation between the closest ranks, sorted has to be sorted and non-empty
+    double Percentile(const std::vector<double>& sorted, double fraction)
+    {
+        const double rank = fraction * (sorted.size() - 1);
+        const size_t lower = static_cast<size_t>(rank);
+        const size_t upper = std::min(lower + 1, sorted.size() - 1);
+        return sorted[lower] + (sorted[upper] - sorted[lower]) * (rank - lower);
+    }
+
+    // Two-sided 95% quantile of Student's t distribution with degrees of freedom df
+    double StudentT95(size_t df)
+    {
+        static const double table[] =
+        {
+            12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+            2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+            2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+        };
+        if (df == 0)
+        {
+            return INFINITY;
+        }
+        if (df <= sizeof(table) / sizeof(table[0]))
+        {
+            return table[df - 1];
+        }
+        return df <= 60 ? 2.000 : (df <= 120 ? 1.980 : 1.960);
+    }
+
+    // JSON has no infinity, an undefined interval becomes null
+    std::string JsonNumber(double value)
+    {
+        if (!std::isfinite(value))
+        {
+            return "null";
+        }
+        std::ostringstream text;
+        text << value;
+        return text.str();
+    }
+
+    // Backend names and the like never need more than quote escaping
+    std::string JsonString(const std::string& value)
+    {
+        std::string escaped = "\"";
+        for (char c : value)
+        {
+            if (c == '"' || c == '\\')
+            {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped + "\"";
+    }
+}
+
+BenchmarkStats ComputeBenchmarkStats(const std::vector<double>& samplesMs, double outlierThreshold)
+{
+    BenchmarkStats stats;
+    stats.samples = samplesMs.size();
+    if (samplesMs.empty())
+    {
+        return stats;
+    }
+
+    std::vector<double> sorted = samplesMs;
+    std::sort(sorted.begin(), sorted.end());
+    stats.minMs = sorted.front();
+    stats.maxMs = sorted.back();
+    stats.medianMs = Percentile(sorted, 0.5);
+    stats.p95Ms = Percentile(sorted, 0.95);
+    stats.p99Ms = Percentile(sorted, 0.99);
+
+    std::vector<double> deviations(sorted.size());
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+        deviations[i] = std::fabs(sorted[i] - stats.medianMs);
+    }
+    std::sort(deviations.begin(), deviations.end());
+    const double mad = Percentile(deviations, 0.5);
+
+    // With MAD 0 (more than half the samples identical) every other value would be an outlier, keep all
+    double sum = 0.0;
+    size_t kept = 0;
+    std::vector<double> inliers;
+    inliers.reserve(sorted.size());
+    for (double sample : sorted)
+    {
+        if (outlierThreshold > 0.0 && mad > 0.0 && 0.6745 * std::fabs(sample - stats.medianMs) / mad > outlierThreshold)
+        {
+            ++stats.outliers;
+            continue;
+        }
+        inliers.push_back(sample);
+        sum += sample;
+        ++kept;
+    }
+
+    stats.meanMs = sum / kept;
+    if (kept > 1)
+    {
+        double squares = 0.0;
+        for (double sample : inliers)
+        {
+            squares += (sample - stats.meanMs) * (sample - stats.meanMs);
+        }
+        stats.stddevMs = std::sqrt(squares / (kept - 1));
+        stats.ciHalfWidthMs = StudentT95(kept - 1) * stats.stddevMs / std::sqrt(static_cast<double>(kept));
+    }
+    else
+    {
+        stats.ciHalfWidthMs = INFINITY;
+    }
+    return stats;
+}
+
+BenchmarkStats RunBenchmark(const BenchmarkOptions& options, const std::function<double()>& runOnce, std::vector<double>* samplesMs)
+{
+    if (options.minRuns == 0 || options.maxRuns < options.minRuns)
+    {
+        throw std::runtime_error("Benchmark needs 0 < minRuns <= maxRuns");
+    }
+
+    for (uint32_t i = 0; i < options.warmupRuns; ++i)
+    {
+        runOnce();
+    }
+
+    std::vector<double> samples;
+    samples.reserve(options.minRuns);
+    BenchmarkStats stats;
+    while (samples.size() < options.maxRuns)
+    {
+        samples.push_back(runOnce());
+        if (samples.size() < options.minRuns)
+        {
+            continue;
+        }
+
+        stats = ComputeBenchmarkStats(samples, options.outlierThreshold);
+        if (stats.ciHalfWidthMs <= options.targetRelativeCi * stats.meanMs)
+        {
+            stats.converged = true;
+            break;
+        }
+    }
+
+    if (samplesMs)
+    {
+        *samplesMs = std::move(samples);
+    }
+    return stats;
+}
+
+std::function<double()> MakeMockTimingSource(double baseMs, double jitter, double outlierRate, double outlierFactor, uint64_t seed)
+{
+    // Own engine per source so two sources never perturb each other's sequence
+    auto engine = std::make_shared<std::mt19937_64>(seed);
+    return [=]()
+    {
+        std::normal_distribution<double> noise(0.0, jitter);
+        std::uniform_real_distribution<double> chance(0.0, 1.0);
+        if (chance(*engine) < outlierRate)
+        {
+            return baseMs * outlierFactor;
+        }
+        return std::max(0.0, baseMs * (1.0 + noise(*engine)));
+    };
+}
+
+void WriteBenchmarkSummary(std::ostream& out, const std::string& timeLabel, const BenchmarkStats& stats)
+{
+    out << timeLabel << "median " << stats.medianMs << " ms, mean " << stats.meanMs << " ms +- " << stats.ciHalfWidthMs
+        << " ms (95% CI), stddev " << stats.stddevMs << " ms, p95 " << stats.p95Ms << " ms, p99 " << stats.p99Ms << " ms" << std::endl;
+    out << "Runs: " << stats.samples << ", outliers: " << stats.outliers << (stats.converged ? "" : ", CI target not reached") << std::endl;
+}
+
+void WriteBenchmarkJson(std::ostream& out, const std::vector<BenchmarkResult>& results)
+{
+    out << "[" << std::endl;
+    for (size_t i = 0; i < results.size(); ++i)
+    {
+        const BenchmarkResult& result = results[i];
+        const BenchmarkStats& stats = result.stats;
+        out << "  { \"backend\": " << JsonString(result.backend)
+            << ", \"strategy\": " << JsonString(result.strategy)
+            << ", \"distribution\": " << JsonString(result.distribution)
+            << ", \"width\": " << result.width
+            << ", \"height\": " << result.height
+            << ", \"threadGroupSize\": " << result.threadGroupSize
+            << ", \"maxValue\": " << result.maxValue;
+        if (result.hasAtomicStats)
+        {
+            out << ", \"deviceAtomics\": " << result.deviceAtomics
+                << ", \"atomicRetries\": " << result.atomicRetries;
+        }
+        out << ", \"samples\": " << stats.samples
+            << ", \"outliers\": " << stats.outliers
+            << ", \"minMs\": " << stats.minMs
+            << ", \"maxMs\": " << stats.maxMs
+            << ", \"medianMs\": " << stats.medianMs
+            << ", \"p95Ms\": " << stats.p95Ms
+            << ", \"p99Ms\": " << stats.p99Ms
+            << ", \"meanMs\": " << stats.meanMs
+            << ", \"stddevMs\": " << stats.stddevMs
+            << ", \"ciHalfWidthMs\": " << JsonNumber(stats.ciHalfWidthMs)
+            << ", \"converged\": " << (stats.converged ? "true" : "false")
+            << ", \"samplesMs\": [";
+        for (size_t j = 0; j < result.samplesMs.size(); ++j)
+        {
+            out << (j ? ", " : "") << result.samplesMs[j];
+        }
+        out << "] }" << (i + 1 < results.size() ? "," : "") << std::endl;
+    }
+    out << "]" << std::endl;
+}
+
+void WriteBenchmarkCsv(std::ostream& out, const std::vector<BenchmarkResult>& results)
+{
+    out << "backend,strategy,distribution,width,height,threadGroupSize,maxValue,deviceAtomics,atomicRetries,samples,outliers,minMs,maxMs,medianMs,p95Ms,p99Ms,meanMs,stddevMs,ciHalfWidthMs,converged" << std::endl;
+    for (const BenchmarkResult& result : results)
+    {
+        const BenchmarkStats& stats = result.stats;
+        out << result.backend << "," << result.strategy << "," << result.distribution << ","
+            << result.width << "," << result.height << "," << result.threadGroupSize << "," << result.maxValue << ",";
+        if (result.hasAtomicStats)
+        {
+            out << result.deviceAtomics << "," << result.atomicRetries << ",";
+        }
+        else
+        {
+            out << ",,";
+        }
+        out << stats.samples << "," << stats.outliers << ","
+            << stats.minMs << "," << stats.maxMs << "," << stats.medianMs << "," << stats.p95Ms << "," << stats.p99Ms << ","
+            << stats.meanMs << "," << stats.stddevMs << "," << stats.ciHalfWidthMs << "," << (stats.converged ? 1 : 0) << std::endl;
+    }
+}
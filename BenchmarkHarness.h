@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Statistical timing of one benchmark configuration.
+//
+// RunBenchmark discards warmupRuns samples, then repeats until the 95% confidence interval of the mean
+// is within targetRelativeCi of the mean (at least minRuns, at most maxRuns samples). Samples whose
+// modified z-score 0.6745 * |x - median| / MAD exceeds outlierThreshold are left out of the mean,
+// standard deviation and confidence interval. Median and percentiles always use every sample, the
+// outliers are exactly what p99 is supposed to show.
+
+struct BenchmarkOptions
+{
+    uint32_t warmupRuns = 3;
+    uint32_t minRuns = 10;
+    uint32_t maxRuns = 200;
+    double targetRelativeCi = 0.02;     // CI half-width / mean
+    double outlierThreshold = 3.5;      // modified z-score, 0 disables rejection
+};
+
+struct BenchmarkStats
+{
+    size_t samples = 0;
+    size_t outliers = 0;
+    double minMs = 0.0;
+    double maxMs = 0.0;
+    double medianMs = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+    double meanMs = 0.0;                // without outliers
+    double stddevMs = 0.0;              // without outliers, sample standard deviation
+    double ciHalfWidthMs = 0.0;         // 95% confidence interval of meanMs
+    bool converged = false;             // ciHalfWidthMs reached the target before maxRuns
+};
+
+// Statistics of an arbitrary sample set, converged is left false
+BenchmarkStats ComputeBenchmarkStats(const std::vector<double>& samplesMs, double outlierThreshold);
+
+// Calls runOnce until the options are satisfied; runOnce returns the time of one run in milliseconds.
+// samplesMs receives the measured (non warmup) samples when given.
+BenchmarkStats RunBenchmark(const BenchmarkOptions& options, const std::function<double()>& runOnce, std::vector<double>* samplesMs = nullptr);
+
+// Deterministic fake timings for exercising the harness without a GPU: baseMs with relative gaussian
+// jitter, every run an outlier of outlierFactor * baseMs with probability outlierRate
+std::function<double()> MakeMockTimingSource(double baseMs, double jitter = 0.05, double outlierRate = 0.02, double outlierFactor = 2.5, uint64_t seed = 1);
+
+struct BenchmarkResult
+{
+    std::string backend;
+    std::string strategy;
+    std::string distribution;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint32_t threadGroupSize = 0;
+    uint32_t maxValue = 0;
+    bool hasAtomicStats = false;        // AtomicMax rows of backends that count their atomics
+    double deviceAtomics = 0.0;         // InterlockedMax operations per run, mean over every run
+    double atomicRetries = 0.0;         // failed compare-exchanges per run, mean over every run
+    BenchmarkStats stats;
+    std::vector<double> samplesMs;      // measured runs in order, what RegressionGate compares
+};
+
+// One line summary, the replacement for the per-run "GPU Time" lines
+void WriteBenchmarkSummary(std::ostream& out, const std::string& timeLabel, const BenchmarkStats& stats);
+
+// Every result as a JSON array of objects (with the raw samples) / as CSV with a header row (statistics only).
+// deviceAtomics and atomicRetries are only written for results with hasAtomicStats, the CSV leaves them empty.
+void WriteBenchmarkJson(std::ostream& out, const std::vector<BenchmarkResult>& results);
+void WriteBenchmarkCsv(std::ostream& out, const std::vector<BenchmarkResult>& results);
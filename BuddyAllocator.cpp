@@ -0,0 +1,229 @@
+#include "BuddyAllocator.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    bool IsPowerOfTwo(uint64_t value)
+    {
+        return value != 0 && (value & (value - 1)) == 0;
+    }
+
+    uint64_t NextPowerOfTwo(uint64_t value)
+    {
+        uint64_t power = 1;
+        while (power < value)
+        {
+            power <<= 1;
+        }
+        return power;
+    }
+}
+
+BuddyAllocator::BuddyAllocator(uint64_t capacity, uint64_t minBlockSize)
+    : m_capacity(capacity), m_minBlockSize(minBlockSize), m_maxOrder(0)
+{
+    if (!IsPowerOfTwo(capacity) || !IsPowerOfTwo(minBlockSize) || minBlockSize > capacity)
+    {
+        throw std::runtime_error("Buddy allocator sizes have to be powers of two with minBlockSize <= capacity");
+    }
+    while (GetBlockSize(m_maxOrder) < capacity)
+    {
+        ++m_maxOrder;
+    }
+    m_freeBlocks.resize(m_maxOrder + 1);
+    m_freeBlocks[m_maxOrder].insert(0);
+}
+
+uint64_t BuddyAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+    const uint64_t blockSize = std::max<uint64_t>(std::max(size, alignment), 1);
+    if (blockSize > m_capacity)
+    {
+        return InvalidAllocationOffset;
+    }
+    uint32_t order = 0;
+    while (GetBlockSize(order) < blockSize)
+    {
+        ++order;
+    }
+
+    // Smallest free block that fits, split down to the requested order. The lowest offset keeps
+    // allocations packed at the start so the top of the heap stays free for large requests.
+    uint32_t freeOrder = order;
+    while (freeOrder <= m_maxOrder && m_freeBlocks[freeOrder].empty())
+    {
+        ++freeOrder;
+    }
+    if (freeOrder > m_maxOrder)
+    {
+        return InvalidAllocationOffset;
+    }
+    const uint64_t offset = *m_freeBlocks[freeOrder].begin();
+    m_freeBlocks[freeOrder].erase(m_freeBlocks[freeOrder].begin());
+    while (freeOrder > order)
+    {
+        --freeOrder;
+        m_freeBlocks[freeOrder].insert(offset + GetBlockSize(freeOrder));
+    }
+
+    m_allocations[offset] = { order, size };
+    m_allocatedBytes += GetBlockSize(order);
+    m_requestedBytes += size;
+    return offset;
+}
+
+void BuddyAllocator::Free(uint64_t offset)
+{
+    auto it = m_allocations.find(offset);
+    if (it == m_allocations.end())
+    {
+        throw std::runtime_error("Freeing unknown heap offset " + std::to_string(offset));
+    }
+    uint32_t order = it->second.order;
+    m_allocatedBytes -= GetBlockSize(order);
+    m_requestedBytes -= it->second.requestedSize;
+    m_allocations.erase(it);
+
+    uint64_t block = offset;
+    while (order < m_maxOrder)
+    {
+        const uint64_t buddy = block ^ GetBlockSize(order);
+        auto buddyIt = m_freeBlocks[order].find(buddy);
+        if (buddyIt == m_freeBlocks[order].end())
+        {
+            break;
+        }
+        m_freeBlocks[order].erase(buddyIt);
+        block = std::min(block, buddy);
+        ++order;
+    }
+    m_freeBlocks[order].insert(block);
+}
+
+uint64_t BuddyAllocator::GetLargestFreeBlock() const
+{
+    for (uint32_t order = m_maxOrder + 1; order-- > 0;)
+    {
+        if (!m_freeBlocks[order].empty())
+        {
+            return GetBlockSize(order);
+        }
+    }
+    return 0;
+}
+
+HeapPool::HeapPool(uint64_t heapSize, uint64_t minBlockSize)
+    : m_heapSize(heapSize), m_minBlockSize(minBlockSize)
+{
+    if (!IsPowerOfTwo(heapSize) || !IsPowerOfTwo(minBlockSize) || minBlockSize > heapSize)
+    {
+        throw std::runtime_error("Heap pool sizes have to be powers of two with minBlockSize <= heapSize");
+    }
+}
+
+HeapAllocation HeapPool::Allocate(uint64_t size, uint64_t alignment, bool* newHeap)
+{
+    HeapAllocation allocation;
+    allocation.size = size;
+    if (newHeap != nullptr)
+    {
+        *newHeap = false;
+    }
+
+    for (size_t i = 0; i < m_heaps.size(); ++i)
+    {
+        allocation.offset = m_heaps[i]->Allocate(size, alignment);
+        if (allocation.IsValid())
+        {
+            allocation.heapIndex = static_cast<uint32_t>(i);
+            ++m_totalAllocations;
+            return allocation;
+        }
+    }
+
+    const uint64_t heapSize = std::max(m_heapSize, NextPowerOfTwo(std::max(size, alignment)));
+    m_heaps.push_back(std::make_unique<BuddyAllocator>(heapSize, m_minBlockSize));
+    allocation.heapIndex = static_cast<uint32_t>(m_heaps.size() - 1);
+    allocation.offset = m_heaps.back()->Allocate(size, alignment);
+    ++m_totalAllocations;
+    if (newHeap != nullptr)
+    {
+        *newHeap = true;
+    }
+    return allocation;
+}
+
+void HeapPool::Free(const HeapAllocation& allocation)
+{
+    if (!allocation.IsValid() || allocation.heapIndex >= m_heaps.size())
+    {
+        throw std::runtime_error("Freeing an allocation that is not from this heap pool");
+    }
+    m_heaps[allocation.heapIndex]->Free(allocation.offset);
+}
+
+void HeapPool::RemoveEmptyLastHeap()
+{
+    if (m_heaps.empty() || m_heaps.back()->GetAllocationCount() != 0)
+    {
+        throw std::runtime_error("The last heap of the pool is in use");
+    }
+    m_heaps.pop_back();
+}
+
+HeapPoolStats HeapPool::GetStats() const
+{
+    HeapPoolStats stats;
+    stats.heapCount = m_heaps.size();
+    stats.totalAllocations = m_totalAllocations;
+    for (const auto& heap : m_heaps)
+    {
+        stats.heapBytes += heap->GetCapacity();
+        stats.allocatedBytes += heap->GetAllocatedBytes();
+        stats.requestedBytes += heap->GetRequestedBytes();
+        stats.allocationCount += heap->GetAllocationCount();
+        stats.largestFreeBlock = std::max(stats.largestFreeBlock, heap->GetLargestFreeBlock());
+    }
+    return stats;
+}
+
+void WriteHeapPoolReport(std::ostream& out, uint32_t operations, uint64_t seed)
+{
+    // 64x64 to 4096x4096 R8 input textures, with the placement alignment D3D12 gives each of them
+    const uint64_t SmallAlignment = 4096;
+    const uint64_t DefaultAlignment = 65536;
+    std::mt19937_64 random(seed);
+    std::uniform_int_distribution<uint32_t> sides(64, 4096);
+
+    HeapPool pool(64ull << 20, SmallAlignment);
+    std::vector<HeapAllocation> live;
+    const size_t liveLimit = 64;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+        if (live.size() >= liveLimit || (!live.empty() && random() % 2 == 0))
+        {
+            const size_t index = static_cast<size_t>(random() % live.size());
+            pool.Free(live[index]);
+            live[index] = live.back();
+            live.pop_back();
+            continue;
+        }
+        const uint64_t width = sides(random);
+        const uint64_t size = width * sides(random);
+        const uint64_t alignment = size <= DefaultAlignment ? SmallAlignment : DefaultAlignment;
+        live.push_back(pool.Allocate(size, alignment));
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const HeapPoolStats stats = pool.GetStats();
+    out << "Heap pool, 64 MB buddy heaps, " << operations << " operations, seed " << seed << std::endl;
+    out << "  " << operations / std::max(seconds, 1e-9) / 1e6 << " M ops/s, " << stats.heapCount << " heaps (" << (stats.heapBytes >> 20) << " MB), "
+        << stats.allocationCount << " live allocations, " << (stats.requestedBytes >> 10) << " KB requested in " << (stats.allocatedBytes >> 10) << " KB of blocks" << std::endl;
+    out << "  internal fragmentation " << stats.GetInternalFragmentation() << ", external fragmentation " << stats.GetExternalFragmentation()
+        << ", largest free block " << (stats.largestFreeBlock >> 10) << " KB" << std::endl;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+// GPU heap sub-allocation, independent of D3D12: offsets and sizes only, PlacedResourceAllocator.h
+// places resources at them.
+
+const uint64_t InvalidAllocationOffset = ~0ull;
+
+// Binary buddy allocator over [0, capacity). Blocks are powers of two between minBlockSize and
+// capacity and start at a multiple of their size, so any alignment up to the block size holds
+// without padding (64 KB default placement, 4 KB small resources with a 4 KB minimum block).
+class BuddyAllocator
+{
+public:
+    // capacity and minBlockSize are powers of two, minBlockSize <= capacity
+    BuddyAllocator(uint64_t capacity, uint64_t minBlockSize);
+
+    // Offset of a block of at least max(size, alignment) bytes, InvalidAllocationOffset when none is free
+    uint64_t Allocate(uint64_t size, uint64_t alignment = 0);
+    // offset of an earlier Allocate, merges the block with its free buddies
+    void Free(uint64_t offset);
+
+    uint64_t GetCapacity() const { return m_capacity; }
+    uint64_t GetMinBlockSize() const { return m_minBlockSize; }
+    uint64_t GetAllocatedBytes() const { return m_allocatedBytes; }     // whole blocks
+    uint64_t GetRequestedBytes() const { return m_requestedBytes; }     // what the callers asked for
+    uint64_t GetLargestFreeBlock() const;
+    size_t GetAllocationCount() const { return m_allocations.size(); }
+
+private:
+    struct Allocation
+    {
+        uint32_t order;
+        uint64_t requestedSize;
+    };
+
+    uint64_t GetBlockSize(uint32_t order) const { return m_minBlockSize << order; }
+
+    uint64_t m_capacity;
+    uint64_t m_minBlockSize;
+    uint32_t m_maxOrder;
+    std::vector<std::set<uint64_t>> m_freeBlocks;       // per order, block offsets
+    std::unordered_map<uint64_t, Allocation> m_allocations;
+    uint64_t m_allocatedBytes = 0;
+    uint64_t m_requestedBytes = 0;
+};
+
+struct HeapAllocation
+{
+    uint32_t heapIndex = 0;
+    uint64_t offset = InvalidAllocationOffset;
+    uint64_t size = 0;
+
+    bool IsValid() const { return offset != InvalidAllocationOffset; }
+};
+
+struct HeapPoolStats
+{
+    uint64_t heapCount = 0;
+    uint64_t heapBytes = 0;
+    uint64_t allocatedBytes = 0;        // whole buddy blocks
+    uint64_t requestedBytes = 0;
+    uint64_t allocationCount = 0;
+    uint64_t largestFreeBlock = 0;
+    uint64_t totalAllocations = 0;      // since creation
+
+    // Share of the allocated block bytes nobody asked for (buddy rounding)
+    double GetInternalFragmentation() const { return allocatedBytes ? 1.0 - static_cast<double>(requestedBytes) / allocatedBytes : 0.0; }
+    // Share of the free bytes outside the largest free block, 0 when all free memory is contiguous
+    double GetExternalFragmentation() const
+    {
+        const uint64_t freeBytes = heapBytes - allocatedBytes;
+        return freeBytes ? 1.0 - static_cast<double>(largestFreeBlock) / freeBytes : 0.0;
+    }
+};
+
+// Growing set of heaps, each managed by a BuddyAllocator. A request that fits no existing heap adds
+// one of heapSize, or of the next power of two above the request when that is larger, so heaps can
+// differ in size (GetHeapSize).
+// Heaps are kept when they become empty, the owner of the memory decides when to drop the pool.
+class HeapPool
+{
+public:
+    HeapPool(uint64_t heapSize, uint64_t minBlockSize);
+
+    // newHeap reports whether the allocation added heap GetHeapCount() - 1, the caller creates its memory
+    HeapAllocation Allocate(uint64_t size, uint64_t alignment, bool* newHeap = nullptr);
+    void Free(const HeapAllocation& allocation);
+    // Undoes the heap a failed Allocate added when the caller could not create its memory
+    void RemoveEmptyLastHeap();
+
+    size_t GetHeapCount() const { return m_heaps.size(); }
+    uint64_t GetHeapSize(size_t heapIndex) const { return m_heaps[heapIndex]->GetCapacity(); }
+    HeapPoolStats GetStats() const;
+
+private:
+    uint64_t m_heapSize;
+    uint64_t m_minBlockSize;
+    std::vector<std::unique_ptr<BuddyAllocator>> m_heaps;
+    uint64_t m_totalAllocations = 0;
+};
+
+// Synthetic workload, no device needed: seeded random R8 texture sizes between 64x64 and 4096x4096
+// allocated and freed in a pool, written as allocation rate and fragmentation.
+void WriteHeapPoolReport(std::ostream& out, uint32_t operations, uint64_t seed);
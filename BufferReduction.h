@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// Layout of the BufferReduction.hlsl passes, shared by ReductionContext and the emulator port
+
+// [numthreads] of BufferReduction.hlsl, every thread loads two elements
+const uint32_t BufferReductionGroupSize = 256;
+const uint32_t BufferReductionElementsPerGroup = 2 * BufferReductionGroupSize;
+
+// Output element count of every pass needed to reduce count elements to one.
+// Empty when count is 0 or 1, the dispatch of a pass has one group per output element.
+inline std::vector<uint32_t> GetBufferReductionPassSizes(uint32_t count)
+{
+    std::vector<uint32_t> passSizes;
+    while (count > 1)
+    {
+        count = (count + BufferReductionElementsPerGroup - 1) / BufferReductionElementsPerGroup;
+        passSizes.push_back(count);
+    }
+    return passSizes;
+}
@@ -0,0 +1,61 @@
+// Second pass of the max reduction - reduces the per-group partials written by CompuetShader.hlsl
+// Each group reduces 2 * REDUCTION_GROUP_SIZE consecutive elements to one, the pass is repeated
+// on its own output until a single value is left, so only 4 bytes have to be read back.
+//
+// Input - uint partial max values (intermediate buffer or the previous pass output)
+// Output - uint - Max value of each 2 * REDUCTION_GROUP_SIZE elements
+//
+// API - DX12 12_0
+// Shader Model - cs_5_1
+// Root signature - same as CompuetShader.hlsl, SRV table (t0), UAV table (u0), the root constants are unused
+//
+// built at compile time into ShaderPermutations.cpp, see the ShaderPermutation items in test1.vcxproj
+// equivalent cmdline - fxc /T cs_5_1 /Vn g_BufferReduction256x1x1 /Fh BufferReduction256x1x1.h /E CSMain BufferReduction.hlsl
+
+// must match BufferReductionGroupSize in BufferReduction.h
+#define REDUCTION_GROUP_SIZE 256
+
+// input partials, the element count comes from the view
+StructuredBuffer<uint> inputBuffer : register(t0);
+
+// output buffer
+RWStructuredBuffer<uint> outputBuffer : register(u0);
+
+groupshared uint sharedData[REDUCTION_GROUP_SIZE];
+
+[numthreads(REDUCTION_GROUP_SIZE, 1, 1)]
+void CSMain(uint3 GTid : SV_GroupThreadID, uint3 GID : SV_GroupID)
+{
+    uint count;
+    uint stride;
+    inputBuffer.GetDimensions(count, stride);
+
+    // two loads per thread so no thread idles in the first reduction step, 0 is the identity for max
+    uint first = GID.x * REDUCTION_GROUP_SIZE * 2 + GTid.x;
+    uint value = 0;
+    if (first < count)
+    {
+        value = inputBuffer[first];
+    }
+    if (first + REDUCTION_GROUP_SIZE < count)
+    {
+        value = max(value, inputBuffer[first + REDUCTION_GROUP_SIZE]);
+    }
+    sharedData[GTid.x] = value;
+
+    GroupMemoryBarrierWithGroupSync();
+
+    for (uint s = REDUCTION_GROUP_SIZE / 2; s > 0; s >>= 1)
+    {
+        if (GTid.x < s)
+        {
+            sharedData[GTid.x] = max(sharedData[GTid.x], sharedData[GTid.x + s]);
+        }
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    if (GTid.x == 0)
+    {
+        outputBuffer[GID.x] = sharedData[0];
+    }
+}
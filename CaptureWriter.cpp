@@ -0,0 +1,177 @@
+#include "CaptureWriter.h"
+#include <stdexcept>
+#include <utility>
+
+AsyncCaptureWriter::AsyncCaptureWriter(const std::string& filename, size_t maxQueuedBytes, CaptureOverflow overflow)
+    : m_file(filename, std::ios::binary | std::ios::trunc), m_maxQueuedBytes(maxQueuedBytes), m_overflow(overflow)
+{
+    if (!m_file.is_open())
+    {
+        throw std::runtime_error("Failed to open " + filename + " for writing");
+    }
+    m_thread = std::thread(&AsyncCaptureWriter::WriterLoop, this);
+}
+
+AsyncCaptureWriter::~AsyncCaptureWriter()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_queueChanged.notify_all();
+    m_thread.join();
+}
+
+bool AsyncCaptureWriter::Submit(uint32_t width, uint32_t height, TexelFormat format, uint64_t seed, std::vector<uint8_t> texels)
+{
+    const size_t size = texels.size();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    ThrowPendingError();
+    ++m_stats.submitted;
+
+    // A record larger than the whole budget is still accepted once the queue is empty
+    auto hasSpace = [&]() { return m_queue.empty() || m_queuedBytes + size <= m_maxQueuedBytes || m_error; };
+    if (!hasSpace())
+    {
+        if (m_overflow == CaptureOverflow::Drop)
+        {
+            ++m_stats.dropped;
+            return false;
+        }
+        ++m_stats.blockedSubmits;
+        m_queueChanged.wait(lock, hasSpace);
+        ThrowPendingError();
+    }
+
+    CaptureRecord record;
+    record.width = width;
+    record.height = height;
+    record.format = format;
+    record.seed = seed;
+    record.sequence = m_nextSequence++;
+    record.texels = std::move(texels);
+    m_queue.push_back(std::move(record));
+    m_queuedBytes += size;
+
+    lock.unlock();
+    m_queueChanged.notify_all();
+    return true;
+}
+
+void AsyncCaptureWriter::Flush()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_queueChanged.wait(lock, [&]() { return (m_queue.empty() && !m_writing) || m_error; });
+    ThrowPendingError();
+}
+
+CaptureWriterStats AsyncCaptureWriter::GetStats() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+}
+
+void AsyncCaptureWriter::ThrowPendingError()
+{
+    if (m_error)
+    {
+        std::exception_ptr error = m_error;
+        m_error = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+void AsyncCaptureWriter::WriterLoop()
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;)
+    {
+        m_queueChanged.wait(lock, [&]() { return !m_queue.empty() || m_stop; });
+        if (m_queue.empty())
+        {
+            // Only stop once everything submitted before the destructor is written
+            break;
+        }
+
+        CaptureRecord record = std::move(m_queue.front());
+        m_queue.pop_front();
+        m_writing = true;
+        lock.unlock();
+
+        CaptureRecordHeader header = {};
+        header.magic = CaptureMagic;
+        header.version = CaptureVersion;
+        header.width = record.width;
+        header.height = record.height;
+        header.format = static_cast<uint32_t>(record.format);
+        header.seed = record.seed;
+        header.sequence = record.sequence;
+        header.dataSize = record.texels.size();
+        m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        m_file.write(reinterpret_cast<const char*>(record.texels.data()), record.texels.size());
+        m_file.flush();
+        const bool failed = !m_file;
+
+        lock.lock();
+        m_writing = false;
+        m_queuedBytes -= record.texels.size();
+        if (failed)
+        {
+            if (!m_error)
+            {
+                m_error = std::make_exception_ptr(std::runtime_error("Failed to write capture record"));
+            }
+            m_file.clear();
+        }
+        else
+        {
+            ++m_stats.written;
+            m_stats.bytesWritten += sizeof(header) + record.texels.size();
+        }
+        m_queueChanged.notify_all();
+    }
+}
+
+std::vector<CaptureRecord> ReadCaptureFile(const std::string& filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open " + filename);
+    }
+
+    std::vector<CaptureRecord> records;
+    CaptureRecordHeader header;
+    while (file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+    {
+        if (header.magic != CaptureMagic || header.version != CaptureVersion || header.format > static_cast<uint32_t>(TexelFormat::R32))
+        {
+            throw std::runtime_error("Invalid capture record header in " + filename);
+        }
+        const uint64_t expectedSize = static_cast<uint64_t>(header.width) * header.height * GetTexelSize(static_cast<TexelFormat>(header.format));
+        if (header.dataSize != expectedSize)
+        {
+            throw std::runtime_error("Capture record size does not match its dimensions in " + filename);
+        }
+
+        CaptureRecord record;
+        record.width = header.width;
+        record.height = header.height;
+        record.format = static_cast<TexelFormat>(header.format);
+        record.seed = header.seed;
+        record.sequence = header.sequence;
+        record.texels.resize(static_cast<size_t>(header.dataSize));
+        if (!file.read(reinterpret_cast<char*>(record.texels.data()), record.texels.size()))
+        {
+            throw std::runtime_error("Truncated capture record in " + filename);
+        }
+        records.push_back(std::move(record));
+    }
+    if (file.gcount() != 0)
+    {
+        throw std::runtime_error("Truncated capture record header in " + filename);
+    }
+
+    return records;
+}
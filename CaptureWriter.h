@@ -0,0 +1,105 @@
+#pragma once
+
+#include "SimdReduction.h"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Binary capture of reduction inputs.
+// A capture file is a sequence of records, each a CaptureRecordHeader followed by dataSize bytes of
+// tightly packed texels (width * GetTexelSize(format) bytes per row), little endian. Every submitted
+// run becomes its own record so nothing is overwritten.
+
+const uint32_t CaptureMagic = 0x50414352;      // "RCAP"
+const uint32_t CaptureVersion = 1;
+
+struct CaptureRecordHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;        // TexelFormat
+    uint32_t reserved;
+    uint64_t seed;          // GeneratePhiloxTextureData seed that reproduces the texels, 0 when unknown
+    uint64_t sequence;      // submission order within the file
+    uint64_t dataSize;
+};
+static_assert(sizeof(CaptureRecordHeader) == 48, "CaptureRecordHeader is a file format");
+
+struct CaptureRecord
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    TexelFormat format = TexelFormat::R8;
+    uint64_t seed = 0;
+    uint64_t sequence = 0;
+    std::vector<uint8_t> texels;
+};
+
+struct CaptureWriterStats
+{
+    uint64_t submitted = 0;
+    uint64_t written = 0;
+    uint64_t dropped = 0;           // only with CaptureOverflow::Drop
+    uint64_t blockedSubmits = 0;    // Submit calls that waited for queue space
+    uint64_t bytesWritten = 0;
+};
+
+// What Submit does when the queue is full
+enum class CaptureOverflow
+{
+    Block,      // wait for the writer, no capture is lost
+    Drop        // discard the record, the submitting thread never waits
+};
+
+// Writes capture records on a background thread. Submit only moves the texels into a queue bounded
+// by maxQueuedBytes, the file I/O happens on the writer thread.
+// Write errors are rethrown by the next Submit or Flush.
+class AsyncCaptureWriter
+{
+public:
+    explicit AsyncCaptureWriter(const std::string& filename, size_t maxQueuedBytes = 64 * 1024 * 1024, CaptureOverflow overflow = CaptureOverflow::Block);
+    ~AsyncCaptureWriter();
+
+    AsyncCaptureWriter(const AsyncCaptureWriter&) = delete;
+    AsyncCaptureWriter& operator=(const AsyncCaptureWriter&) = delete;
+
+    // Returns false if the record was dropped
+    bool Submit(uint32_t width, uint32_t height, TexelFormat format, uint64_t seed, std::vector<uint8_t> texels);
+
+    // Waits until every queued record is in the file
+    void Flush();
+
+    CaptureWriterStats GetStats() const;
+
+private:
+    void WriterLoop();
+    void ThrowPendingError();
+
+    std::ofstream m_file;
+    size_t m_maxQueuedBytes;
+    CaptureOverflow m_overflow;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_queueChanged;
+    std::deque<CaptureRecord> m_queue;
+    size_t m_queuedBytes = 0;
+    bool m_writing = false;         // the writer holds a record outside the queue
+    bool m_stop = false;
+    uint64_t m_nextSequence = 0;
+    std::exception_ptr m_error;
+    CaptureWriterStats m_stats;
+
+    std::thread m_thread;
+};
+
+// Reads every record of a capture file, throws on a bad header or a truncated record
+std::vector<CaptureRecord> ReadCaptureFile(const std::string& filename);
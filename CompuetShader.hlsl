@@ -4,18 +4,30 @@
 // thread group size until reach to single max
 // 
 // Input - R8_UNORM/uint inputTexture
-// Output - uint - Max values found by each thread 
+// Output - uint - Max value of every tile, the true max of the whole tile like the CPU backend and
+//          AtomicMaxReduction.hlsl, reduced to the texture max by BufferReduction.hlsl or the CPU
 // 
 // API - DX12 12_0
 // Shader Model - cs_5_1
 // 
-// cmdline to generate .cso - fxc /T cs_5_1 /Fo ComputeShader16x16x1.cso /E CSMain CompuetShader.hlsl
-// 
-// TODO : Is it safe to use global shared data? Any alternative
-// TODO : Instead of THREAD_GROUP_SIZE defined can we use 3 differnt entry point to avoid cso generation and usage error issues
+// built at compile time into ShaderPermutations.cpp, one permutation per ShaderPermutation item in test1.vcxproj
+// equivalent cmdline - fxc /T cs_5_1 /D THREAD_GROUP_SIZE=16 /Vn g_ComputeShader16x16x1 /Fh ComputeShader16x16x1.h /E CSMain CompuetShader.hlsl
 
-// thread group size - change 8/16/32 before generating .cso 
+// thread group size - 8/16/32, passed with /D for each permutation
+#ifndef THREAD_GROUP_SIZE
 #define THREAD_GROUP_SIZE 32
+#endif
+#define THREAD_COUNT (THREAD_GROUP_SIZE * THREAD_GROUP_SIZE)
+
+// texture dimensions and group counts as root constants (ReductionConstants in ReductionLayout.h),
+// one permutation per group size works for every texture size
+cbuffer ReductionConstants : register(b0)
+{
+    uint textureWidth;
+    uint textureHeight;
+    uint groupsX;
+    uint groupsY;
+};
 
 // input texture
 Texture2D<uint> inputTexture : register(t0);
@@ -23,39 +35,33 @@ Texture2D<uint> inputTexture : register(t0);
 // output buffer
 RWStructuredBuffer<uint> outputBuffer : register(u0);
 
-// shared global - warnings generated as we writing to global storage - not recommend for shaders
-// ToDo - check for alternative solution
-groupshared float sharedData[THREAD_GROUP_SIZE * THREAD_GROUP_SIZE];
+// one texel per thread of the group, uint like the R8_UINT view so no float round trip changes a value
+groupshared uint sharedData[THREAD_COUNT];
 
 // thread group size x, y, z=1
 [numthreads(THREAD_GROUP_SIZE, THREAD_GROUP_SIZE, 1)]
-void CSMain(uint3 DTid : SV_DispatchThreadID, uint3 GTid : SV_GroupThreadID, uint3 GID : SV_GroupID)
+void CSMain(uint3 DTid : SV_DispatchThreadID, uint3 GID : SV_GroupID, uint GI : SV_GroupIndex)
 {
-    // get the index
-    uint index = GTid.y * THREAD_GROUP_SIZE + GTid.x;
-
-    //input texture format R8_UNORM so just red channel to be considered.
-    float value = inputTexture.Load(int3(DTid.xy, 0)).r / 255.0f;
-
-    //write to global storage
-    sharedData[index] = value;
+    // out of bounds loads return 0, the identity for max
+    sharedData[GI] = inputTexture.Load(int3(DTid.xy, 0)).r;
 
     //sync before getting into the max value search, to ensure thread writes to shared mem
     GroupMemoryBarrierWithGroupSync();
 
-    // reduction method used to share work load between threads
-    for (uint stride = THREAD_GROUP_SIZE / 2; stride > 0; stride >>= 1)
+    // tree reduction over the whole tile: GI = GTid.y * THREAD_GROUP_SIZE + GTid.x, so halving the
+    // flattened index folds every row in. Halving over GTid.x alone only reduced the tile's first row.
+    for (uint stride = THREAD_COUNT / 2; stride > 0; stride >>= 1)
     {
-        if (GTid.x < stride)
+        if (GI < stride)
         {
-            sharedData[index] = max(sharedData[index], sharedData[index + stride]);
+            sharedData[GI] = max(sharedData[GI], sharedData[GI + stride]);
         }
         GroupMemoryBarrierWithGroupSync(); // ensure sync
     }
 
-    // write max to output once reduction complete
-    if (GTid.x == 0 && GTid.y == 0)
+    // write the tile max to output once reduction complete
+    if (GI == 0)
     {
-        outputBuffer[GID.y * (THREAD_GROUP_SIZE) + GID.x] = (uint) (sharedData[0] * 255.0f);
+        outputBuffer[GID.y * groupsX + GID.x] = sharedData[0];
     }
 }
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "ComputeEmulator.h"
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <thread>
+
+ComputeGroup::ComputeGroup(EmuUint3 numThreads)
+    : m_numThreads(numThreads), m_sharedMemory(MaxSharedBytes / sizeof(std::max_align_t))
+{
+}
+
+void ComputeGroup::BeginGroup(EmuUint3 groupId)
+{
+    m_groupId = groupId;
+    m_currentThread = 0;
+    m_sharedUsed = 0;
+    if (m_profiler)
+    {
+        m_profiler->BeginGroup();
+    }
+}
+
+void ComputeGroup::EndGroup()
+{
+    m_stats.sharedBytes = std::max<uint64_t>(m_stats.sharedBytes, m_sharedUsed);
+    ++m_stats.groupCount;
+    if (m_profiler)
+    {
+        m_profiler->EndGroup();
+    }
+}
+
+ComputeEmulator::ComputeEmulator(unsigned int workerCount)
+    : m_workerCount(workerCount != 0 ? workerCount : std::max(1u, std::thread::hardware_concurrency()))
+{
+}
+
+EmulatorDispatchStats ComputeEmulator::Dispatch(const ComputeKernel& kernel, EmuUint3 numThreads, uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ, SharedMemoryProfile* profile) const
+{
+    if (numThreads.x == 0 || numThreads.y == 0 || numThreads.z == 0)
+    {
+        throw std::runtime_error("numthreads must be non-zero");
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    const uint64_t groupCount = static_cast<uint64_t>(groupsX) * groupsY * groupsZ;
+    const unsigned int workerCount = static_cast<unsigned int>(std::min<uint64_t>(m_workerCount, groupCount));
+
+    // Groups are handed out one at a time so uneven groups still balance
+    std::atomic<uint64_t> nextGroup(0);
+    std::vector<ComputeGroup> groups(std::max(1u, workerCount), ComputeGroup(numThreads));
+
+    // One profiler per worker, merged once all groups are done
+    std::vector<SharedMemoryProfiler> profilers;
+    if (profile)
+    {
+        profilers.assign(groups.size(), SharedMemoryProfiler(profile->config));
+        for (size_t i = 0; i < groups.size(); ++i)
+        {
+            groups[i].SetProfiler(&profilers[i]);
+        }
+    }
+
+    auto worker = [&](ComputeGroup& group)
+    {
+        for (uint64_t linear = nextGroup.fetch_add(1); linear < groupCount; linear = nextGroup.fetch_add(1))
+        {
+            EmuUint3 groupId;
+            groupId.x = static_cast<uint32_t>(linear % groupsX);
+            groupId.y = static_cast<uint32_t>((linear / groupsX) % groupsY);
+            groupId.z = static_cast<uint32_t>(linear / (static_cast<uint64_t>(groupsX) * groupsY));
+            group.BeginGroup(groupId);
+            kernel(group);
+            group.EndGroup();
+        }
+    };
+
+    if (workerCount <= 1)
+    {
+        worker(groups[0]);
+    }
+    else
+    {
+        std::vector<std::thread> threads;
+        threads.reserve(workerCount);
+        for (unsigned int i = 0; i < workerCount; ++i)
+        {
+            threads.emplace_back(worker, std::ref(groups[i]));
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+    }
+
+    EmulatorDispatchStats total;
+    for (const ComputeGroup& group : groups)
+    {
+        const EmulatorDispatchStats& stats = group.GetStats();
+        total.threadInvocations += stats.threadInvocations;
+        total.barriers += stats.barriers;
+        total.sharedLoads += stats.sharedLoads;
+        total.sharedStores += stats.sharedStores;
+        total.sharedBytes = std::max(total.sharedBytes, stats.sharedBytes);
+        total.deviceAtomics += stats.deviceAtomics;
+        total.atomicRetries += stats.atomicRetries;
+        total.groupCount += stats.groupCount;
+    }
+
+    for (const SharedMemoryProfiler& profiler : profilers)
+    {
+        profile->Merge(profiler.GetProfile());
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    total.elapsedMs = std::chrono::duration<double, std::milli>(end - start).count();
+    return total;
+}
@@ -0,0 +1,310 @@
+#pragma once
+
+#include "AtomicUtils.h"
+#include "SharedMemoryProfiler.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+// CPU emulation of the HLSL compute model used by CompuetShader.hlsl and ComputeShader_groupshared_mem.hlsl.
+//
+// A kernel is a C++ functor that runs once per thread group. Code between two
+// GroupMemoryBarrierWithGroupSync() calls is written as a ForEachThread() phase which is executed
+// for every thread of the group before the next phase starts (phase-split execution), so a
+// barrier inside a loop works the same way as in the shader:
+//
+//   GroupSharedArray<float> sharedData = group.AllocateShared<float>(N * N);
+//   group.ForEachThread([&](const ComputeThreadIds& ids) { sharedData.Store(ids.groupIndex, ...); });
+//   group.GroupMemoryBarrierWithGroupSync();
+//
+// Thread groups are scheduled over all cores, threads inside a group run in SV_GroupIndex order.
+// Passing a SharedMemoryProfile to Dispatch additionally records groupshared addresses per phase.
+
+struct EmuUint3
+{
+    uint32_t x;
+    uint32_t y;
+    uint32_t z;
+};
+
+struct ComputeThreadIds
+{
+    EmuUint3 dispatchThreadId;  // SV_DispatchThreadID
+    EmuUint3 groupThreadId;     // SV_GroupThreadID
+    EmuUint3 groupId;           // SV_GroupID
+    uint32_t groupIndex;        // SV_GroupIndex
+};
+
+// Algorithmic cost of a dispatch, summed over all thread groups
+struct EmulatorDispatchStats
+{
+    uint64_t groupCount = 0;
+    uint64_t threadInvocations = 0;     // thread executions summed over all phases
+    uint64_t barriers = 0;              // GroupMemoryBarrierWithGroupSync calls
+    uint64_t sharedLoads = 0;
+    uint64_t sharedStores = 0;
+    uint64_t sharedBytes = 0;           // groupshared allocation of one group
+    uint64_t deviceAtomics = 0;         // Interlocked* operations on buffers
+    uint64_t atomicRetries = 0;         // failed compare-exchanges of those, i.e. contention between groups
+    double elapsedMs = 0.0;
+};
+
+class ComputeGroup;
+
+// groupshared T name[count] - every access is counted so variants can be compared
+template <typename T>
+class GroupSharedArray
+{
+public:
+    GroupSharedArray(ComputeGroup* group, T* data, uint32_t count, uint32_t byteOffset)
+        : m_group(group), m_data(data), m_count(count), m_byteOffset(byteOffset)
+    {
+    }
+
+    inline T Load(uint32_t index) const;
+    inline void Store(uint32_t index, T value);
+    uint32_t Size() const { return m_count; }
+
+private:
+    ComputeGroup* m_group;
+    T* m_data;
+    uint32_t m_count;
+    uint32_t m_byteOffset;
+};
+
+class ComputeGroup
+{
+public:
+    // D3D12 limit for groupshared memory per thread group
+    static const size_t MaxSharedBytes = 32768;
+
+    explicit ComputeGroup(EmuUint3 numThreads);
+
+    const EmuUint3& GetNumThreads() const { return m_numThreads; }
+    const EmuUint3& GetGroupId() const { return m_groupId; }
+
+    // groupshared declaration, memory is zeroed at the start of every group
+    template <typename T>
+    GroupSharedArray<T> AllocateShared(uint32_t count)
+    {
+        size_t offset = (m_sharedUsed + alignof(T) - 1) & ~(alignof(T) - 1);
+        size_t end = offset + sizeof(T) * count;
+        if (end > MaxSharedBytes)
+        {
+            throw std::runtime_error("groupshared allocation exceeds 32 KB");
+        }
+        m_sharedUsed = end;
+        T* data = reinterpret_cast<T*>(reinterpret_cast<uint8_t*>(m_sharedMemory.data()) + offset);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            data[i] = T();
+        }
+        return GroupSharedArray<T>(this, data, count, static_cast<uint32_t>(offset));
+    }
+
+    // Runs one barrier-free section of the kernel for every thread of the group
+    template <typename F>
+    void ForEachThread(F&& body)
+    {
+        const uint32_t threadCount = m_numThreads.x * m_numThreads.y * m_numThreads.z;
+        if (m_profiler)
+        {
+            m_profiler->BeginPhase(threadCount);
+        }
+
+        ComputeThreadIds ids = {};
+        ids.groupId = m_groupId;
+        for (uint32_t z = 0; z < m_numThreads.z; ++z)
+        {
+            for (uint32_t y = 0; y < m_numThreads.y; ++y)
+            {
+                for (uint32_t x = 0; x < m_numThreads.x; ++x)
+                {
+                    ids.groupThreadId = { x, y, z };
+                    ids.dispatchThreadId = { m_groupId.x * m_numThreads.x + x, m_groupId.y * m_numThreads.y + y, m_groupId.z * m_numThreads.z + z };
+                    ids.groupIndex = (z * m_numThreads.y + y) * m_numThreads.x + x;
+                    m_currentThread = ids.groupIndex;
+                    body(static_cast<const ComputeThreadIds&>(ids));
+                }
+            }
+        }
+        m_stats.threadInvocations += threadCount;
+
+        if (m_profiler)
+        {
+            m_profiler->EndPhase();
+        }
+    }
+
+    void GroupMemoryBarrierWithGroupSync()
+    {
+        ++m_stats.barriers;
+        if (m_profiler)
+        {
+            m_profiler->OnBarrier();
+        }
+    }
+
+    uint32_t GetCurrentThread() const { return m_currentThread; }
+
+    void RecordSharedLoad(uint32_t byteAddress)
+    {
+        ++m_stats.sharedLoads;
+        if (m_profiler)
+        {
+            m_profiler->RecordAccess(m_currentThread, byteAddress);
+        }
+    }
+
+    void RecordSharedStore(uint32_t byteAddress)
+    {
+        ++m_stats.sharedStores;
+        if (m_profiler)
+        {
+            m_profiler->RecordAccess(m_currentThread, byteAddress);
+        }
+    }
+
+    void RecordDeviceAtomic(uint64_t retries)
+    {
+        ++m_stats.deviceAtomics;
+        m_stats.atomicRetries += retries;
+    }
+
+    // Used by the emulator between groups
+    void BeginGroup(EmuUint3 groupId);
+    void EndGroup();
+    void SetProfiler(SharedMemoryProfiler* profiler) { m_profiler = profiler; }
+    const EmulatorDispatchStats& GetStats() const { return m_stats; }
+
+private:
+    EmuUint3 m_numThreads;
+    EmuUint3 m_groupId = {};
+    uint32_t m_currentThread = 0;
+    std::vector<std::max_align_t> m_sharedMemory;
+    size_t m_sharedUsed = 0;
+    EmulatorDispatchStats m_stats;
+    SharedMemoryProfiler* m_profiler = nullptr;
+};
+
+template <typename T>
+inline T GroupSharedArray<T>::Load(uint32_t index) const
+{
+    m_group->RecordSharedLoad(m_byteOffset + index * static_cast<uint32_t>(sizeof(T)));
+    return index < m_count ? m_data[index] : T();
+}
+
+template <typename T>
+inline void GroupSharedArray<T>::Store(uint32_t index, T value)
+{
+    m_group->RecordSharedStore(m_byteOffset + index * static_cast<uint32_t>(sizeof(T)));
+    if (index < m_count)
+    {
+        m_data[index] = value;
+    }
+}
+
+// Texture2D<T>::Load - out of bounds reads return 0 as on D3D12
+template <typename T>
+class EmuTexture2D
+{
+public:
+    EmuTexture2D(const T* texels, uint32_t width, uint32_t height, uint32_t rowPitchInElements)
+        : m_texels(texels), m_width(width), m_height(height), m_rowPitch(rowPitchInElements)
+    {
+    }
+
+    T Load(uint32_t x, uint32_t y) const
+    {
+        return (x < m_width && y < m_height) ? m_texels[static_cast<size_t>(y) * m_rowPitch + x] : T();
+    }
+
+    uint32_t GetWidth() const { return m_width; }
+    uint32_t GetHeight() const { return m_height; }
+
+private:
+    const T* m_texels;
+    uint32_t m_width;
+    uint32_t m_height;
+    uint32_t m_rowPitch;
+};
+
+// RWStructuredBuffer<T> - out of bounds writes are discarded and reads return 0 as on D3D12.
+// Elements are atomics so that groups writing the same element race like on the GPU without C++ undefined behavior.
+template <typename T>
+class EmuRWStructuredBuffer
+{
+public:
+    explicit EmuRWStructuredBuffer(uint32_t count)
+        : m_elements(new std::atomic<T>[count]), m_count(count)
+    {
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            m_elements[i].store(T(), std::memory_order_relaxed);
+        }
+    }
+
+    T Load(uint32_t index) const
+    {
+        return index < m_count ? m_elements[index].load(std::memory_order_relaxed) : T();
+    }
+
+    void Store(uint32_t index, T value)
+    {
+        if (index < m_count)
+        {
+            m_elements[index].store(value, std::memory_order_relaxed);
+        }
+    }
+
+    std::atomic<T>* GetElement(uint32_t index) { return index < m_count ? &m_elements[index] : nullptr; }
+
+    uint32_t Size() const { return m_count; }
+
+    std::vector<T> ToVector() const
+    {
+        std::vector<T> values(m_count);
+        for (uint32_t i = 0; i < m_count; ++i)
+        {
+            values[i] = m_elements[i].load(std::memory_order_relaxed);
+        }
+        return values;
+    }
+
+private:
+    std::unique_ptr<std::atomic<T>[]> m_elements;
+    uint32_t m_count;
+};
+
+// InterlockedMax(buffer[index], value, original) - out of bounds updates are discarded and return 0
+template <typename T>
+T InterlockedMax(ComputeGroup& group, EmuRWStructuredBuffer<T>& buffer, uint32_t index, T value)
+{
+    std::atomic<T>* element = buffer.GetElement(index);
+    uint64_t retries = 0;
+    T original = element ? AtomicFetchMax(*element, value, &retries) : T();
+    group.RecordDeviceAtomic(retries);
+    return original;
+}
+
+using ComputeKernel = std::function<void(ComputeGroup&)>;
+
+class ComputeEmulator
+{
+public:
+    // workerCount 0 uses all hardware threads
+    explicit ComputeEmulator(unsigned int workerCount = 0);
+
+    // Equivalent of [numthreads(numThreads)] + Dispatch(groupsX, groupsY, groupsZ).
+    // When profile is set its config is used to record groupshared traffic of every group into it.
+    EmulatorDispatchStats Dispatch(const ComputeKernel& kernel, EmuUint3 numThreads, uint32_t groupsX, uint32_t groupsY, uint32_t groupsZ = 1, SharedMemoryProfile* profile = nullptr) const;
+
+    unsigned int GetWorkerCount() const { return m_workerCount; }
+
+private:
+    unsigned int m_workerCount;
+};
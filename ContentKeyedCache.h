@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Values keyed by content hashes (see HashUtils.h), e.g. root signatures by the hash of their serialized
+// blob. Every entry keeps a copy of the bytes it was created from: a lookup whose key matches but whose
+// bytes differ is a hash collision and throws instead of returning the value made for other content.
+template <typename Key, typename Value>
+class ContentKeyedCache
+{
+public:
+    // name only goes into the collision message
+    explicit ContentKeyedCache(std::string name)
+        : m_name(std::move(name))
+    {
+    }
+
+    // Returns nullptr on a miss
+    Value* Find(const Key& key, const void* content, size_t size)
+    {
+        auto it = m_entries.find(key);
+        if (it == m_entries.end())
+        {
+            return nullptr;
+        }
+        const std::vector<uint8_t>& stored = it->second.content;
+        if (stored.size() != size || (size != 0 && std::memcmp(stored.data(), content, size) != 0))
+        {
+            throw std::runtime_error(m_name + " hash collision");
+        }
+        return &it->second.value;
+    }
+
+    // The key must not be present yet, Find first
+    Value& Insert(const Key& key, const void* content, size_t size, Value value)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(content);
+        Entry entry{ std::vector<uint8_t>(bytes, bytes + size), std::move(value) };
+        auto inserted = m_entries.emplace(key, std::move(entry));
+        if (!inserted.second)
+        {
+            throw std::logic_error(m_name + " entry inserted twice");
+        }
+        return inserted.first->second.value;
+    }
+
+    size_t Size() const { return m_entries.size(); }
+
+private:
+    struct Entry
+    {
+        std::vector<uint8_t> content;
+        Value value;
+    };
+
+    std::string m_name;
+    std::map<Key, Entry> m_entries;
+};
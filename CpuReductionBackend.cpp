@@ -0,0 +1,186 @@
+#include "CpuReductionBackend.h"
+#include "SimdReduction.h"
+#include "TiledReduction.h"
+#include "AtomicUtils.h"
+#include "ReductionLayout.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace
+{
+    // 64 KiB of R8 texels per task, whole cache lines and long SIMD runs per row
+    const uint32_t DefaultHostTileWidth = 4096;
+    const uint32_t DefaultHostTileHeight = 16;
+}
+
+CpuReductionBackend::CpuReductionBackend(unsigned int workerCount, ReductionStrategy strategy)
+    : m_workerCount(workerCount), m_strategy(strategy)
+{
+}
+
+void CpuReductionBackend::CreateDevice()
+{
+    // No device to create, just start the worker threads
+    if (!m_pool)
+    {
+        m_pool = std::make_unique<WorkStealingThreadPool>(m_workerCount);
+    }
+}
+
+std::string CpuReductionBackend::GetDeviceId() const
+{
+    return std::string("cpu-") + GetSimdLevelName(DetectSimdLevel()) + "-" + std::to_string(std::thread::hardware_concurrency()) + "t";
+}
+
+std::vector<TuningVariant> CpuReductionBackend::GetTuningVariants() const
+{
+    const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    std::vector<unsigned int> workerCounts = { 0 };
+    if (hardwareThreads >= 2)
+    {
+        workerCounts.push_back(hardwareThreads / 2);
+    }
+
+    std::vector<TuningVariant> variants;
+    for (unsigned int workerCount : workerCounts)
+    {
+        // AtomicMax does one update per compute tile, so only the group size changes its work split
+        if (m_strategy == ReductionStrategy::AtomicMax)
+        {
+            for (uint32_t threadGroupSize : { 8u, 16u, 32u, 64u })
+            {
+                TuningVariant variant;
+                variant.threadGroupSize = threadGroupSize;
+                variant.workerCount = workerCount;
+                variants.push_back(variant);
+            }
+            continue;
+        }
+
+        for (uint32_t tileWidth : { 1024u, 4096u, 16384u })
+        {
+            for (uint32_t tileHeight : { 4u, 16u, 64u })
+            {
+                TuningVariant variant;
+                variant.workerCount = workerCount;
+                variant.tileWidth = tileWidth;
+                variant.tileHeight = tileHeight;
+                variants.push_back(variant);
+            }
+        }
+    }
+    return variants;
+}
+
+void CpuReductionBackend::ApplyTuningVariant(const TuningVariant& variant)
+{
+    // A different worker count needs a new pool, the next dispatch starts it
+    if (variant.workerCount != m_workerCount)
+    {
+        m_pool.reset();
+        m_workerCount = variant.workerCount;
+    }
+    m_tileWidth = variant.tileWidth;
+    m_tileHeight = variant.tileHeight;
+}
+
+void CpuReductionBackend::UploadTexture(const uint8_t* texels, uint32_t width, uint32_t height, uint32_t rowPitch)
+{
+    if (texels == nullptr || rowPitch < width)
+    {
+        throw std::runtime_error("Invalid texture data for CPU upload");
+    }
+
+    // Store the texture tightly packed, like the GPU copy from the upload heap
+    SetTextureSize(width, height);
+    m_width = width;
+    m_height = height;
+    m_texels.resize(static_cast<size_t>(width) * height);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        std::memcpy(m_texels.data() + static_cast<size_t>(y) * width, texels + static_cast<size_t>(y) * rowPitch, width);
+    }
+}
+
+TextureUploadRegion CpuReductionBackend::BeginTextureUpload(uint32_t width, uint32_t height)
+{
+    // The texels are written where Dispatch reads them
+    SetTextureSize(width, height);
+    m_width = width;
+    m_height = height;
+    m_texels.resize(static_cast<size_t>(width) * height);
+
+    TextureUploadRegion region;
+    region.texels = m_texels.data();
+    region.rowPitch = width;
+    return region;
+}
+
+void CpuReductionBackend::DispatchKernel(uint32_t threadGroupSize)
+{
+    if (threadGroupSize == 0)
+    {
+        throw std::runtime_error("Thread group size must be non-zero");
+    }
+    if (!m_pool)
+    {
+        CreateDevice();
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    if (m_strategy == ReductionStrategy::AtomicMax)
+    {
+        // Same groups as the Dispatch() call of the D3D12 path, every tile max goes into one atomic.
+        // One task per group, a row of groups per chunk so small tiles are not scheduled one by one.
+        const ReductionLayout layout = MakeReductionLayout(m_width, m_height, threadGroupSize);
+        const uint32_t groupsX = layout.constants.groupsX;
+        m_atomicMax.store(0);
+        m_atomicRetries.store(0);
+        m_atomicUpdates = layout.partialCount;
+        m_pool->ParallelFor(layout.partialCount, groupsX, [&](size_t group, unsigned int)
+        {
+            const uint32_t x0 = static_cast<uint32_t>(group % groupsX) * threadGroupSize;
+            const uint32_t y0 = static_cast<uint32_t>(group / groupsX) * threadGroupSize;
+            const uint32_t x1 = std::min(x0 + threadGroupSize, m_width);
+            const uint32_t y1 = std::min(y0 + threadGroupSize, m_height);
+            const uint8_t* tile = m_texels.data() + static_cast<size_t>(y0) * m_width + x0;
+            uint64_t retries = 0;
+            AtomicFetchMax(m_atomicMax, ReduceMinMax(tile, x1 - x0, y1 - y0, m_width, TexelFormat::R8).maxValue, &retries);
+            m_atomicRetries += retries;
+        });
+        m_maxValue = m_atomicMax.load();
+    }
+    else
+    {
+        // Host tiles, threadGroupSize does not change the result and is not worth a task of its own
+        TiledReductionConfig config;
+        config.tileWidth = m_tileWidth ? m_tileWidth : DefaultHostTileWidth;
+        config.tileHeight = m_tileHeight ? m_tileHeight : DefaultHostTileHeight;
+        config.tilesPerTask = 1;
+        m_maxValue = TiledReduceMinMax(*m_pool, m_texels.data(), m_width, m_height, m_width, TexelFormat::R8, config).maxValue;
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    m_lastDispatchTimeMs = std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+bool CpuReductionBackend::GetLastAtomicStats(AtomicReductionStats& stats) const
+{
+    if (m_strategy != ReductionStrategy::AtomicMax)
+    {
+        return false;
+    }
+    stats.deviceAtomics = m_atomicUpdates;
+    stats.atomicRetries = m_atomicRetries.load();
+    return true;
+}
+
+uint32_t CpuReductionBackend::ReadBack()
+{
+    return m_maxValue;
+}
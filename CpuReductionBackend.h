@@ -0,0 +1,57 @@
+#pragma once
+
+#include "ReductionBackend.h"
+#include "ThreadPool.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+
+// Portable multithreaded implementation of the max-reduction.
+// The texture is split into host tiles (4096 texels by 16 rows unless tuned otherwise) that TiledReduceMinMax
+// spreads over a work-stealing pool living as long as the backend; every worker folds its tiles into its own
+// partial, the partials are combined at the end of the dispatch. The host tile is independent of the
+// threadGroupSize compute tile, a few dozen bytes per row are too little work per task for a CPU core.
+// With ReductionStrategy::AtomicMax every threadGroupSize tile max goes straight into one atomic instead, like
+// the InterlockedMax variant, and GetAtomicRetries / GetLastAtomicStats report how often the update had to be
+// retried.
+class CpuReductionBackend : public IReductionBackend
+{
+public:
+    explicit CpuReductionBackend(unsigned int workerCount = 0, ReductionStrategy strategy = ReductionStrategy::GroupPartials);
+
+    const char* GetName() const override { return "cpu"; }
+
+    void CreateDevice() override;
+    void UploadTexture(const uint8_t* texels, uint32_t width, uint32_t height, uint32_t rowPitch) override;
+    TextureUploadRegion BeginTextureUpload(uint32_t width, uint32_t height) override;
+    void EndTextureUpload() override {}
+    uint32_t ReadBack() override;
+    double GetLastDispatchTimeMs() const override { return m_lastDispatchTimeMs; }
+    bool GetLastAtomicStats(AtomicReductionStats& stats) const override;
+    std::string GetDeviceId() const override;
+
+    // Host tiles of 1024 to 16384 texels by 4 to 64 rows (thread group sizes 8 to 64 for AtomicMax), with all or
+    // half of the hardware threads
+    std::vector<TuningVariant> GetTuningVariants() const override;
+    void ApplyTuningVariant(const TuningVariant& variant) override;
+
+    uint64_t GetAtomicRetries() const { return m_atomicRetries.load(); }
+
+protected:
+    void DispatchKernel(uint32_t threadGroupSize) override;
+
+private:
+    unsigned int m_workerCount;
+    ReductionStrategy m_strategy;
+    std::unique_ptr<WorkStealingThreadPool> m_pool;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    std::vector<uint8_t> m_texels;
+    uint32_t m_tileWidth = 0;
+    uint32_t m_tileHeight = 0;
+    uint32_t m_maxValue = 0;
+    std::atomic<uint32_t> m_atomicMax{ 0 };
+    std::atomic<uint64_t> m_atomicRetries{ 0 };
+    uint64_t m_atomicUpdates = 0;           // groups of the last AtomicMax dispatch
+    double m_lastDispatchTimeMs = 0.0;
+};
@@ -0,0 +1,237 @@
+#include "D3D12ReductionBackend.h"
+#include "DeviceResources.h"
+#include "ShaderPermutations.h"
+#include "ShaderUtils.h"
+#include "BufferReduction.h"
+#include "TextureData.h"
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+D3D12ReductionBackend::~D3D12ReductionBackend()
+{
+    // Keep the compiled PSOs for the next process, a failure only costs the next startup
+    if (m_pipelineCache)
+    {
+        try
+        {
+            m_pipelineCache->Save();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+}
+
+std::string D3D12ReductionBackend::GetDeviceId() const
+{
+    if (!m_device)
+    {
+        throw std::runtime_error("GetDeviceId needs a device");
+    }
+
+    ComPtr<IDXGIFactory4> factory;
+    ComPtr<IDXGIAdapter1> adapter;
+    if (FAILED(CreateDXGIFactory2(0, IID_PPV_ARGS(&factory))) || FAILED(factory->EnumAdapterByLuid(m_device->GetAdapterLuid(), IID_PPV_ARGS(&adapter))))
+    {
+        throw std::runtime_error("Failed to find the DXGI adapter of the D3D12 device");
+    }
+
+    DXGI_ADAPTER_DESC1 desc;
+    adapter->GetDesc1(&desc);
+
+    // A new driver can change the best variant, so its version is part of the identity
+    LARGE_INTEGER driverVersion = {};
+    adapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &driverVersion);
+
+    char id[96];
+    std::snprintf(id, sizeof(id), "d3d12-%04x-%04x-%02x-%u.%u.%u.%u", desc.VendorId, desc.DeviceId, desc.Revision,
+        HIWORD(driverVersion.HighPart), LOWORD(driverVersion.HighPart), HIWORD(driverVersion.LowPart), LOWORD(driverVersion.LowPart));
+    return id;
+}
+
+void D3D12ReductionBackend::CreateDevice()
+{
+    CreateDeviceAndCommandObjects(m_device, m_commandQueue, m_commandAllocator, m_commandList);
+    m_pipelineCache = std::make_unique<PipelineCache>(m_device.Get(), L"PipelineLibrary.bin");
+    m_shaderCompileCache = std::make_unique<ShaderCompileCache>("ShaderCache");
+    m_context = std::make_unique<ReductionContext>(m_device.Get(), m_commandQueue.Get(), m_commandList.Get(), m_commandAllocator.Get());
+
+    // An unusable archive only costs the override, the embedded permutations still work
+    if (std::ifstream("ShaderArchive.bin").good())
+    {
+        try
+        {
+            m_shaderArchive = std::make_unique<ShaderArchive>("ShaderArchive.bin");
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << ", using the embedded shaders" << std::endl;
+        }
+    }
+
+    // Reduce the partials on the GPU so only the final value is read back. Without the
+    // second pass the whole intermediate buffer is read back and reduced on the CPU as before.
+    const ShaderPermutation* bufferReduction = FindPermutation(ShaderKernel::BufferReduction, BufferReductionGroupSize);
+    if (bufferReduction == nullptr)
+    {
+        std::cerr << "No BufferReduction shader, reducing the intermediate buffer on the CPU" << std::endl;
+        return;
+    }
+    ComPtr<ID3D12RootSignature> rootSignature;
+    ID3D12PipelineState* pipelineState = m_pipelineCache->GetComputePipelineState(D3D12_SHADER_BYTECODE{ bufferReduction->bytecode, bufferReduction->bytecodeSize }, rootSignature);
+    m_context->SetBufferReductionPipeline(pipelineState, rootSignature.Get());
+}
+
+void D3D12ReductionBackend::UploadTexture(const uint8_t* texels, uint32_t width, uint32_t height, uint32_t rowPitch)
+{
+    if (texels == nullptr || rowPitch < width)
+    {
+        throw std::runtime_error("Invalid texture data for D3D12 upload");
+    }
+
+    const TextureUploadRegion region = BeginTextureUpload(width, height);
+    CopyTextureRows(region.texels, region.rowPitch, texels, rowPitch, width, height, true);
+}
+
+TextureUploadRegion D3D12ReductionBackend::BeginTextureUpload(uint32_t width, uint32_t height)
+{
+    if (!m_context)
+    {
+        throw std::runtime_error("D3D12 backend used before CreateDevice");
+    }
+
+    m_texture = m_context->BeginTextureUpload(width, height);
+    SetTextureSize(width, height);
+    TextureUploadRegion region;
+    region.texels = m_texture.data;
+    region.rowPitch = m_texture.footprint.Footprint.RowPitch;
+    region.writeCombined = true;
+    return region;
+}
+
+void D3D12ReductionBackend::DispatchKernel(uint32_t threadGroupSize)
+{
+    const ReductionResult result = WaitResult(SubmitKernel(threadGroupSize));
+    m_lastMaxValue = result.maxValue;
+    m_lastDispatchTimeMs = result.dispatchTimeMs;
+}
+
+uint64_t D3D12ReductionBackend::SubmitKernel(uint32_t threadGroupSize)
+{
+    if (!m_device)
+    {
+        throw std::runtime_error("D3D12 backend used before CreateDevice");
+    }
+
+    if (m_texture.buffer == nullptr)
+    {
+        throw std::runtime_error("D3D12 backend dispatched before a texture was uploaded");
+    }
+
+    Pipeline& pipeline = GetPipeline(threadGroupSize);
+    return m_context->Submit(pipeline.pipelineState.Get(), pipeline.rootSignature.Get(), m_texture, threadGroupSize, m_strategy);
+}
+
+bool D3D12ReductionBackend::PollResult(uint64_t ticket, ReductionResult& result)
+{
+    if (!m_context)
+    {
+        throw std::runtime_error("D3D12 backend used before CreateDevice");
+    }
+    UINT maxValue = 0;
+    if (!m_context->PollResult(ticket, maxValue, &result.dispatchTimeMs))
+    {
+        return false;
+    }
+    result.maxValue = maxValue;
+    return true;
+}
+
+ReductionResult D3D12ReductionBackend::WaitResult(uint64_t ticket)
+{
+    if (!m_context)
+    {
+        throw std::runtime_error("D3D12 backend used before CreateDevice");
+    }
+    ReductionResult result;
+    result.maxValue = m_context->WaitResult(ticket, &result.dispatchTimeMs);
+    return result;
+}
+
+uint32_t D3D12ReductionBackend::GetMaxJobsInFlight() const
+{
+    return m_context ? m_context->GetMaxJobsInFlight() : 1;
+}
+
+D3D12ReductionBackend::Pipeline& D3D12ReductionBackend::GetPipeline(uint32_t threadGroupSize)
+{
+    auto it = m_pipelines.find(threadGroupSize);
+    if (it != m_pipelines.end())
+    {
+        return it->second;
+    }
+
+    // One permutation per thread group size, see the ShaderPermutation items in test1.vcxproj
+    const ShaderKernel kernel = (m_strategy == ReductionStrategy::AtomicMax) ? ShaderKernel::AtomicMaxReduction : ShaderKernel::MaxReduction;
+    const ShaderPermutation* permutation = FindPermutation(kernel, threadGroupSize);
+    if (permutation == nullptr)
+    {
+        throw std::runtime_error(std::string("No ") + GetShaderKernelName(kernel) + " permutation for thread group size " + std::to_string(threadGroupSize));
+    }
+
+    Pipeline pipeline;
+    pipeline.pipelineState = m_pipelineCache->GetComputePipelineState(D3D12_SHADER_BYTECODE{ permutation->bytecode, permutation->bytecodeSize }, pipeline.rootSignature);
+    return m_pipelines.emplace(threadGroupSize, pipeline).first->second;
+}
+
+const ShaderPermutation* D3D12ReductionBackend::FindPermutation(ShaderKernel kernel, uint32_t threadGroupSize)
+{
+    if (m_shaderArchive)
+    {
+        if (const ShaderPermutation* permutation = m_shaderArchive->Find(kernel, threadGroupSize))
+        {
+            return permutation;
+        }
+    }
+    if (const ShaderPermutation* permutation = FindShaderPermutation(kernel, threadGroupSize))
+    {
+        return permutation;
+    }
+    return CompilePermutation(kernel, threadGroupSize);
+}
+
+const ShaderPermutation* D3D12ReductionBackend::CompilePermutation(ShaderKernel kernel, uint32_t threadGroupSize)
+{
+    auto it = m_compiledPermutations.find({ kernel, threadGroupSize });
+    if (it != m_compiledPermutations.end())
+    {
+        return &it->second.permutation;
+    }
+
+    const ShaderCompileRequest request = MakeShaderPermutationRequest(kernel, threadGroupSize, std::string());
+    if (!std::ifstream(request.sourcePath).good())
+    {
+        return nullptr;
+    }
+
+    // A source that does not compile only costs this permutation, like an unusable archive
+    CompiledPermutation compiled;
+    try
+    {
+        compiled.bytecode = CompileComputeShader(request, m_shaderCompileCache.get());
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return nullptr;
+    }
+    compiled.permutation.kernel = kernel;
+    compiled.permutation.threadGroupSize = threadGroupSize;
+    compiled.permutation.bytecode = static_cast<const unsigned char*>(compiled.bytecode->GetBufferPointer());
+    compiled.permutation.bytecodeSize = compiled.bytecode->GetBufferSize();
+    return &m_compiledPermutations.emplace(std::make_pair(kernel, threadGroupSize), compiled).first->second.permutation;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "ReductionBackend.h"
+#include "PipelineCache.h"
+#include "ReductionContext.h"
+#include "ShaderArchive.h"
+#include "ShaderCompileCache.h"
+#include <d3d12.h>
+#include <wrl.h>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+using namespace Microsoft::WRL;
+
+// IReductionBackend on top of the existing D3D12 objects and the MaxReduction shader permutations embedded
+// in the binary (AtomicMaxReduction for ReductionStrategy::AtomicMax), see ShaderPermutations.h. A
+// ShaderArchive.bin in the working directory is mapped on CreateDevice and its permutations take
+// precedence over the embedded ones. A permutation neither of them has is compiled at runtime from the
+// HLSL source in the working directory, through a ShaderCompileCache in ShaderCache\ so only the first
+// run pays for the compile.
+// Runs go through a ReductionContext so resources are reused across dispatches of the same size,
+// PSOs come from a PipelineCache backed by PipelineLibrary.bin in the working directory. Textures go
+// straight into the context's upload ring: BeginTextureUpload hands out its mapped memory, UploadTexture
+// copies the rows there once. Dispatch is Submit followed by WaitResult.
+class D3D12ReductionBackend : public IReductionBackend
+{
+public:
+    explicit D3D12ReductionBackend(ReductionStrategy strategy = ReductionStrategy::GroupPartials) : m_strategy(strategy) {}
+    ~D3D12ReductionBackend() override;
+
+    const char* GetName() const override { return "d3d12"; }
+
+    void CreateDevice() override;
+    void UploadTexture(const uint8_t* texels, uint32_t width, uint32_t height, uint32_t rowPitch) override;
+    TextureUploadRegion BeginTextureUpload(uint32_t width, uint32_t height) override;
+    void EndTextureUpload() override {}
+    uint32_t ReadBack() override { return m_lastMaxValue; }
+    double GetLastDispatchTimeMs() const override { return m_lastDispatchTimeMs; }
+
+    // Tickets of the context's SubmissionScheduler, several jobs can be on the GPU at once
+    bool PollResult(uint64_t ticket, ReductionResult& result) override;
+    ReductionResult WaitResult(uint64_t ticket) override;
+    uint32_t GetMaxJobsInFlight() const override;
+
+    // PCI vendor/device id, revision and user mode driver version of the adapter the device runs on
+    std::string GetDeviceId() const override;
+
+protected:
+    void DispatchKernel(uint32_t threadGroupSize) override;
+    uint64_t SubmitKernel(uint32_t threadGroupSize) override;
+
+private:
+    struct Pipeline
+    {
+        ComPtr<ID3D12RootSignature> rootSignature;
+        ComPtr<ID3D12PipelineState> pipelineState;
+    };
+
+    Pipeline& GetPipeline(uint32_t threadGroupSize);
+    // Archive first, then the embedded table, then a runtime compile; nullptr when none has it
+    const ShaderPermutation* FindPermutation(ShaderKernel kernel, uint32_t threadGroupSize);
+    const ShaderPermutation* CompilePermutation(ShaderKernel kernel, uint32_t threadGroupSize);
+
+    ReductionStrategy m_strategy;
+    ComPtr<ID3D12Device> m_device;
+    ComPtr<ID3D12CommandQueue> m_commandQueue;
+    ComPtr<ID3D12CommandAllocator> m_commandAllocator;
+    ComPtr<ID3D12GraphicsCommandList> m_commandList;
+    std::unique_ptr<PipelineCache> m_pipelineCache;
+    std::unique_ptr<ShaderArchive> m_shaderArchive;
+    std::unique_ptr<ShaderCompileCache> m_shaderCompileCache;
+
+    // Bytecode of runtime compiled permutations, the ShaderPermutation points into the blob
+    struct CompiledPermutation
+    {
+        ComPtr<ID3DBlob> bytecode;
+        ShaderPermutation permutation;
+    };
+    std::map<std::pair<ShaderKernel, uint32_t>, CompiledPermutation> m_compiledPermutations;
+    std::map<uint32_t, Pipeline> m_pipelines;
+    std::unique_ptr<ReductionContext> m_context;
+
+    UploadRegion m_texture;                 // texels of the next Dispatch
+    uint32_t m_lastMaxValue = 0;
+    double m_lastDispatchTimeMs = 0.0;
+};
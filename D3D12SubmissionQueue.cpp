@@ -0,0 +1,41 @@
+#include "D3D12SubmissionQueue.h"
+#include <stdexcept>
+
+D3D12SubmissionQueue::D3D12SubmissionQueue(ID3D12Device* device, ID3D12CommandQueue* commandQueue)
+    : m_commandQueue(commandQueue)
+{
+    if (FAILED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence))))
+    {
+        throw std::runtime_error("Failed to create fence");
+    }
+    m_fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (m_fenceEvent == nullptr)
+    {
+        throw std::runtime_error("Failed to create event handle");
+    }
+}
+
+D3D12SubmissionQueue::~D3D12SubmissionQueue()
+{
+    if (m_fenceEvent)
+    {
+        CloseHandle(m_fenceEvent);
+    }
+}
+
+void D3D12SubmissionQueue::Signal(uint64_t value)
+{
+    if (FAILED(m_commandQueue->Signal(m_fence.Get(), value)))
+    {
+        throw std::runtime_error("Failed to signal the submission fence");
+    }
+}
+
+void D3D12SubmissionQueue::Wait(uint64_t value)
+{
+    if (m_fence->GetCompletedValue() < value)
+    {
+        m_fence->SetEventOnCompletion(value, m_fenceEvent);
+        WaitForSingleObject(m_fenceEvent, INFINITE);
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "SubmissionScheduler.h"
+#include <d3d12.h>
+#include <wrl.h>
+
+using namespace Microsoft::WRL;
+
+// ISubmissionQueue on an ID3D12CommandQueue: one fence and one event for the lifetime of the queue
+class D3D12SubmissionQueue : public ISubmissionQueue
+{
+public:
+    D3D12SubmissionQueue(ID3D12Device* device, ID3D12CommandQueue* commandQueue);
+    ~D3D12SubmissionQueue() override;
+
+    D3D12SubmissionQueue(const D3D12SubmissionQueue&) = delete;
+    D3D12SubmissionQueue& operator=(const D3D12SubmissionQueue&) = delete;
+
+    void Signal(uint64_t value) override;
+    uint64_t GetCompletedValue() override { return m_fence->GetCompletedValue(); }
+    void Wait(uint64_t value) override;
+
+private:
+    ID3D12CommandQueue* m_commandQueue;
+    ComPtr<ID3D12Fence> m_fence;
+    HANDLE m_fenceEvent = nullptr;
+};
@@ -0,0 +1,233 @@
+#include "DescriptorAllocator.h"
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+DescriptorFreeListAllocator::DescriptorFreeListAllocator(uint32_t base, uint32_t capacity)
+    : m_base(base), m_capacity(capacity), m_freeCount(capacity)
+{
+    if (capacity > 0)
+    {
+        m_freeBlocks[base] = capacity;
+    }
+}
+
+uint32_t DescriptorFreeListAllocator::Allocate(uint32_t count)
+{
+    if (count == 0)
+    {
+        return InvalidDescriptorOffset;
+    }
+
+    for (auto it = m_freeBlocks.begin(); it != m_freeBlocks.end(); ++it)
+    {
+        if (it->second < count)
+        {
+            continue;
+        }
+        const uint32_t offset = it->first;
+        const uint32_t remaining = it->second - count;
+        m_freeBlocks.erase(it);
+        if (remaining > 0)
+        {
+            m_freeBlocks[offset + count] = remaining;
+        }
+        m_freeCount -= count;
+        return offset;
+    }
+    return InvalidDescriptorOffset;
+}
+
+void DescriptorFreeListAllocator::Free(uint32_t offset, uint32_t count)
+{
+    if (count == 0)
+    {
+        return;
+    }
+    if (offset < m_base || count > m_capacity || offset - m_base > m_capacity - count)
+    {
+        throw std::runtime_error("Descriptor range outside the allocator");
+    }
+
+    auto next = m_freeBlocks.lower_bound(offset);
+    if ((next != m_freeBlocks.end() && next->first < offset + count) ||
+        (next != m_freeBlocks.begin() && std::prev(next)->first + std::prev(next)->second > offset))
+    {
+        throw std::runtime_error("Descriptor range freed twice");
+    }
+
+    uint32_t blockOffset = offset;
+    uint32_t blockCount = count;
+    if (next != m_freeBlocks.begin())
+    {
+        auto previous = std::prev(next);
+        if (previous->first + previous->second == offset)
+        {
+            blockOffset = previous->first;
+            blockCount += previous->second;
+            m_freeBlocks.erase(previous);
+        }
+    }
+    if (next != m_freeBlocks.end() && next->first == offset + count)
+    {
+        blockCount += next->second;
+        m_freeBlocks.erase(next);
+    }
+    m_freeBlocks[blockOffset] = blockCount;
+    m_freeCount += count;
+}
+
+uint32_t DescriptorFreeListAllocator::GetLargestFreeBlock() const
+{
+    uint32_t largest = 0;
+    for (const auto& block : m_freeBlocks)
+    {
+        largest = std::max(largest, block.second);
+    }
+    return largest;
+}
+
+DescriptorRingAllocator::DescriptorRingAllocator(uint32_t base, uint32_t capacity)
+    : m_base(base), m_capacity(capacity)
+{
+}
+
+uint32_t DescriptorRingAllocator::Allocate(uint32_t count)
+{
+    if (count == 0 || count > m_capacity - m_used)
+    {
+        return InvalidDescriptorOffset;
+    }
+    if (m_used == 0)
+    {
+        m_head = 0;
+        m_tail = 0;
+    }
+
+    // Free slots are [head, capacity) + [0, tail) when head is at or past tail, [head, tail) otherwise
+    uint32_t offset = m_head;
+    uint32_t skipped = 0;
+    if (m_head >= m_tail)
+    {
+        if (m_capacity - m_head < count)
+        {
+            if (m_tail < count)
+            {
+                return InvalidDescriptorOffset;
+            }
+            skipped = m_capacity - m_head;
+            offset = 0;
+        }
+    }
+    else if (m_tail - m_head < count)
+    {
+        return InvalidDescriptorOffset;
+    }
+
+    m_head = (offset + count == m_capacity) ? 0 : offset + count;
+    m_used += skipped + count;
+    m_pending += skipped + count;
+    return m_base + offset;
+}
+
+void DescriptorRingAllocator::Retire(uint64_t fenceValue)
+{
+    if (m_pending == 0)
+    {
+        return;
+    }
+    if (!m_retired.empty() && m_retired.back().fenceValue > fenceValue)
+    {
+        throw std::runtime_error("Descriptor ring retired with a decreasing fence value");
+    }
+    m_retired.push_back({ fenceValue, m_pending });
+    m_pending = 0;
+}
+
+void DescriptorRingAllocator::Release(uint64_t completedFenceValue)
+{
+    while (!m_retired.empty() && m_retired.front().fenceValue <= completedFenceValue)
+    {
+        const uint32_t count = m_retired.front().count;
+        m_tail = (m_tail + count) % m_capacity;
+        m_used -= count;
+        m_retired.pop_front();
+    }
+}
+
+bool DescriptorRingAllocator::GetOldestFenceValue(uint64_t& fenceValue) const
+{
+    if (m_retired.empty())
+    {
+        return false;
+    }
+    fenceValue = m_retired.front().fenceValue;
+    return true;
+}
+
+void WriteDescriptorAllocatorReport(std::ostream& out, uint32_t capacity, uint32_t operations, uint32_t framesInFlight, uint64_t seed)
+{
+    std::mt19937_64 random(seed);
+    std::uniform_int_distribution<uint32_t> sizes(1, 16);
+
+    // Persistent: keep the allocator about three quarters full, freeing a random live range when above
+    DescriptorFreeListAllocator persistent(0, capacity);
+    std::vector<std::pair<uint32_t, uint32_t>> live;
+    uint64_t persistentFailures = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+        if (!live.empty() && (persistent.GetFreeCount() < capacity / 4 || random() % 2 == 0))
+        {
+            const size_t index = static_cast<size_t>(random() % live.size());
+            persistent.Free(live[index].first, live[index].second);
+            live[index] = live.back();
+            live.pop_back();
+            continue;
+        }
+        const uint32_t count = sizes(random);
+        const uint32_t offset = persistent.Allocate(count);
+        if (offset == InvalidDescriptorOffset)
+        {
+            ++persistentFailures;
+            continue;
+        }
+        live.push_back({ offset, count });
+    }
+    const double persistentSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const uint32_t freeCount = persistent.GetFreeCount();
+    const double fragmentation = freeCount > 0 ? 1.0 - static_cast<double>(persistent.GetLargestFreeBlock()) / freeCount : 0.0;
+
+    // Transient: frames of up to 32 tables, frame n is released when frame n - framesInFlight completes
+    DescriptorRingAllocator ring(0, capacity);
+    uint64_t transientFailures = 0;
+    uint64_t frame = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < operations; ++i)
+    {
+        if (i % 32 == 31)
+        {
+            ring.Retire(++frame);
+            if (frame > framesInFlight)
+            {
+                ring.Release(frame - framesInFlight);
+            }
+        }
+        if (ring.Allocate(sizes(random)) == InvalidDescriptorOffset)
+        {
+            ++transientFailures;
+        }
+    }
+    const double transientSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    out << "Descriptor allocators, " << capacity << " slots, " << operations << " operations, seed " << seed << std::endl;
+    out << "  free list: " << operations / std::max(persistentSeconds, 1e-9) / 1e6 << " M ops/s, " << persistentFailures << " failed allocations, "
+        << live.size() << " live ranges, " << freeCount << " free slots in " << persistent.GetFreeBlockCount() << " blocks, largest "
+        << persistent.GetLargestFreeBlock() << ", fragmentation " << fragmentation << std::endl;
+    out << "  ring: " << operations / std::max(transientSeconds, 1e-9) / 1e6 << " M ops/s, " << transientFailures << " failed allocations with "
+        << framesInFlight << " frames in flight, " << ring.GetUsedCount() << " slots in use" << std::endl;
+}
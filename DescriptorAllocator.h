@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <ostream>
+
+// Descriptor index allocators, independent of D3D12: they hand out ranges of slots in a heap and
+// DescriptorHeap.h maps the slots to handles. Both allocate contiguous ranges so a range can be bound
+// as one descriptor table.
+
+const uint32_t InvalidDescriptorOffset = 0xffffffffu;
+
+// Persistent descriptors, e.g. the views of cached resources. First fit over a free list ordered by
+// offset, freed ranges are merged with their free neighbours.
+class DescriptorFreeListAllocator
+{
+public:
+    DescriptorFreeListAllocator(uint32_t base, uint32_t capacity);
+
+    // Offset of count free slots, InvalidDescriptorOffset when no free block is large enough
+    uint32_t Allocate(uint32_t count);
+    // offset and count of an earlier Allocate
+    void Free(uint32_t offset, uint32_t count);
+
+    uint32_t GetCapacity() const { return m_capacity; }
+    uint32_t GetFreeCount() const { return m_freeCount; }
+    uint32_t GetLargestFreeBlock() const;
+    size_t GetFreeBlockCount() const { return m_freeBlocks.size(); }
+
+private:
+    uint32_t m_base;
+    uint32_t m_capacity;
+    uint32_t m_freeCount;
+    std::map<uint32_t, uint32_t> m_freeBlocks;      // offset -> count
+};
+
+// Transient descriptors, e.g. tables written for a single dispatch. Allocations are handed out in
+// order from a ring; Retire tags everything allocated since the previous Retire with a fence value
+// and Release returns it once the fence has reached that value. A range never wraps: when the tail
+// of the ring is too short it is skipped and released with the allocation that follows it.
+class DescriptorRingAllocator
+{
+public:
+    DescriptorRingAllocator(uint32_t base, uint32_t capacity);
+
+    // Offset of count slots, InvalidDescriptorOffset while the ring is too full
+    uint32_t Allocate(uint32_t count);
+    // Fence values have to be passed in increasing order
+    void Retire(uint64_t fenceValue);
+    void Release(uint64_t completedFenceValue);
+
+    // Fence value the oldest retired allocations wait for, false when nothing is retired
+    bool GetOldestFenceValue(uint64_t& fenceValue) const;
+
+    uint32_t GetCapacity() const { return m_capacity; }
+    uint32_t GetUsedCount() const { return m_used; }
+
+private:
+    struct RetiredBlock
+    {
+        uint64_t fenceValue;
+        uint32_t count;         // including skipped slots
+    };
+
+    uint32_t m_base;
+    uint32_t m_capacity;
+    uint32_t m_head = 0;        // next allocation
+    uint32_t m_tail = 0;        // oldest slot in use
+    uint32_t m_used = 0;
+    uint32_t m_pending = 0;     // allocated since the last Retire
+    std::deque<RetiredBlock> m_retired;
+};
+
+// Synthetic workload for both allocators, no device needed: persistent ranges of 1-16 slots are
+// allocated and freed at random (seeded), transient tables are retired per frame and released
+// framesInFlight frames later. Writes throughput, failed allocations and free list fragmentation.
+void WriteDescriptorAllocatorReport(std::ostream& out, uint32_t capacity, uint32_t operations, uint32_t framesInFlight, uint64_t seed);
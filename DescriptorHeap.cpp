@@ -0,0 +1,112 @@
+#include "DescriptorHeap.h"
+#include <stdexcept>
+#include <string>
+
+DescriptorHeap::DescriptorHeap(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t persistentCount, uint32_t ringCount, bool shaderVisible)
+    : m_persistent(0, persistentCount), m_ring(persistentCount, ringCount)
+{
+    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
+    heapDesc.NumDescriptors = persistentCount + ringCount;
+    heapDesc.Type = type;
+    heapDesc.Flags = shaderVisible ? D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE : D3D12_DESCRIPTOR_HEAP_FLAG_NONE;
+    if (FAILED(device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&m_heap))))
+    {
+        throw std::runtime_error("Failed to create descriptor heap");
+    }
+    m_descriptorSize = device->GetDescriptorHandleIncrementSize(type);
+    m_cpuStart = m_heap->GetCPUDescriptorHandleForHeapStart();
+    if (shaderVisible)
+    {
+        m_gpuStart = m_heap->GetGPUDescriptorHandleForHeapStart();
+    }
+
+    if (ringCount > 0)
+    {
+        if (FAILED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence))))
+        {
+            throw std::runtime_error("Failed to create fence");
+        }
+        m_fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+        if (m_fenceEvent == nullptr)
+        {
+            throw std::runtime_error("Failed to create event handle");
+        }
+    }
+}
+
+DescriptorHeap::~DescriptorHeap()
+{
+    if (m_fenceEvent)
+    {
+        CloseHandle(m_fenceEvent);
+    }
+}
+
+DescriptorRange DescriptorHeap::AllocatePersistent(uint32_t count)
+{
+    DescriptorRange range;
+    range.offset = m_persistent.Allocate(count);
+    range.count = range.IsValid() ? count : 0;
+    return range;
+}
+
+void DescriptorHeap::FreePersistent(const DescriptorRange& range)
+{
+    if (range.IsValid())
+    {
+        m_persistent.Free(range.offset, range.count);
+    }
+}
+
+DescriptorRange DescriptorHeap::AllocateTransient(uint32_t count)
+{
+    if (count == 0 || count > m_ring.GetCapacity())
+    {
+        throw std::runtime_error("Cannot allocate " + std::to_string(count) + " transient descriptors from a ring of " + std::to_string(m_ring.GetCapacity()));
+    }
+
+    DescriptorRange range;
+    range.count = count;
+    m_ring.Release(m_fence->GetCompletedValue());
+    range.offset = m_ring.Allocate(count);
+    while (!range.IsValid())
+    {
+        uint64_t fenceValue = 0;
+        if (!m_ring.GetOldestFenceValue(fenceValue))
+        {
+            throw std::runtime_error("Descriptor ring is full of allocations that were never retired");
+        }
+        if (m_fence->GetCompletedValue() < fenceValue)
+        {
+            m_fence->SetEventOnCompletion(fenceValue, m_fenceEvent);
+            WaitForSingleObject(m_fenceEvent, INFINITE);
+        }
+        m_ring.Release(fenceValue);
+        range.offset = m_ring.Allocate(count);
+    }
+    return range;
+}
+
+void DescriptorHeap::RetireTransient(ID3D12CommandQueue* commandQueue)
+{
+    if (!m_fence)
+    {
+        return;
+    }
+    commandQueue->Signal(m_fence.Get(), ++m_fenceValue);
+    m_ring.Retire(m_fenceValue);
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE DescriptorHeap::GetCpuHandle(uint32_t offset) const
+{
+    D3D12_CPU_DESCRIPTOR_HANDLE handle = m_cpuStart;
+    handle.ptr += static_cast<SIZE_T>(offset) * m_descriptorSize;
+    return handle;
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE DescriptorHeap::GetGpuHandle(uint32_t offset) const
+{
+    D3D12_GPU_DESCRIPTOR_HANDLE handle = m_gpuStart;
+    handle.ptr += static_cast<UINT64>(offset) * m_descriptorSize;
+    return handle;
+}
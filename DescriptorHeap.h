@@ -0,0 +1,99 @@
+#pragma once
+
+#include "DescriptorAllocator.h"
+#include <d3d12.h>
+#include <wrl.h>
+#include <cstdint>
+
+using namespace Microsoft::WRL;
+
+struct DescriptorRange
+{
+    uint32_t offset = InvalidDescriptorOffset;
+    uint32_t count = 0;
+
+    bool IsValid() const { return offset != InvalidDescriptorOffset; }
+};
+
+// One descriptor heap for a context, created once instead of a heap per resource set or per run.
+// Slots [0, persistentCount) are handed out by a DescriptorFreeListAllocator, the ringCount slots after
+// them by a DescriptorRingAllocator whose allocations are retired on the heap's own fence, so a caller
+// only has to call RetireTransient after submitting the command list that uses them.
+// The handle increment size is queried once.
+class DescriptorHeap
+{
+public:
+    DescriptorHeap(ID3D12Device* device, D3D12_DESCRIPTOR_HEAP_TYPE type, uint32_t persistentCount, uint32_t ringCount, bool shaderVisible);
+    ~DescriptorHeap();
+
+    DescriptorHeap(const DescriptorHeap&) = delete;
+    DescriptorHeap& operator=(const DescriptorHeap&) = delete;
+
+    // Invalid range when the persistent slots are exhausted, the caller decides what to release
+    DescriptorRange AllocatePersistent(uint32_t count);
+    void FreePersistent(const DescriptorRange& range);
+
+    // Releases completed transient ranges and, when the ring is still full, waits for the oldest
+    // submission. Throws when count can never fit or nothing has been retired yet.
+    DescriptorRange AllocateTransient(uint32_t count);
+    // Transient ranges allocated so far stay reserved until the GPU passes this point of queue
+    void RetireTransient(ID3D12CommandQueue* commandQueue);
+
+    D3D12_CPU_DESCRIPTOR_HANDLE GetCpuHandle(uint32_t offset) const;
+    D3D12_GPU_DESCRIPTOR_HANDLE GetGpuHandle(uint32_t offset) const;
+
+    ID3D12DescriptorHeap* Get() const { return m_heap.Get(); }
+    uint32_t GetDescriptorSize() const { return m_descriptorSize; }
+    const DescriptorFreeListAllocator& GetPersistentAllocator() const { return m_persistent; }
+    const DescriptorRingAllocator& GetRingAllocator() const { return m_ring; }
+
+private:
+    ComPtr<ID3D12DescriptorHeap> m_heap;
+    uint32_t m_descriptorSize = 0;
+    D3D12_CPU_DESCRIPTOR_HANDLE m_cpuStart = {};
+    D3D12_GPU_DESCRIPTOR_HANDLE m_gpuStart = {};
+    DescriptorFreeListAllocator m_persistent;
+    DescriptorRingAllocator m_ring;
+    ComPtr<ID3D12Fence> m_fence;
+    uint64_t m_fenceValue = 0;
+    HANDLE m_fenceEvent = nullptr;
+};
+
+// Persistent range that is returned to its heap on destruction. Move only, so it can live in the
+// values of an LruResourceCache and be freed on eviction.
+class PersistentDescriptors
+{
+public:
+    PersistentDescriptors() = default;
+    PersistentDescriptors(DescriptorHeap* heap, const DescriptorRange& range) : m_heap(heap), m_range(range) {}
+    ~PersistentDescriptors() { Reset(); }
+
+    PersistentDescriptors(PersistentDescriptors&& other) noexcept : m_heap(other.m_heap), m_range(other.m_range) { other.m_heap = nullptr; }
+    PersistentDescriptors& operator=(PersistentDescriptors&& other) noexcept
+    {
+        if (this != &other)
+        {
+            Reset();
+            m_heap = other.m_heap;
+            m_range = other.m_range;
+            other.m_heap = nullptr;
+        }
+        return *this;
+    }
+
+    void Reset()
+    {
+        if (m_heap != nullptr)
+        {
+            m_heap->FreePersistent(m_range);
+            m_heap = nullptr;
+        }
+    }
+
+    D3D12_CPU_DESCRIPTOR_HANDLE GetCpuHandle(uint32_t index = 0) const { return m_heap->GetCpuHandle(m_range.offset + index); }
+    D3D12_GPU_DESCRIPTOR_HANDLE GetGpuHandle(uint32_t index = 0) const { return m_heap->GetGpuHandle(m_range.offset + index); }
+
+private:
+    DescriptorHeap* m_heap = nullptr;
+    DescriptorRange m_range;
+};
@@ -0,0 +1,367 @@
+#include "EmulatedKernels.h"
+#include "BufferReduction.h"
+#include "ReductionLayout.h"
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+
+ComputeKernel MakeMaxReductionKernel(uint32_t threadGroupSize, const ReductionConstants& constants, const EmuTexture2D<uint8_t>& inputTexture, EmuRWStructuredBuffer<uint32_t>& outputBuffer)
+{
+    const uint32_t THREAD_GROUP_SIZE = threadGroupSize;
+    const uint32_t groupsX = constants.groupsX;
+    const EmuTexture2D<uint8_t>* input = &inputTexture;
+    EmuRWStructuredBuffer<uint32_t>* output = &outputBuffer;
+
+    return [THREAD_GROUP_SIZE, groupsX, input, output](ComputeGroup& group)
+    {
+        const uint32_t THREAD_COUNT = THREAD_GROUP_SIZE * THREAD_GROUP_SIZE;
+        GroupSharedArray<uint32_t> sharedData = group.AllocateShared<uint32_t>(THREAD_COUNT);
+
+        group.ForEachThread([&](const ComputeThreadIds& ids)
+        {
+            sharedData.Store(ids.groupIndex, input->Load(ids.dispatchThreadId.x, ids.dispatchThreadId.y));
+        });
+        group.GroupMemoryBarrierWithGroupSync();
+
+        for (uint32_t stride = THREAD_COUNT / 2; stride > 0; stride >>= 1)
+        {
+            group.ForEachThread([&](const ComputeThreadIds& ids)
+            {
+                if (ids.groupIndex < stride)
+                {
+                    sharedData.Store(ids.groupIndex, std::max(sharedData.Load(ids.groupIndex), sharedData.Load(ids.groupIndex + stride)));
+                }
+            });
+            group.GroupMemoryBarrierWithGroupSync();
+        }
+
+        group.ForEachThread([&](const ComputeThreadIds& ids)
+        {
+            if (ids.groupIndex == 0)
+            {
+                output->Store(ids.groupId.y * groupsX + ids.groupId.x, sharedData.Load(0));
+            }
+        });
+    };
+}
+
+ComputeKernel MakeLegacyMaxReductionKernel(uint32_t threadGroupSize, const EmuTexture2D<uint8_t>& inputTexture, EmuRWStructuredBuffer<uint32_t>& outputBuffer)
+{
+    const uint32_t THREAD_GROUP_SIZE = threadGroupSize;
+    const EmuTexture2D<uint8_t>* input = &inputTexture;
+    EmuRWStructuredBuffer<uint32_t>* output = &outputBuffer;
+
+    return [THREAD_GROUP_SIZE, input, output](ComputeGroup& group)
+    {
+        GroupSharedArray<float> sharedData = group.AllocateShared<float>(THREAD_GROUP_SIZE * THREAD_GROUP_SIZE);
+
+        group.ForEachThread([&](const ComputeThreadIds& ids)
+        {
+            const uint32_t index = ids.groupThreadId.y * THREAD_GROUP_SIZE + ids.groupThreadId.x;
+            sharedData.Store(index, input->Load(ids.dispatchThreadId.x, ids.dispatchThreadId.y) / 255.0f);
+        });
+        group.GroupMemoryBarrierWithGroupSync();
+
+        for (uint32_t stride = THREAD_GROUP_SIZE / 2; stride > 0; stride >>= 1)
+        {
+            group.ForEachThread([&](const ComputeThreadIds& ids)
+            {
+                const uint32_t index = ids.groupThreadId.y * THREAD_GROUP_SIZE + ids.groupThreadId.x;
+                if (ids.groupThreadId.x < stride)
+                {
+                    sharedData.Store(index, std::max(sharedData.Load(index), sharedData.Load(index + stride)));
+                }
+            });
+            group.GroupMemoryBarrierWithGroupSync();
+        }
+
+        group.ForEachThread([&](const ComputeThreadIds& ids)
+        {
+            if (ids.groupThreadId.x == 0 && ids.groupThreadId.y == 0)
+            {
+                output->Store(ids.groupId.y * THREAD_GROUP_SIZE + ids.groupId.x, static_cast<uint32_t>(sharedData.Load(0) * 255.0f));
+            }
+        });
+    };
+}
+
+ComputeKernel MakeRowMaxReductionKernel(const EmuTexture2D<uint8_t>& inputTexture, EmuRWStructuredBuffer<float>& outputBuffer)
+{
+    const EmuTexture2D<uint8_t>* input = &inputTexture;
+    EmuRWStructuredBuffer<float>* output = &outputBuffer;
+
+    return [input, output](ComputeGroup& group)
+    {
+        GroupSharedArray<float> sharedData = group.AllocateShared<float>(16 * 16);
+
+        group.ForEachThread([&](const ComputeThreadIds& ids)
+        {
+            float value = input->Load(ids.dispatchThreadId.x, ids.dispatchThreadId.y) / 255.0f;
+            sharedData.Store(ids.groupThreadId.y * 16 + ids.groupThreadId.x, value);
+        });
+        group.GroupMemoryBarrierWithGroupSync();
+
+        for (uint32_t stride = 8; stride > 0; stride >>= 1)
+        {
+            group.ForEachThread([&](const ComputeThreadIds& ids)
+            {
+                uint32_t index = ids.groupThreadId.y * 16 + ids.groupThreadId.x;
+                if (ids.groupThreadId.x < stride)
+                {
+                    sharedData.Store(index, std::max(sharedData.Load(index), sharedData.Load(index + stride)));
+                }
+            });
+            group.GroupMemoryBarrierWithGroupSync();
+        }
+
+        group.ForEachThread([&](const ComputeThreadIds& ids)
+        {
+            if (ids.groupThreadId.x == 0)
+            {
+                output->Store(ids.groupId.y * 16 + ids.groupId.x, sharedData.Load(ids.groupThreadId.y * 16));
+            }
+        });
+    };
+}
+
+std::vector<float> EmulateRowMaxReduction(const ComputeEmulator& emulator, const std::vector<uint8_t>& textureBytes, uint32_t width, uint32_t height, EmulatorDispatchStats* stats)
+{
+    if (width == 0 || height == 0 || textureBytes.size() < static_cast<size_t>(width) * height)
+    {
+        throw std::runtime_error("Invalid arguments for emulated row reduction");
+    }
+
+    const uint32_t groupsX = (width + 15) / 16;
+    const uint32_t groupsY = (height + 15) / 16;
+    EmuTexture2D<uint8_t> inputTexture(textureBytes.data(), width, height, width);
+    EmuRWStructuredBuffer<float> outputBuffer((groupsY - 1) * 16 + groupsX);
+
+    EmulatorDispatchStats dispatchStats = emulator.Dispatch(MakeRowMaxReductionKernel(inputTexture, outputBuffer), { 16, 16, 1 }, groupsX, groupsY, 1);
+    if (stats)
+    {
+        *stats = dispatchStats;
+    }
+
+    return outputBuffer.ToVector();
+}
+
+uint32_t EmulateReadBackR8UNormValues(const ComputeEmulator& emulator, const std::vector<uint8_t>& textureBytes, uint32_t width, uint32_t height, uint32_t threadGroupSize, EmulatorDispatchStats* stats)
+{
+    if (threadGroupSize == 0 || textureBytes.size() < static_cast<size_t>(width) * height)
+    {
+        throw std::runtime_error("Invalid arguments for emulated reduction");
+    }
+
+    // Same buffer size and dispatch size as ReadBackR8UNormValues
+    const ReductionLayout layout = MakeReductionLayout(width, height, threadGroupSize);
+    EmuTexture2D<uint8_t> inputTexture(textureBytes.data(), width, height, width);
+    EmuRWStructuredBuffer<uint32_t> intermediateBuffer(layout.partialCount);
+
+    ComputeKernel kernel = MakeMaxReductionKernel(threadGroupSize, layout.constants, inputTexture, intermediateBuffer);
+    EmulatorDispatchStats dispatchStats = emulator.Dispatch(kernel, { threadGroupSize, threadGroupSize, 1 }, layout.constants.groupsX, layout.constants.groupsY, 1);
+    if (stats)
+    {
+        *stats = dispatchStats;
+    }
+
+    std::vector<uint32_t> data = intermediateBuffer.ToVector();
+    return data.empty() ? 0 : *std::max_element(data.begin(), data.end());
+}
+
+ComputeKernel MakeBufferMaxReductionKernel(const EmuRWStructuredBuffer<uint32_t>& inputBuffer, EmuRWStructuredBuffer<uint32_t>& outputBuffer)
+{
+    const uint32_t REDUCTION_GROUP_SIZE = BufferReductionGroupSize;
+    const EmuRWStructuredBuffer<uint32_t>* input = &inputBuffer;
+    EmuRWStructuredBuffer<uint32_t>* output = &outputBuffer;
+
+    return [REDUCTION_GROUP_SIZE, input, output](ComputeGroup& group)
+    {
+        GroupSharedArray<uint32_t> sharedData = group.AllocateShared<uint32_t>(REDUCTION_GROUP_SIZE);
+        const uint32_t count = input->Size();
+
+        group.ForEachThread([&](const ComputeThreadIds& ids)
+        {
+            uint32_t first = ids.groupId.x * REDUCTION_GROUP_SIZE * 2 + ids.groupThreadId.x;
+            uint32_t value = 0;
+            if (first < count)
+            {
+                value = input->Load(first);
+            }
+            if (first + REDUCTION_GROUP_SIZE < count)
+            {
+                value = std::max(value, input->Load(first + REDUCTION_GROUP_SIZE));
+            }
+            sharedData.Store(ids.groupThreadId.x, value);
+        });
+        group.GroupMemoryBarrierWithGroupSync();
+
+        for (uint32_t s = REDUCTION_GROUP_SIZE / 2; s > 0; s >>= 1)
+        {
+            group.ForEachThread([&](const ComputeThreadIds& ids)
+            {
+                if (ids.groupThreadId.x < s)
+                {
+                    sharedData.Store(ids.groupThreadId.x, std::max(sharedData.Load(ids.groupThreadId.x), sharedData.Load(ids.groupThreadId.x + s)));
+                }
+            });
+            group.GroupMemoryBarrierWithGroupSync();
+        }
+
+        group.ForEachThread([&](const ComputeThreadIds& ids)
+        {
+            if (ids.groupThreadId.x == 0)
+            {
+                output->Store(ids.groupId.x, sharedData.Load(0));
+            }
+        });
+    };
+}
+
+uint32_t EmulateGpuReduction(const ComputeEmulator& emulator, const std::vector<uint8_t>& textureBytes, uint32_t width, uint32_t height, uint32_t threadGroupSize, EmulatorDispatchStats* stats)
+{
+    if (threadGroupSize == 0 || textureBytes.size() < static_cast<size_t>(width) * height)
+    {
+        throw std::runtime_error("Invalid arguments for emulated reduction");
+    }
+
+    const ReductionLayout layout = MakeReductionLayout(width, height, threadGroupSize);
+    EmuTexture2D<uint8_t> inputTexture(textureBytes.data(), width, height, width);
+    auto intermediateBuffer = std::make_unique<EmuRWStructuredBuffer<uint32_t>>(layout.partialCount);
+
+    EmulatorDispatchStats total = emulator.Dispatch(MakeMaxReductionKernel(threadGroupSize, layout.constants, inputTexture, *intermediateBuffer), { threadGroupSize, threadGroupSize, 1 },
+        layout.constants.groupsX, layout.constants.groupsY, 1);
+
+    for (uint32_t passSize : GetBufferReductionPassSizes(intermediateBuffer->Size()))
+    {
+        auto passOutput = std::make_unique<EmuRWStructuredBuffer<uint32_t>>(passSize);
+        EmulatorDispatchStats pass = emulator.Dispatch(MakeBufferMaxReductionKernel(*intermediateBuffer, *passOutput), { BufferReductionGroupSize, 1, 1 }, passSize, 1, 1);
+        total.groupCount += pass.groupCount;
+        total.threadInvocations += pass.threadInvocations;
+        total.barriers += pass.barriers;
+        total.sharedLoads += pass.sharedLoads;
+        total.sharedStores += pass.sharedStores;
+        total.sharedBytes = std::max(total.sharedBytes, pass.sharedBytes);
+        total.deviceAtomics += pass.deviceAtomics;
+        total.atomicRetries += pass.atomicRetries;
+        total.elapsedMs += pass.elapsedMs;
+        intermediateBuffer = std::move(passOutput);
+    }
+    if (stats)
+    {
+        *stats = total;
+    }
+
+    // The 4 bytes ReductionContext reads back, an empty intermediate buffer reads as 0
+    return intermediateBuffer->Load(0);
+}
+
+ComputeKernel MakeAtomicMaxReductionKernel(uint32_t threadGroupSize, const EmuTexture2D<uint8_t>& inputTexture, EmuRWStructuredBuffer<uint32_t>& outputBuffer)
+{
+    const uint32_t THREAD_COUNT = threadGroupSize * threadGroupSize;
+    const EmuTexture2D<uint8_t>* input = &inputTexture;
+    EmuRWStructuredBuffer<uint32_t>* output = &outputBuffer;
+
+    return [THREAD_COUNT, input, output](ComputeGroup& group)
+    {
+        GroupSharedArray<uint32_t> sharedData = group.AllocateShared<uint32_t>(THREAD_COUNT);
+
+        group.ForEachThread([&](const ComputeThreadIds& ids)
+        {
+            sharedData.Store(ids.groupIndex, input->Load(ids.dispatchThreadId.x, ids.dispatchThreadId.y));
+        });
+        group.GroupMemoryBarrierWithGroupSync();
+
+        for (uint32_t stride = THREAD_COUNT / 2; stride > 0; stride >>= 1)
+        {
+            group.ForEachThread([&](const ComputeThreadIds& ids)
+            {
+                if (ids.groupIndex < stride)
+                {
+                    sharedData.Store(ids.groupIndex, std::max(sharedData.Load(ids.groupIndex), sharedData.Load(ids.groupIndex + stride)));
+                }
+            });
+            group.GroupMemoryBarrierWithGroupSync();
+        }
+
+        group.ForEachThread([&](const ComputeThreadIds& ids)
+        {
+            if (ids.groupIndex == 0)
+            {
+                InterlockedMax(group, *output, 0, sharedData.Load(0));
+            }
+        });
+    };
+}
+
+uint32_t EmulateAtomicMaxReduction(const ComputeEmulator& emulator, const std::vector<uint8_t>& textureBytes, uint32_t width, uint32_t height, uint32_t threadGroupSize, EmulatorDispatchStats* stats)
+{
+    if (threadGroupSize == 0 || textureBytes.size() < static_cast<size_t>(width) * height)
+    {
+        throw std::runtime_error("Invalid arguments for emulated reduction");
+    }
+
+    EmuTexture2D<uint8_t> inputTexture(textureBytes.data(), width, height, width);
+    EmuRWStructuredBuffer<uint32_t> outputBuffer(1);
+
+    const ReductionLayout layout = MakeReductionLayout(width, height, threadGroupSize);
+    EmulatorDispatchStats dispatchStats = emulator.Dispatch(MakeAtomicMaxReductionKernel(threadGroupSize, inputTexture, outputBuffer), { threadGroupSize, threadGroupSize, 1 },
+        layout.constants.groupsX, layout.constants.groupsY, 1);
+    if (stats)
+    {
+        *stats = dispatchStats;
+    }
+
+    return outputBuffer.Load(0);
+}
+
+SharedMemoryProfile ProfileMaxReductionKernel(const ComputeEmulator& emulator, uint32_t threadGroupSize, uint32_t width, uint32_t height, const SharedMemoryBankConfig& config)
+{
+    if (threadGroupSize == 0)
+    {
+        throw std::runtime_error("Thread group size must be non-zero");
+    }
+
+    const ReductionLayout layout = MakeReductionLayout(width, height, threadGroupSize);
+    std::vector<uint8_t> textureBytes(static_cast<size_t>(width) * height);
+    EmuTexture2D<uint8_t> inputTexture(textureBytes.data(), width, height, width);
+    EmuRWStructuredBuffer<uint32_t> intermediateBuffer(layout.partialCount);
+
+    SharedMemoryProfile profile;
+    profile.config = config;
+    emulator.Dispatch(MakeMaxReductionKernel(threadGroupSize, layout.constants, inputTexture, intermediateBuffer), { threadGroupSize, threadGroupSize, 1 },
+        layout.constants.groupsX, layout.constants.groupsY, 1, &profile);
+    return profile;
+}
+
+SharedMemoryProfile ProfileLegacyMaxReductionKernel(const ComputeEmulator& emulator, uint32_t threadGroupSize, uint32_t width, uint32_t height, const SharedMemoryBankConfig& config)
+{
+    if (threadGroupSize == 0)
+    {
+        throw std::runtime_error("Thread group size must be non-zero");
+    }
+
+    const ReductionLayout layout = MakeReductionLayout(width, height, threadGroupSize);
+    std::vector<uint8_t> textureBytes(static_cast<size_t>(width) * height);
+    EmuTexture2D<uint8_t> inputTexture(textureBytes.data(), width, height, width);
+    EmuRWStructuredBuffer<uint32_t> outputBuffer(layout.constants.groupsY * threadGroupSize + layout.constants.groupsX);
+
+    SharedMemoryProfile profile;
+    profile.config = config;
+    emulator.Dispatch(MakeLegacyMaxReductionKernel(threadGroupSize, inputTexture, outputBuffer), { threadGroupSize, threadGroupSize, 1 },
+        layout.constants.groupsX, layout.constants.groupsY, 1, &profile);
+    return profile;
+}
+
+SharedMemoryProfile ProfileRowMaxReductionKernel(const ComputeEmulator& emulator, uint32_t width, uint32_t height, const SharedMemoryBankConfig& config)
+{
+    const uint32_t groupsX = (width + 15) / 16;
+    const uint32_t groupsY = (height + 15) / 16;
+    std::vector<uint8_t> textureBytes(static_cast<size_t>(width) * height);
+    EmuTexture2D<uint8_t> inputTexture(textureBytes.data(), width, height, width);
+    EmuRWStructuredBuffer<float> outputBuffer(groupsY * 16 + groupsX);
+
+    SharedMemoryProfile profile;
+    profile.config = config;
+    emulator.Dispatch(MakeRowMaxReductionKernel(inputTexture, outputBuffer), { 16, 16, 1 }, groupsX, groupsY, 1, &profile);
+    return profile;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "ComputeEmulator.h"
+#include "ReductionLayout.h"
+#include <cstdint>
+#include <vector>
+
+// C++ ports of the HLSL reduction kernels for the ComputeEmulator.
+// They follow the shader source line by line, including its groupshared access pattern, so their
+// output and the SharedMemoryProfiler numbers match the compiled shader permutations.
+
+// CompuetShader.hlsl compiled with THREAD_GROUP_SIZE = threadGroupSize (R8_UINT view of the texture),
+// constants are the root constants of the dispatch (MakeReductionLayout). Every group writes the max
+// of its whole tile.
+ComputeKernel MakeMaxReductionKernel(uint32_t threadGroupSize, const ReductionConstants& constants, const EmuTexture2D<uint8_t>& inputTexture, EmuRWStructuredBuffer<uint32_t>& outputBuffer);
+
+// The original CompuetShader.hlsl, kept as a profiled variant: float groupshared values, a reduction over
+// GTid.x only (every group ends with the max of its first tile row) and the GID.y * THREAD_GROUP_SIZE + GID.x
+// output index, so outputBuffer needs groupsY * threadGroupSize + groupsX elements
+ComputeKernel MakeLegacyMaxReductionKernel(uint32_t threadGroupSize, const EmuTexture2D<uint8_t>& inputTexture, EmuRWStructuredBuffer<uint32_t>& outputBuffer);
+
+// ComputeShader_groupshared_mem.hlsl, 16x16 groups reducing each row (R8_UNORM view of the texture)
+ComputeKernel MakeRowMaxReductionKernel(const EmuTexture2D<uint8_t>& inputTexture, EmuRWStructuredBuffer<float>& outputBuffer);
+
+// Emulated ComputeShader_groupshared_mem.hlsl dispatch, returns outputBuffer. The shader indexes it with
+// GID.y * 16 + GID.x, so there is one element per group only for 256 texel wide textures, and the 16 row
+// maxima of a group race for that element (in the emulator the last row of the group wins).
+std::vector<float> EmulateRowMaxReduction(const ComputeEmulator& emulator, const std::vector<uint8_t>& textureBytes, uint32_t width, uint32_t height, EmulatorDispatchStats* stats = nullptr);
+
+// Emulated ReadBackR8UNormValues: same intermediate buffer size, dispatch size and final std::max_element
+uint32_t EmulateReadBackR8UNormValues(const ComputeEmulator& emulator, const std::vector<uint8_t>& textureBytes, uint32_t width, uint32_t height, uint32_t threadGroupSize, EmulatorDispatchStats* stats = nullptr);
+
+// BufferReduction.hlsl, one group reduces BufferReductionElementsPerGroup elements of inputBuffer
+ComputeKernel MakeBufferMaxReductionKernel(const EmuRWStructuredBuffer<uint32_t>& inputBuffer, EmuRWStructuredBuffer<uint32_t>& outputBuffer);
+
+// Emulated full GPU reduction of ReductionContext: the CompuetShader.hlsl pass followed by
+// BufferReduction.hlsl passes until one value is left. stats receives the totals of all passes.
+uint32_t EmulateGpuReduction(const ComputeEmulator& emulator, const std::vector<uint8_t>& textureBytes, uint32_t width, uint32_t height, uint32_t threadGroupSize, EmulatorDispatchStats* stats = nullptr);
+
+// AtomicMaxReduction.hlsl compiled with THREAD_GROUP_SIZE = threadGroupSize, outputBuffer[0] receives the max of all groups
+ComputeKernel MakeAtomicMaxReductionKernel(uint32_t threadGroupSize, const EmuTexture2D<uint8_t>& inputTexture, EmuRWStructuredBuffer<uint32_t>& outputBuffer);
+
+// Emulated ReductionStrategy::AtomicMax run: one cleared UINT, one dispatch, 4 bytes read back.
+// stats.deviceAtomics / atomicRetries give the contention on the single output element.
+uint32_t EmulateAtomicMaxReduction(const ComputeEmulator& emulator, const std::vector<uint8_t>& textureBytes, uint32_t width, uint32_t height, uint32_t threadGroupSize, EmulatorDispatchStats* stats = nullptr);
+
+// Groupshared traffic of the CompuetShader.hlsl variant for a width x height dispatch.
+// The access pattern does not depend on texel values so the texture is left zeroed.
+SharedMemoryProfile ProfileMaxReductionKernel(const ComputeEmulator& emulator, uint32_t threadGroupSize, uint32_t width, uint32_t height, const SharedMemoryBankConfig& config);
+
+// Groupshared traffic of the original CompuetShader.hlsl (MakeLegacyMaxReductionKernel), same dispatch as above
+SharedMemoryProfile ProfileLegacyMaxReductionKernel(const ComputeEmulator& emulator, uint32_t threadGroupSize, uint32_t width, uint32_t height, const SharedMemoryBankConfig& config);
+
+// Groupshared traffic of ComputeShader_groupshared_mem.hlsl for a width x height dispatch
+SharedMemoryProfile ProfileRowMaxReductionKernel(const ComputeEmulator& emulator, uint32_t width, uint32_t height, const SharedMemoryBankConfig& config);
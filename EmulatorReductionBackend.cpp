@@ -0,0 +1,70 @@
+#include "EmulatorReductionBackend.h"
+#include "EmulatedKernels.h"
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+EmulatorReductionBackend::EmulatorReductionBackend(unsigned int workerCount, ReductionStrategy strategy)
+    : m_emulator(workerCount), m_strategy(strategy)
+{
+}
+
+std::string EmulatorReductionBackend::GetDeviceId() const
+{
+    // Emulated timings measure the host, its worker count is what changes them
+    return "emulator-" + std::to_string(m_emulator.GetWorkerCount()) + "t";
+}
+
+void EmulatorReductionBackend::UploadTexture(const uint8_t* texels, uint32_t width, uint32_t height, uint32_t rowPitch)
+{
+    if (texels == nullptr || rowPitch < width)
+    {
+        throw std::runtime_error("Invalid texture data for emulator upload");
+    }
+
+    SetTextureSize(width, height);
+    m_width = width;
+    m_height = height;
+    m_texels.resize(static_cast<size_t>(width) * height);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        std::memcpy(m_texels.data() + static_cast<size_t>(y) * width, texels + static_cast<size_t>(y) * rowPitch, width);
+    }
+}
+
+TextureUploadRegion EmulatorReductionBackend::BeginTextureUpload(uint32_t width, uint32_t height)
+{
+    // The texels are written where Dispatch reads them
+    SetTextureSize(width, height);
+    m_width = width;
+    m_height = height;
+    m_texels.resize(static_cast<size_t>(width) * height);
+
+    TextureUploadRegion region;
+    region.texels = m_texels.data();
+    region.rowPitch = width;
+    return region;
+}
+
+bool EmulatorReductionBackend::GetLastAtomicStats(AtomicReductionStats& stats) const
+{
+    if (m_strategy != ReductionStrategy::AtomicMax)
+    {
+        return false;
+    }
+    stats.deviceAtomics = m_lastStats.deviceAtomics;
+    stats.atomicRetries = m_lastStats.atomicRetries;
+    return true;
+}
+
+void EmulatorReductionBackend::DispatchKernel(uint32_t threadGroupSize)
+{
+    if (m_strategy == ReductionStrategy::AtomicMax)
+    {
+        m_lastMaxValue = EmulateAtomicMaxReduction(m_emulator, m_texels, m_width, m_height, threadGroupSize, &m_lastStats);
+    }
+    else
+    {
+        m_lastMaxValue = EmulateGpuReduction(m_emulator, m_texels, m_width, m_height, threadGroupSize, &m_lastStats);
+    }
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "ReductionBackend.h"
+#include "ComputeEmulator.h"
+#include <vector>
+
+// Runs the CompuetShader.hlsl and BufferReduction.hlsl passes in the ComputeEmulator, the output matches the
+// D3D12 backend, which makes it the reference for shader variants on machines without a GPU. Like the CPU backend
+// every group reduces its whole tile, so all three backends return the true texture max.
+// ReductionStrategy::AtomicMax runs AtomicMaxReduction.hlsl instead.
+class EmulatorReductionBackend : public IReductionBackend
+{
+public:
+    explicit EmulatorReductionBackend(unsigned int workerCount = 0, ReductionStrategy strategy = ReductionStrategy::GroupPartials);
+
+    const char* GetName() const override { return "emulator"; }
+
+    void CreateDevice() override {}
+    void UploadTexture(const uint8_t* texels, uint32_t width, uint32_t height, uint32_t rowPitch) override;
+    TextureUploadRegion BeginTextureUpload(uint32_t width, uint32_t height) override;
+    void EndTextureUpload() override {}
+    uint32_t ReadBack() override { return m_lastMaxValue; }
+    double GetLastDispatchTimeMs() const override { return m_lastStats.elapsedMs; }
+    bool GetLastAtomicStats(AtomicReductionStats& stats) const override;
+    std::string GetDeviceId() const override;
+
+    const EmulatorDispatchStats& GetLastDispatchStats() const { return m_lastStats; }
+
+protected:
+    void DispatchKernel(uint32_t threadGroupSize) override;
+
+private:
+    ComputeEmulator m_emulator;
+    ReductionStrategy m_strategy;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+    std::vector<uint8_t> m_texels;
+    uint32_t m_lastMaxValue = 0;
+    EmulatorDispatchStats m_lastStats;
+};
@@ -0,0 +1,165 @@
+#include "PipelineCache.h"
+#include "HashUtils.h"
+#include "PipelineState.h"
+#include <cwchar>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+PipelineCache::PipelineCache(ID3D12Device* device, const std::wstring& libraryPath)
+    : m_device(device), m_libraryPath(libraryPath)
+{
+    if (!m_libraryPath.empty())
+    {
+        OpenLibrary();
+    }
+}
+
+void PipelineCache::OpenLibrary()
+{
+    ComPtr<ID3D12Device1> device1;
+    if (FAILED(m_device->QueryInterface(IID_PPV_ARGS(&device1))))
+    {
+        // Pipeline libraries need ID3D12Device1, PSOs are still cached for the lifetime of the process
+        return;
+    }
+
+    std::ifstream file(m_libraryPath, std::ios::binary);
+    if (file)
+    {
+        m_libraryData.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    if (!m_libraryData.empty())
+    {
+        // Fails with D3D12_ERROR_ADAPTER_NOT_FOUND, D3D12_ERROR_DRIVER_VERSION_MISMATCH or E_INVALIDARG
+        // for a library from another machine, driver or a truncated file. Start over in that case.
+        HRESULT hr = device1->CreatePipelineLibrary(m_libraryData.data(), m_libraryData.size(), IID_PPV_ARGS(&m_library));
+        if (SUCCEEDED(hr))
+        {
+            return;
+        }
+        m_libraryData.clear();
+        m_libraryDirty = true;
+    }
+
+    if (FAILED(device1->CreatePipelineLibrary(nullptr, 0, IID_PPV_ARGS(&m_library))))
+    {
+        // DXGI_ERROR_UNSUPPORTED on drivers without library support
+        m_library.Reset();
+    }
+}
+
+ID3D12RootSignature* PipelineCache::GetRootSignature(ID3DBlob* serializedRootSignature)
+{
+    const uint8_t* blob = static_cast<const uint8_t*>(serializedRootSignature->GetBufferPointer());
+    const size_t blobSize = serializedRootSignature->GetBufferSize();
+    const uint64_t hash = HashBytes(blob, blobSize);
+
+    if (ComPtr<ID3D12RootSignature>* cached = m_rootSignatures.Find(hash, blob, blobSize))
+    {
+        ++m_stats.rootSignatureHits;
+        return cached->Get();
+    }
+
+    ComPtr<ID3D12RootSignature> rootSignature;
+    HRESULT hr = m_device->CreateRootSignature(0, blob, blobSize, IID_PPV_ARGS(&rootSignature));
+    if (FAILED(hr))
+    {
+        throw std::runtime_error("Failed to create root signature");
+    }
+    ++m_stats.rootSignatureCreates;
+    return m_rootSignatures.Insert(hash, blob, blobSize, rootSignature).Get();
+}
+
+ID3D12PipelineState* PipelineCache::GetComputePipelineState(ID3DBlob* computeShader, ComPtr<ID3D12RootSignature>& rootSignature)
+{
+    return GetComputePipelineState(D3D12_SHADER_BYTECODE{ computeShader->GetBufferPointer(), computeShader->GetBufferSize() }, rootSignature);
+}
+
+ID3D12PipelineState* PipelineCache::GetComputePipelineState(ID3DBlob* serializedRootSignature, ID3DBlob* computeShader, ComPtr<ID3D12RootSignature>& rootSignature)
+{
+    return GetComputePipelineState(serializedRootSignature, D3D12_SHADER_BYTECODE{ computeShader->GetBufferPointer(), computeShader->GetBufferSize() }, rootSignature);
+}
+
+ID3D12PipelineState* PipelineCache::GetComputePipelineState(const D3D12_SHADER_BYTECODE& computeShader, ComPtr<ID3D12RootSignature>& rootSignature)
+{
+    if (!m_defaultRootSignature)
+    {
+        m_defaultRootSignature = SerializeComputeRootSignature();
+    }
+    return GetComputePipelineState(m_defaultRootSignature.Get(), computeShader, rootSignature);
+}
+
+ID3D12PipelineState* PipelineCache::GetComputePipelineState(ID3DBlob* serializedRootSignature, const D3D12_SHADER_BYTECODE& computeShader, ComPtr<ID3D12RootSignature>& rootSignature)
+{
+    rootSignature = GetRootSignature(serializedRootSignature);
+
+    const uint64_t rootSignatureHash = HashBytes(serializedRootSignature->GetBufferPointer(), serializedRootSignature->GetBufferSize());
+    const uint64_t bytecodeHash = HashBytes(computeShader.pShaderBytecode, computeShader.BytecodeLength);
+    const std::pair<uint64_t, uint64_t> key(rootSignatureHash, bytecodeHash);
+
+    // The root signature hash is already collision checked by GetRootSignature, the bytecode is compared here
+    if (ComPtr<ID3D12PipelineState>* cached = m_pipelines.Find(key, computeShader.pShaderBytecode, computeShader.BytecodeLength))
+    {
+        ++m_stats.pipelineHits;
+        return cached->Get();
+    }
+
+    D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
+    psoDesc.pRootSignature = rootSignature.Get();
+    psoDesc.CS = computeShader;
+
+    // Library entries are named after the cache key
+    wchar_t name[64];
+    swprintf(name, _countof(name), L"cs_%016llx_%016llx", static_cast<unsigned long long>(rootSignatureHash), static_cast<unsigned long long>(bytecodeHash));
+
+    ComPtr<ID3D12PipelineState> pipelineState;
+    if (m_library && SUCCEEDED(m_library->LoadComputePipeline(name, &psoDesc, IID_PPV_ARGS(&pipelineState))))
+    {
+        ++m_stats.pipelineLibraryLoads;
+    }
+    else
+    {
+        HRESULT hr = m_device->CreateComputePipelineState(&psoDesc, IID_PPV_ARGS(&pipelineState));
+        if (FAILED(hr))
+        {
+            throw std::runtime_error("Failed to create compute pipeline state");
+        }
+        ++m_stats.pipelineCreates;
+
+        if (m_library && SUCCEEDED(m_library->StorePipeline(name, pipelineState.Get())))
+        {
+            m_libraryDirty = true;
+        }
+    }
+
+    return m_pipelines.Insert(key, computeShader.pShaderBytecode, computeShader.BytecodeLength, pipelineState).Get();
+}
+
+bool PipelineCache::Save()
+{
+    if (!m_library)
+    {
+        return false;
+    }
+    if (!m_libraryDirty)
+    {
+        return true;
+    }
+
+    std::vector<uint8_t> data(m_library->GetSerializedSize());
+    if (FAILED(m_library->Serialize(data.data(), data.size())))
+    {
+        throw std::runtime_error("Failed to serialize pipeline library");
+    }
+
+    std::ofstream file(m_libraryPath, std::ios::binary | std::ios::trunc);
+    if (!file || !file.write(reinterpret_cast<const char*>(data.data()), data.size()))
+    {
+        throw std::runtime_error("Failed to write pipeline library: " + std::string(m_libraryPath.begin(), m_libraryPath.end()));
+    }
+
+    m_libraryDirty = false;
+    return true;
+}
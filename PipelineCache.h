@@ -0,0 +1,63 @@
+#pragma once
+
+#include <d3d12.h>
+#include <wrl.h>
+#include "ContentKeyedCache.h"
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace Microsoft::WRL;
+
+struct PipelineCacheStats
+{
+    uint64_t rootSignatureHits = 0;
+    uint64_t rootSignatureCreates = 0;
+    uint64_t pipelineHits = 0;
+    uint64_t pipelineLibraryLoads = 0;     // PSOs restored from the on-disk library
+    uint64_t pipelineCreates = 0;
+};
+
+// Deduplicates root signatures by the hash of their serialized blob and compute PSOs by
+// (root signature hash, bytecode hash); both keep the hashed bytes to detect hash collisions
+// (see ContentKeyedCache.h). With a library path the PSOs are also kept in an
+// ID3D12PipelineLibrary that is loaded on construction and written back by Save, so a new
+// process skips the driver compile. A library from another adapter or driver is discarded.
+class PipelineCache
+{
+public:
+    explicit PipelineCache(ID3D12Device* device, const std::wstring& libraryPath = std::wstring());
+
+    PipelineCache(const PipelineCache&) = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+
+    ID3D12RootSignature* GetRootSignature(ID3DBlob* serializedRootSignature);
+
+    // Compute PSO for the bytecode with the shared reduction root signature (SerializeComputeRootSignature)
+    ID3D12PipelineState* GetComputePipelineState(ID3DBlob* computeShader, ComPtr<ID3D12RootSignature>& rootSignature);
+    ID3D12PipelineState* GetComputePipelineState(ID3DBlob* serializedRootSignature, ID3DBlob* computeShader, ComPtr<ID3D12RootSignature>& rootSignature);
+
+    // Same for bytecode that is not in a blob, e.g. a ShaderPermutation embedded in the binary
+    ID3D12PipelineState* GetComputePipelineState(const D3D12_SHADER_BYTECODE& computeShader, ComPtr<ID3D12RootSignature>& rootSignature);
+    ID3D12PipelineState* GetComputePipelineState(ID3DBlob* serializedRootSignature, const D3D12_SHADER_BYTECODE& computeShader, ComPtr<ID3D12RootSignature>& rootSignature);
+
+    // Writes the pipeline library if PSOs were added since it was loaded, returns false without a library
+    bool Save();
+
+    const PipelineCacheStats& GetStats() const { return m_stats; }
+
+private:
+    void OpenLibrary();
+
+    ID3D12Device* m_device;
+    std::wstring m_libraryPath;
+    std::vector<uint8_t> m_libraryData;     // must outlive m_library
+    ComPtr<ID3D12PipelineLibrary> m_library;
+    bool m_libraryDirty = false;
+
+    ComPtr<ID3DBlob> m_defaultRootSignature;
+    ContentKeyedCache<uint64_t, ComPtr<ID3D12RootSignature>> m_rootSignatures{ "Root signature" };
+    ContentKeyedCache<std::pair<uint64_t, uint64_t>, ComPtr<ID3D12PipelineState>> m_pipelines{ "Pipeline state" };    // bytecode as content
+    PipelineCacheStats m_stats;
+};
@@ -1,23 +1,26 @@
 #include "PipelineState.h"
+#include "ReductionLayout.h"
+#include "SimdReduction.h"
+#include "TextureData.h"
 #include <stdexcept>
 #include <iostream>
 #include "d3dx12.h"
 #include <vector>
 #include <random>
 #include <algorithm>
-#include <fstream>
-#define MAX_VALUE_FOR_RANDOM    100
+#include <memory>
 
-ComPtr<ID3D12PipelineState> CreateComputePipelineState(ID3D12Device* device, ComPtr<ID3DBlob> computeShader, ComPtr<ID3D12RootSignature>& rootSignature)
+ComPtr<ID3DBlob> SerializeComputeRootSignature()
 {
-    // Create the root signature
     CD3DX12_DESCRIPTOR_RANGE1 ranges[2];
     ranges[0].Init(D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 1, 0);
     ranges[1].Init(D3D12_DESCRIPTOR_RANGE_TYPE_UAV, 1, 0);
 
-    CD3DX12_ROOT_PARAMETER1 rootParameters[2];
+    // SRV table, UAV table and the ReductionConstants at b0
+    CD3DX12_ROOT_PARAMETER1 rootParameters[3];
     rootParameters[0].InitAsDescriptorTable(1, &ranges[0]);
     rootParameters[1].InitAsDescriptorTable(1, &ranges[1]);
+    rootParameters[ReductionConstantsRootParameter].InitAsConstants(ReductionConstantsCount, 0);
 
     CD3DX12_VERSIONED_ROOT_SIGNATURE_DESC rootSignatureDesc;
     rootSignatureDesc.Init_1_1(_countof(rootParameters), rootParameters, 0, nullptr, D3D12_ROOT_SIGNATURE_FLAG_NONE);
@@ -34,7 +37,14 @@ ComPtr<ID3D12PipelineState> CreateComputePipelineState(ID3D12Device* device, Com
         throw std::runtime_error("Failed to serialize root signature");
     }
 
-    hr = device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&rootSignature));
+    return signature;
+}
+
+ComPtr<ID3D12PipelineState> CreateComputePipelineState(ID3D12Device* device, ComPtr<ID3DBlob> computeShader, ComPtr<ID3D12RootSignature>& rootSignature)
+{
+    // Create the root signature
+    ComPtr<ID3DBlob> signature = SerializeComputeRootSignature();
+    HRESULT hr = device->CreateRootSignature(0, signature->GetBufferPointer(), signature->GetBufferSize(), IID_PPV_ARGS(&rootSignature));
     if (FAILED(hr))
     {
         throw std::runtime_error("Failed to create root signature");
@@ -57,6 +67,26 @@ ComPtr<ID3D12PipelineState> CreateComputePipelineState(ID3D12Device* device, Com
 
 UINT ReadBackR8UNormValues(ID3D12Device* device, ID3D12CommandQueue* commandQueue, ID3D12GraphicsCommandList* commandList, ID3D12CommandAllocator* commandAllocator, ID3D12PipelineState* pipelineState, ID3D12RootSignature* rootSignature, UINT width, UINT height, UINT threadGroupSize)
 {
+    // Initialize texture with random data, use the --capture option of main to keep the inputs
+    std::vector<uint8_t> textureBytes = GenerateRandomTextureData(width, height);
+
+    double gpuTimeMs = 0.0;
+    UINT maxValue = ReadBackR8UNormValues(device, commandQueue, commandList, commandAllocator, pipelineState, rootSignature, textureBytes, width, height, threadGroupSize, &gpuTimeMs);
+
+    std::cout << "GPU Time: " << gpuTimeMs << " ms" << std::endl;
+
+    return maxValue;
+}
+
+UINT ReadBackR8UNormValues(ID3D12Device* device, ID3D12CommandQueue* commandQueue, ID3D12GraphicsCommandList* commandList, ID3D12CommandAllocator* commandAllocator, ID3D12PipelineState* pipelineState, ID3D12RootSignature* rootSignature, const std::vector<uint8_t>& textureBytes, UINT width, UINT height, UINT threadGroupSize, double* gpuTimeMs,
+    DescriptorHeap* descriptors)
+{
+    if (threadGroupSize == 0 || textureBytes.size() < static_cast<size_t>(width) * height)
+    {
+        throw std::runtime_error("Texture data is smaller than width x height");
+    }
+    const ReductionLayout layout = MakeReductionLayout(width, height, threadGroupSize);
+
     // Reset command allocator and list
     commandAllocator->Reset();
     commandList->Reset(commandAllocator, pipelineState);
@@ -85,30 +115,6 @@ UINT ReadBackR8UNormValues(ID3D12Device* device, ID3D12CommandQueue* commandQueu
     ComPtr<ID3D12Resource> uploadBuffer;
     device->CreateCommittedResource(&uploadHeapProperties, D3D12_HEAP_FLAG_NONE, &uploadBufferDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&uploadBuffer));
 
-    // Initialize texture with random data
-
-    std::vector<uint8_t> textureBytes(width * height);
-    std::generate(textureBytes.begin(), textureBytes.end(), []() { return static_cast<uint8_t>(rand() % MAX_VALUE_FOR_RANDOM); });
-
-    // Write texture data to a text file
-    std::ofstream outFile("textureData.txt");
-    if (outFile.is_open())
-    {
-        for (size_t i = 0; i < textureBytes.size(); ++i)
-        {
-            outFile << static_cast<int>(textureBytes[i]) << " ";
-            if ((i + 1) % width == 0)
-            {
-                outFile << "\n";
-            }
-        }
-        outFile.close();
-    }
-    else
-    {
-        throw std::runtime_error("Failed to open textureData.txt for writing");
-    }
-
     D3D12_SUBRESOURCE_DATA textureData = {};
     textureData.pData = textureBytes.data();
     textureData.RowPitch = width;
@@ -120,23 +126,29 @@ UINT ReadBackR8UNormValues(ID3D12Device* device, ID3D12CommandQueue* commandQueu
     commandList->ResourceBarrier(1, &barrier);
 
     // Create intermediate buffer
-    D3D12_RESOURCE_DESC intermediateBufferDesc = CD3DX12_RESOURCE_DESC::Buffer((width / threadGroupSize) * (height / threadGroupSize) * sizeof(UINT), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
+    D3D12_RESOURCE_DESC intermediateBufferDesc = CD3DX12_RESOURCE_DESC::Buffer(layout.partialCount * sizeof(UINT), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS);
     ComPtr<ID3D12Resource> intermediateBuffer;
     device->CreateCommittedResource(&defaultHeapProperties, D3D12_HEAP_FLAG_NONE, &intermediateBufferDesc, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, nullptr, IID_PPV_ARGS(&intermediateBuffer));
 
     // Create readback buffer
     CD3DX12_HEAP_PROPERTIES readbackHeapProperties(D3D12_HEAP_TYPE_READBACK);
-    D3D12_RESOURCE_DESC readbackBufferDesc = CD3DX12_RESOURCE_DESC::Buffer((width / threadGroupSize) * (height / threadGroupSize) * sizeof(UINT));
+    D3D12_RESOURCE_DESC readbackBufferDesc = CD3DX12_RESOURCE_DESC::Buffer(layout.partialCount * sizeof(UINT));
     ComPtr<ID3D12Resource> readbackBuffer;
     device->CreateCommittedResource(&readbackHeapProperties, D3D12_HEAP_FLAG_NONE, &readbackBufferDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, IID_PPV_ARGS(&readbackBuffer));
 
-    // Create descriptor heap
-    D3D12_DESCRIPTOR_HEAP_DESC heapDesc = {};
-    heapDesc.NumDescriptors = 2;
-    heapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
-    heapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
-    ComPtr<ID3D12DescriptorHeap> descriptorHeap;
-    device->CreateDescriptorHeap(&heapDesc, IID_PPV_ARGS(&descriptorHeap));
+    // SRV + UAV table, transient in the caller's heap or in a heap for this call only
+    std::unique_ptr<DescriptorHeap> callDescriptors;
+    DescriptorRange table;
+    if (descriptors != nullptr)
+    {
+        table = descriptors->AllocateTransient(2);
+    }
+    else
+    {
+        callDescriptors = std::make_unique<DescriptorHeap>(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, 2, 0, true);
+        descriptors = callDescriptors.get();
+        table = descriptors->AllocatePersistent(2);
+    }
 
     // Create SRV for input texture
     D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
@@ -145,27 +157,25 @@ UINT ReadBackR8UNormValues(ID3D12Device* device, ID3D12CommandQueue* commandQueu
     srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
     srvDesc.Texture2D.MostDetailedMip = 0;
     srvDesc.Texture2D.MipLevels = 1;
-    device->CreateShaderResourceView(inputTexture.Get(), &srvDesc, descriptorHeap->GetCPUDescriptorHandleForHeapStart());
+    device->CreateShaderResourceView(inputTexture.Get(), &srvDesc, descriptors->GetCpuHandle(table.offset));
 
     // Create UAV for intermediate buffer
     D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
     uavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
-    uavDesc.Buffer.NumElements = (width / threadGroupSize) * (height / threadGroupSize);
+    uavDesc.Buffer.NumElements = layout.partialCount;
     uavDesc.Buffer.StructureByteStride = sizeof(UINT);
-    CD3DX12_CPU_DESCRIPTOR_HANDLE uavHandle(descriptorHeap->GetCPUDescriptorHandleForHeapStart(), 1, device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV));
-    device->CreateUnorderedAccessView(intermediateBuffer.Get(), nullptr, &uavDesc, uavHandle);
+    device->CreateUnorderedAccessView(intermediateBuffer.Get(), nullptr, &uavDesc, descriptors->GetCpuHandle(table.offset + 1));
 
     // Set pipeline state and root signature
     commandList->SetPipelineState(pipelineState);
     commandList->SetComputeRootSignature(rootSignature);
-    ID3D12DescriptorHeap* heaps[] = { descriptorHeap.Get() };
+    ID3D12DescriptorHeap* heaps[] = { descriptors->Get() };
     commandList->SetDescriptorHeaps(_countof(heaps), heaps);
 
     // Set SRV and UAV descriptor tables
-    CD3DX12_GPU_DESCRIPTOR_HANDLE srvHandle(descriptorHeap->GetGPUDescriptorHandleForHeapStart());
-    CD3DX12_GPU_DESCRIPTOR_HANDLE uavHandleGpu(descriptorHeap->GetGPUDescriptorHandleForHeapStart(), 1, device->GetDescriptorHandleIncrementSize(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV));
-    commandList->SetComputeRootDescriptorTable(0, srvHandle);
-    commandList->SetComputeRootDescriptorTable(1, uavHandleGpu);
+    commandList->SetComputeRootDescriptorTable(0, descriptors->GetGpuHandle(table.offset));
+    commandList->SetComputeRootDescriptorTable(1, descriptors->GetGpuHandle(table.offset + 1));
+    commandList->SetComputeRoot32BitConstants(ReductionConstantsRootParameter, ReductionConstantsCount, &layout.constants, 0);
 
     // Create query heap for timestamp queries
     D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
@@ -183,7 +193,7 @@ UINT ReadBackR8UNormValues(ID3D12Device* device, ID3D12CommandQueue* commandQueu
     commandList->EndQuery(queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 0);
 
     // Dispatch compute shader
-    commandList->Dispatch((width + (threadGroupSize - 1)) / threadGroupSize, (height + (threadGroupSize-1)) / threadGroupSize, 1);
+    commandList->Dispatch(layout.constants.groupsX, layout.constants.groupsY, 1);
 
     // Record end timestamp
     commandList->EndQuery(queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 1);
@@ -205,6 +215,7 @@ UINT ReadBackR8UNormValues(ID3D12Device* device, ID3D12CommandQueue* commandQueu
     // Execute command list
     ID3D12CommandList* commandLists[] = { commandList };
     commandQueue->ExecuteCommandLists(_countof(commandLists), commandLists);
+    descriptors->RetireTransient(commandQueue);
 
     // Wait for GPU to finish
     ComPtr<ID3D12Fence> fence;
@@ -224,7 +235,7 @@ UINT ReadBackR8UNormValues(ID3D12Device* device, ID3D12CommandQueue* commandQueu
     void* mappedData;
     readbackBuffer->Map(0, nullptr, &mappedData);
     UINT* data = static_cast<UINT*>(mappedData);
-    UINT maxValue = *std::max_element(data, data + (width / threadGroupSize) * (height / threadGroupSize));
+    UINT maxValue = ReduceMax(data, layout.partialCount);
     readbackBuffer->Unmap(0, nullptr);
 
     // Map timestamp buffer and calculate GPU time
@@ -238,9 +249,10 @@ UINT ReadBackR8UNormValues(ID3D12Device* device, ID3D12CommandQueue* commandQueu
     commandQueue->GetTimestampFrequency(&frequency);
 
     // Calculate GPU time in milliseconds
-    double gpuTimeMs = (gpuTime * 1000.0) / frequency;
+    if (gpuTimeMs)
+    {
+        *gpuTimeMs = (gpuTime * 1000.0) / frequency;
+    }
 
-    std::cout << "GPU Time: " << gpuTimeMs << " ms" << std::endl;
-        
-    return maxValue; ;
+    return maxValue;
 }
\ No newline at end of file
@@ -1,10 +1,22 @@
 #pragma once
 
+#include "DescriptorHeap.h"
 #include <d3d12.h>
 #include <wrl.h>
+#include <cstdint>
+#include <vector>
 
 using namespace Microsoft::WRL;
 
+// Serialized root signature shared by every reduction shader: SRV table (t0), UAV table (u0) and the
+// ReductionConstants root constants (b0) as parameter ReductionConstantsRootParameter
+ComPtr<ID3DBlob> SerializeComputeRootSignature();
+
 ComPtr<ID3D12PipelineState> CreateComputePipelineState(ID3D12Device* device, ComPtr<ID3DBlob> computeShader, ComPtr<ID3D12RootSignature>& rootSignature);
 
-UINT ReadBackR8UNormValues(ID3D12Device* device, ID3D12CommandQueue* commandQueue, ID3D12GraphicsCommandList* commandList, ID3D12CommandAllocator* commandAllocator, ID3D12PipelineState* pipelineState, ID3D12RootSignature* rootSignature, UINT width, UINT height, UINT threadGroupSize);
\ No newline at end of file
+UINT ReadBackR8UNormValues(ID3D12Device* device, ID3D12CommandQueue* commandQueue, ID3D12GraphicsCommandList* commandList, ID3D12CommandAllocator* commandAllocator, ID3D12PipelineState* pipelineState, ID3D12RootSignature* rootSignature, UINT width, UINT height, UINT threadGroupSize);
+
+// Same as above but reduces caller provided R8 texels (tightly packed, width bytes per row) and reports the GPU time instead of printing it.
+// The SRV/UAV table comes from the ring of descriptors (e.g. ReductionContext::GetDescriptorHeap()), without one a heap is created for the call.
+UINT ReadBackR8UNormValues(ID3D12Device* device, ID3D12CommandQueue* commandQueue, ID3D12GraphicsCommandList* commandList, ID3D12CommandAllocator* commandAllocator, ID3D12PipelineState* pipelineState, ID3D12RootSignature* rootSignature, const std::vector<uint8_t>& textureBytes, UINT width, UINT height, UINT threadGroupSize, double* gpuTimeMs = nullptr,
+    DescriptorHeap* descriptors = nullptr);
\ No newline at end of file
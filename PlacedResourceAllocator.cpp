@@ -0,0 +1,92 @@
+#include "PlacedResourceAllocator.h"
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+PlacedResource::PlacedResource(PlacedResource&& other) noexcept
+    : m_allocator(other.m_allocator), m_allocation(other.m_allocation), m_resource(std::move(other.m_resource))
+{
+    other.m_allocator = nullptr;
+}
+
+PlacedResource& PlacedResource::operator=(PlacedResource&& other) noexcept
+{
+    if (this != &other)
+    {
+        Reset();
+        m_allocator = other.m_allocator;
+        m_allocation = other.m_allocation;
+        m_resource = std::move(other.m_resource);
+        other.m_allocator = nullptr;
+    }
+    return *this;
+}
+
+void PlacedResource::Reset()
+{
+    // The resource has to be gone before its range can be handed out again
+    m_resource.Reset();
+    if (m_allocator != nullptr)
+    {
+        m_allocator->Free(m_allocation);
+        m_allocator = nullptr;
+    }
+}
+
+PlacedResourceAllocator::PlacedResourceAllocator(ID3D12Device* device, D3D12_HEAP_TYPE heapType, D3D12_HEAP_FLAGS heapFlags, uint64_t heapSize)
+    : m_device(device), m_heapType(heapType), m_heapFlags(heapFlags),
+      m_pool(heapSize, (heapFlags & D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS) ? D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT : D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT)
+{
+}
+
+PlacedResource PlacedResourceAllocator::CreateResource(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState, const char* name)
+{
+    // Small textures may use 4 KB placement, the runtime reports the default alignment when they cannot
+    D3D12_RESOURCE_DESC placedDesc = desc;
+    D3D12_RESOURCE_ALLOCATION_INFO info = {};
+    if (placedDesc.Dimension != D3D12_RESOURCE_DIMENSION_BUFFER && placedDesc.Alignment == 0)
+    {
+        placedDesc.Alignment = D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT;
+        info = m_device->GetResourceAllocationInfo(0, 1, &placedDesc);
+        if (info.Alignment != D3D12_SMALL_RESOURCE_PLACEMENT_ALIGNMENT)
+        {
+            placedDesc.Alignment = 0;
+        }
+    }
+    if (placedDesc.Alignment == 0)
+    {
+        info = m_device->GetResourceAllocationInfo(0, 1, &placedDesc);
+    }
+    if (info.SizeInBytes == UINT64_MAX)
+    {
+        throw std::runtime_error(std::string("Invalid resource description for ") + name);
+    }
+
+    bool newHeap = false;
+    const HeapAllocation allocation = m_pool.Allocate(info.SizeInBytes, info.Alignment, &newHeap);
+    if (newHeap)
+    {
+        D3D12_HEAP_DESC heapDesc = {};
+        heapDesc.SizeInBytes = m_pool.GetHeapSize(allocation.heapIndex);
+        heapDesc.Properties.Type = m_heapType;
+        heapDesc.Alignment = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+        heapDesc.Flags = m_heapFlags;
+        ComPtr<ID3D12Heap> heap;
+        if (FAILED(m_device->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap))))
+        {
+            m_pool.Free(allocation);
+            m_pool.RemoveEmptyLastHeap();
+            throw std::runtime_error(std::string("Failed to create a heap for ") + name);
+        }
+        m_heaps.push_back(heap);
+    }
+
+    ComPtr<ID3D12Resource> resource;
+    HRESULT hr = m_device->CreatePlacedResource(m_heaps[allocation.heapIndex].Get(), allocation.offset, &placedDesc, initialState, nullptr, IID_PPV_ARGS(&resource));
+    if (FAILED(hr))
+    {
+        m_pool.Free(allocation);
+        throw std::runtime_error(std::string("Failed to create ") + name);
+    }
+    return PlacedResource(this, allocation, std::move(resource));
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "BuddyAllocator.h"
+#include <d3d12.h>
+#include <wrl.h>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+using namespace Microsoft::WRL;
+
+class PlacedResourceAllocator;
+
+// Placed resource and the heap range it occupies, the range is returned when the resource is released.
+// Move only, so it can live in the values of an LruResourceCache; Get() mirrors ComPtr.
+class PlacedResource
+{
+public:
+    PlacedResource() = default;
+    PlacedResource(PlacedResourceAllocator* allocator, const HeapAllocation& allocation, ComPtr<ID3D12Resource> resource)
+        : m_allocator(allocator), m_allocation(allocation), m_resource(std::move(resource))
+    {
+    }
+    ~PlacedResource() { Reset(); }
+
+    PlacedResource(PlacedResource&& other) noexcept;
+    PlacedResource& operator=(PlacedResource&& other) noexcept;
+
+    void Reset();
+
+    ID3D12Resource* Get() const { return m_resource.Get(); }
+    ID3D12Resource* operator->() const { return m_resource.Get(); }
+    const HeapAllocation& GetAllocation() const { return m_allocation; }
+
+private:
+    PlacedResourceAllocator* m_allocator = nullptr;
+    HeapAllocation m_allocation;
+    ComPtr<ID3D12Resource> m_resource;
+};
+
+// Places resources in large ID3D12Heaps instead of one implicit heap per CreateCommittedResource.
+// The heap ranges come from a HeapPool of buddy allocators. Textures that qualify get the 4 KB small
+// resource placement alignment, everything else the default 64 KB. With resource heap tier 1 buffers
+// and textures cannot share a heap, so heapFlags should be D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS or
+// D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES and each kind gets its own allocator.
+class PlacedResourceAllocator
+{
+public:
+    PlacedResourceAllocator(ID3D12Device* device, D3D12_HEAP_TYPE heapType, D3D12_HEAP_FLAGS heapFlags, uint64_t heapSize);
+
+    PlacedResourceAllocator(const PlacedResourceAllocator&) = delete;
+    PlacedResourceAllocator& operator=(const PlacedResourceAllocator&) = delete;
+
+    PlacedResource CreateResource(const D3D12_RESOURCE_DESC& desc, D3D12_RESOURCE_STATES initialState, const char* name);
+    void Free(const HeapAllocation& allocation) { m_pool.Free(allocation); }
+
+    HeapPoolStats GetStats() const { return m_pool.GetStats(); }
+
+private:
+    ID3D12Device* m_device;
+    D3D12_HEAP_TYPE m_heapType;
+    D3D12_HEAP_FLAGS m_heapFlags;
+    HeapPool m_pool;
+    std::vector<ComPtr<ID3D12Heap>> m_heaps;    // indexed like the pool's heaps
+};
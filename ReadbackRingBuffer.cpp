@@ -0,0 +1,29 @@
+#include "ReadbackRingBuffer.h"
+#include "d3dx12.h"
+#include <stdexcept>
+
+ReadbackRingBuffer::ReadbackRingBuffer(PlacedResourceAllocator& allocator, uint64_t capacity)
+    : m_ring(capacity)
+{
+    m_buffer = allocator.CreateResource(CD3DX12_RESOURCE_DESC::Buffer(capacity), D3D12_RESOURCE_STATE_COPY_DEST, "readback ring");
+
+    // Readback heap resources may stay mapped, the data of a region is only read after its fence
+    void* mapped = nullptr;
+    if (FAILED(m_buffer->Map(0, nullptr, &mapped)))
+    {
+        throw std::runtime_error("Failed to map readback ring");
+    }
+    m_mapped = static_cast<const uint8_t*>(mapped);
+}
+
+ReadbackRegion ReadbackRingBuffer::Allocate(uint64_t size, uint64_t alignment)
+{
+    ReadbackRegion region;
+    region.offset = m_ring.Allocate(size, alignment);
+    if (region.IsValid())
+    {
+        region.data = m_mapped + region.offset;
+        region.buffer = m_buffer.Get();
+    }
+    return region;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "PlacedResourceAllocator.h"
+#include "RingBufferAllocator.h"
+#include <d3d12.h>
+#include <wrl.h>
+#include <cstdint>
+
+using namespace Microsoft::WRL;
+
+// Destination of a copy the CPU reads once the submission that wrote it has completed
+struct ReadbackRegion
+{
+    const uint8_t* data = nullptr;          // mapped memory at offset
+    ID3D12Resource* buffer = nullptr;
+    uint64_t offset = InvalidRingOffset;
+
+    bool IsValid() const { return offset != InvalidRingOffset; }
+};
+
+// One readback heap buffer that stays mapped for its whole lifetime and is split into a region per
+// submission, instead of a Map/Unmap of per-size buffers after every wait. Unlike UploadRingBuffer the
+// ring has no fence of its own: a region may only be reused once its data has been read, so the owner
+// retires regions with the fence value of their submission and releases them after delivering the results.
+class ReadbackRingBuffer
+{
+public:
+    ReadbackRingBuffer(PlacedResourceAllocator& allocator, uint64_t capacity);
+
+    ReadbackRingBuffer(const ReadbackRingBuffer&) = delete;
+    ReadbackRingBuffer& operator=(const ReadbackRingBuffer&) = delete;
+
+    // Invalid region while the ring is full, the owner delivers older results and releases them first
+    ReadbackRegion Allocate(uint64_t size, uint64_t alignment);
+    void Retire(uint64_t fenceValue) { m_ring.Retire(fenceValue); }
+    // Regions retired up to deliveredFenceValue have been read
+    void Release(uint64_t deliveredFenceValue) { m_ring.Release(deliveredFenceValue); }
+
+    uint64_t GetCapacity() const { return m_ring.GetCapacity(); }
+    uint64_t GetUsedBytes() const { return m_ring.GetUsedBytes(); }
+
+private:
+    PlacedResource m_buffer;
+    const uint8_t* m_mapped = nullptr;
+    RingBufferAllocator m_ring;
+};
@@ -0,0 +1,162 @@
+#include "ReductionBackend.h"
+#include "Autotuner.h"
+#include <stdexcept>
+#include <string>
+
+std::vector<TuningVariant> IReductionBackend::GetTuningVariants() const
+{
+    // The thread group sizes the shaders are compiled for
+    std::vector<TuningVariant> variants;
+    for (uint32_t threadGroupSize : { 8u, 16u, 32u })
+    {
+        TuningVariant variant;
+        variant.threadGroupSize = threadGroupSize;
+        variants.push_back(variant);
+    }
+    return variants;
+}
+
+void IReductionBackend::Dispatch(uint32_t threadGroupSize)
+{
+    TuningVariant variant;
+    if (!m_tuning && SelectTuning(variant))
+    {
+        threadGroupSize = variant.threadGroupSize;
+    }
+    DispatchKernel(threadGroupSize);
+}
+
+uint64_t IReductionBackend::Submit(uint32_t threadGroupSize)
+{
+    TuningVariant variant;
+    if (!m_tuning && SelectTuning(variant))
+    {
+        threadGroupSize = variant.threadGroupSize;
+    }
+    return SubmitKernel(threadGroupSize);
+}
+
+void IReductionBackend::SetAutotuner(ReductionAutotuner* autotuner, const TuningKey& key)
+{
+    m_autotuner = autotuner;
+    m_tuningKey = key;
+    m_tunedVariantValid = false;
+}
+
+bool IReductionBackend::SelectTuning(TuningVariant& variant, bool* tuned)
+{
+    if (tuned)
+    {
+        *tuned = false;
+    }
+    if (m_autotuner == nullptr || m_textureWidth == 0 || m_textureHeight == 0)
+    {
+        return false;
+    }
+
+    // The variant of the previous size stays applied until another size comes along
+    if (!m_tunedVariantValid || m_tuningKey.width != m_textureWidth || m_tuningKey.height != m_textureHeight)
+    {
+        if (m_tuningKey.deviceId.empty())
+        {
+            m_tuningKey.deviceId = GetDeviceId();
+        }
+        m_tuningKey.width = m_textureWidth;
+        m_tuningKey.height = m_textureHeight;
+        m_tunedVariantValid = false;
+        m_tuning = true;
+        try
+        {
+            m_tunedVariant = m_autotuner->Select(*this, m_tuningKey, tuned);
+        }
+        catch (...)
+        {
+            m_tuning = false;
+            throw;
+        }
+        m_tuning = false;
+        m_tunedVariantValid = true;
+    }
+    variant = m_tunedVariant;
+    return true;
+}
+
+void IReductionBackend::SetTextureSize(uint32_t width, uint32_t height)
+{
+    m_textureWidth = width;
+    m_textureHeight = height;
+}
+
+uint64_t IReductionBackend::SubmitKernel(uint32_t threadGroupSize)
+{
+    DispatchKernel(threadGroupSize);
+    ReductionResult result;
+    result.maxValue = ReadBack();
+    result.dispatchTimeMs = GetLastDispatchTimeMs();
+    result.hasAtomicStats = GetLastAtomicStats(result.atomicStats);
+    m_completedResults[++m_lastTicket] = result;
+    return m_lastTicket;
+}
+
+bool IReductionBackend::PollResult(uint64_t ticket, ReductionResult& result)
+{
+    auto completed = m_completedResults.find(ticket);
+    if (completed == m_completedResults.end())
+    {
+        throw std::runtime_error("No result for ticket " + std::to_string(ticket) + ", it was never submitted or already taken");
+    }
+    result = completed->second;
+    m_completedResults.erase(completed);
+    return true;
+}
+
+ReductionResult IReductionBackend::WaitResult(uint64_t ticket)
+{
+    ReductionResult result;
+    PollResult(ticket, result);
+    return result;
+}
+
+ReductionBackendType ParseReductionBackendType(const std::string& name)
+{
+    if (name == "d3d12")
+    {
+        return ReductionBackendType::D3D12;
+    }
+    if (name == "cpu")
+    {
+        return ReductionBackendType::Cpu;
+    }
+    if (name == "emulator")
+    {
+        return ReductionBackendType::Emulator;
+    }
+
+    throw std::runtime_error("Unknown reduction backend: " + name);
+}
+
+ReductionStrategy ParseReductionStrategy(const std::string& name)
+{
+    if (name == "partials")
+    {
+        return ReductionStrategy::GroupPartials;
+    }
+    if (name == "atomic")
+    {
+        return ReductionStrategy::AtomicMax;
+    }
+
+    throw std::runtime_error("Unknown reduction strategy: " + name);
+}
+
+const char* GetReductionStrategyName(ReductionStrategy strategy)
+{
+    switch (strategy)
+    {
+    case ReductionStrategy::GroupPartials:
+        return "partials";
+    case ReductionStrategy::AtomicMax:
+        return "atomic";
+    }
+    return "unknown";
+}
@@ -0,0 +1,162 @@
+#pragma once
+
+#include "SimdReduction.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Hardware-independent interface for the max-reduction.
+// The sequence mirrors what the D3D12 path does:
+// create device -> upload texture -> dispatch kernel -> read back result
+enum class ReductionBackendType
+{
+    D3D12,
+    Cpu,
+    Emulator
+};
+
+// How the per-group maxima are combined into the result
+enum class ReductionStrategy
+{
+    GroupPartials,  // CompuetShader.hlsl, one partial per group in an intermediate buffer that is reduced afterwards
+    AtomicMax       // AtomicMaxReduction.hlsl, every group does one InterlockedMax into a single UINT
+};
+
+// One point of the search space ReductionAutotuner benchmarks
+struct TuningVariant
+{
+    uint32_t threadGroupSize = 16;
+    unsigned int workerCount = 0;   // CPU worker threads, 0 uses all hardware threads; GPU backends ignore it
+    uint32_t tileWidth = 0;         // texels per row of a CPU host tile, 0 for the backend default; GPU backends ignore it
+    uint32_t tileHeight = 0;        // rows of a CPU host tile, 0 for the backend default; GPU backends ignore it
+};
+
+// What a tuned variant is remembered for, see TuningDatabase
+struct TuningKey
+{
+    std::string deviceId;       // IReductionBackend::GetDeviceId() or a user supplied identity
+    std::string backend;
+    std::string strategy;
+    TexelFormat format = TexelFormat::R8;
+    uint32_t width = 0;
+    uint32_t height = 0;
+};
+
+class ReductionAutotuner;
+
+// Memory an in-place texture upload writes to, see IReductionBackend::BeginTextureUpload
+struct TextureUploadRegion
+{
+    uint8_t* texels = nullptr;
+    uint32_t rowPitch = 0;
+    bool writeCombined = false;     // uncached upload memory: write rows sequentially, never read them
+};
+
+// Contention of the InterlockedMax updates of one ReductionStrategy::AtomicMax dispatch
+struct AtomicReductionStats
+{
+    uint64_t deviceAtomics = 0;     // InterlockedMax operations, one per group
+    uint64_t atomicRetries = 0;     // failed compare-exchanges of those, i.e. contention between groups
+};
+
+// Outcome of one submitted dispatch
+struct ReductionResult
+{
+    uint32_t maxValue = 0;
+    double dispatchTimeMs = 0.0;
+    bool hasAtomicStats = false;    // atomicStats is valid, see IReductionBackend::GetLastAtomicStats
+    AtomicReductionStats atomicStats;
+};
+
+class IReductionBackend
+{
+public:
+    virtual ~IReductionBackend() = default;
+
+    virtual const char* GetName() const = 0;
+
+    // Create device and any objects that live as long as the backend
+    virtual void CreateDevice() = 0;
+
+    // Upload an R8 texture, rowPitch is the distance in bytes between rows of texels
+    virtual void UploadTexture(const uint8_t* texels, uint32_t width, uint32_t height, uint32_t rowPitch) = 0;
+
+    // UploadTexture without a host copy: the caller writes the width x height texels into the returned
+    // region, EndTextureUpload makes them the texture of the next Dispatch
+    virtual TextureUploadRegion BeginTextureUpload(uint32_t width, uint32_t height) = 0;
+    virtual void EndTextureUpload() = 0;
+
+    // Run the reduction kernel over the last uploaded texture using threadGroupSize x threadGroupSize tiles, or
+    // with the tuned variant of the texture size when an autotuner is set
+    void Dispatch(uint32_t threadGroupSize);
+
+    // Max texel value of the last dispatch
+    virtual uint32_t ReadBack() = 0;
+
+    // Time spent in the last dispatch in milliseconds (GPU timestamps or host clock)
+    virtual double GetLastDispatchTimeMs() const = 0;
+
+    // InterlockedMax counts of the last dispatch; false unless the strategy is AtomicMax and the backend
+    // can count its atomics (the D3D12 backend cannot)
+    virtual bool GetLastAtomicStats(AtomicReductionStats&) const { return false; }
+
+    // Dispatch without waiting for the result. Submit returns a ticket whose result is handed out once,
+    // PollResult returns false while the job is still running and WaitResult blocks until it has completed.
+    // Up to GetMaxJobsInFlight jobs run while the caller prepares the next texture. The defaults dispatch
+    // synchronously in Submit, so their tickets are complete right away. Submit tunes like Dispatch.
+    uint64_t Submit(uint32_t threadGroupSize);
+    virtual bool PollResult(uint64_t ticket, ReductionResult& result);
+    virtual ReductionResult WaitResult(uint64_t ticket);
+    virtual uint32_t GetMaxJobsInFlight() const { return 1; }
+
+    // Identity of the executing device for the tuning database: results of one device/driver do not carry over
+    virtual std::string GetDeviceId() const = 0;
+
+    // Candidates the autotuner chooses from (thread group sizes 8, 16 and 32 unless overridden). ApplyTuningVariant
+    // makes the backend specific part of a variant current, Dispatch keeps taking the group size.
+    virtual std::vector<TuningVariant> GetTuningVariants() const;
+    virtual void ApplyTuningVariant(const TuningVariant&) {}
+
+    // Tuning behind Dispatch and Submit: the first dispatch of a texture size looks the size up in the
+    // autotuner's database under key (width and height are replaced, an empty deviceId becomes GetDeviceId()),
+    // benchmarks the GetTuningVariants() candidates on the current texture on a miss, and from then on every
+    // dispatch of the size runs the chosen variant instead of the threadGroupSize it was given.
+    // The autotuner is not owned, nullptr turns tuning off.
+    void SetAutotuner(ReductionAutotuner* autotuner, const TuningKey& key);
+
+    // Variant of the current texture size, tuned now if the database does not know it yet; false without an
+    // autotuner or texture. tuned reports whether this call ran the sweep.
+    bool SelectTuning(TuningVariant& variant, bool* tuned = nullptr);
+
+protected:
+    // Dispatch and Submit with the final group size
+    virtual void DispatchKernel(uint32_t threadGroupSize) = 0;
+    virtual uint64_t SubmitKernel(uint32_t threadGroupSize);
+
+    // Size of the texture the next dispatch reads, backends report it from UploadTexture and BeginTextureUpload
+    void SetTextureSize(uint32_t width, uint32_t height);
+
+private:
+    ReductionAutotuner* m_autotuner = nullptr;
+    TuningKey m_tuningKey;
+    TuningVariant m_tunedVariant;
+    bool m_tunedVariantValid = false;   // m_tunedVariant belongs to the size in m_tuningKey
+    bool m_tuning = false;              // inside ReductionAutotuner::Select, whose dispatches run the given variant
+    uint32_t m_textureWidth = 0;
+    uint32_t m_textureHeight = 0;
+
+
+    // Results of the synchronous Submit, by ticket
+    std::map<uint64_t, ReductionResult> m_completedResults;
+    uint64_t m_lastTicket = 0;
+};
+
+std::unique_ptr<IReductionBackend> CreateReductionBackend(ReductionBackendType type, ReductionStrategy strategy = ReductionStrategy::GroupPartials);
+
+ReductionBackendType ParseReductionBackendType(const std::string& name);
+
+// "partials" or "atomic"
+ReductionStrategy ParseReductionStrategy(const std::string& name);
+const char* GetReductionStrategyName(ReductionStrategy strategy);
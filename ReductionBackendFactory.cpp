@@ -0,0 +1,28 @@
+#include "ReductionBackend.h"
+#include "CpuReductionBackend.h"
+#include "EmulatorReductionBackend.h"
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include "D3D12ReductionBackend.h"
+#endif
+
+// Apart from ReductionBackend.cpp so code that only needs the interface does not link every backend
+std::unique_ptr<IReductionBackend> CreateReductionBackend(ReductionBackendType type, ReductionStrategy strategy)
+{
+    switch (type)
+    {
+    case ReductionBackendType::D3D12:
+#if defined(_WIN32)
+        return std::make_unique<D3D12ReductionBackend>(strategy);
+#else
+        throw std::runtime_error("D3D12 backend is not available on this platform");
+#endif
+    case ReductionBackendType::Cpu:
+        return std::make_unique<CpuReductionBackend>(0, strategy);
+    case ReductionBackendType::Emulator:
+        return std::make_unique<EmulatorReductionBackend>(0, strategy);
+    }
+
+    throw std::runtime_error("Unknown reduction backend");
+}
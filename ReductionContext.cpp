@@ -0,0 +1,490 @@
+#include "ReductionContext.h"
+#include "BufferReduction.h"
+#include "ReductionLayout.h"
+#include "SimdReduction.h"
+#include "TextureData.h"
+#include "d3dx12.h"
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace
+{
+    // Views for a few dozen cached sizes, the ring for the tables of other passes on the command list
+    const uint32_t PersistentDescriptorCount = 1024;
+    const uint32_t TransientDescriptorCount = 256;
+    const uint32_t ClearDescriptorCount = 256;
+
+    // Heap sizes of the placed resource allocators, a larger resource gets a heap of its own size
+    const uint64_t TextureHeapSize = 64ull << 20;
+    const uint64_t BufferHeapSize = 16ull << 20;
+    const uint64_t UploadHeapSize = 64ull << 20;
+    const uint64_t ReadbackHeapSize = 4ull << 20;
+
+    // Room for a few 4096x4096 textures in flight, a larger texture replaces the ring with one of its size
+    const uint64_t UploadRingSize = 64ull << 20;
+    // Timestamps and results of many runs when the partials are reduced on the GPU, a few with CPU final reduction
+    const uint64_t ReadbackRingSize = 4ull << 20;
+    const UINT64 TimestampBytes = 2 * sizeof(UINT64);
+
+    D3D12_RESOURCE_DESC MakeInputTextureDesc(UINT width, UINT height, DXGI_FORMAT format)
+    {
+        D3D12_RESOURCE_DESC textureDesc = {};
+        textureDesc.Dimension = D3D12_RESOURCE_DIMENSION_TEXTURE2D;
+        textureDesc.Width = width;
+        textureDesc.Height = height;
+        textureDesc.DepthOrArraySize = 1;
+        textureDesc.MipLevels = 1;
+        textureDesc.Format = format;
+        textureDesc.SampleDesc.Count = 1;
+        textureDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+        textureDesc.Flags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+        return textureDesc;
+    }
+}
+
+ReductionContext::ReductionContext(ID3D12Device* device, ID3D12CommandQueue* commandQueue, ID3D12GraphicsCommandList* commandList, ID3D12CommandAllocator* commandAllocator,
+    size_t maxCachedEntries, uint64_t maxCachedBytes, uint32_t maxJobsInFlight)
+    : m_device(device), m_commandQueue(commandQueue), m_commandList(commandList),
+      m_descriptorHeap(std::make_unique<DescriptorHeap>(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, PersistentDescriptorCount, TransientDescriptorCount, true)),
+      m_clearDescriptorHeap(std::make_unique<DescriptorHeap>(device, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, ClearDescriptorCount, 0, false)),
+      m_textureAllocator(std::make_unique<PlacedResourceAllocator>(device, D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_NON_RT_DS_TEXTURES, TextureHeapSize)),
+      m_bufferAllocator(std::make_unique<PlacedResourceAllocator>(device, D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS, BufferHeapSize)),
+      m_uploadAllocator(std::make_unique<PlacedResourceAllocator>(device, D3D12_HEAP_TYPE_UPLOAD, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS, UploadHeapSize)),
+      m_readbackAllocator(std::make_unique<PlacedResourceAllocator>(device, D3D12_HEAP_TYPE_READBACK, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS, ReadbackHeapSize)),
+      m_uploadRing(std::make_unique<UploadRingBuffer>(device, *m_uploadAllocator, UploadRingSize)),
+      m_readbackRing(std::make_unique<ReadbackRingBuffer>(*m_readbackAllocator, ReadbackRingSize)),
+      m_cache(maxCachedEntries, maxCachedBytes),
+      m_submissionQueue(std::make_unique<D3D12SubmissionQueue>(device, commandQueue)),
+      m_scheduler(std::make_unique<SubmissionScheduler>(*m_submissionQueue, maxJobsInFlight))
+{
+    // Create query heap for timestamp queries
+    D3D12_QUERY_HEAP_DESC queryHeapDesc = {};
+    queryHeapDesc.Type = D3D12_QUERY_HEAP_TYPE_TIMESTAMP;
+    queryHeapDesc.Count = 2;
+    if (FAILED(m_device->CreateQueryHeap(&queryHeapDesc, IID_PPV_ARGS(&m_queryHeap))))
+    {
+        throw std::runtime_error("Failed to create query heap");
+    }
+
+    // The caller's allocator is the first slot, the list is reset with the slot of every job
+    m_commandAllocators.push_back(commandAllocator);
+    while (m_commandAllocators.size() < maxJobsInFlight)
+    {
+        ComPtr<ID3D12CommandAllocator> allocator;
+        if (FAILED(m_device->CreateCommandAllocator(m_commandList->GetType(), IID_PPV_ARGS(&allocator))))
+        {
+            throw std::runtime_error("Failed to create command allocator");
+        }
+        m_commandAllocators.push_back(allocator);
+    }
+
+    m_commandQueue->GetTimestampFrequency(&m_timestampFrequency);
+}
+
+ReductionContext::~ReductionContext()
+{
+    // Jobs in flight still use the cached resources and the rings
+    m_scheduler->WaitIdle();
+}
+
+void ReductionContext::SetCacheLimits(size_t maxEntries, uint64_t maxBytes)
+{
+    m_cache.SetLimits(maxEntries, maxBytes);
+    ReleaseEvictedResources();
+}
+
+bool ReductionContext::Evict(UINT width, UINT height, UINT threadGroupSize, ReductionStrategy strategy)
+{
+    const bool evicted = m_cache.Evict({ width, height, DXGI_FORMAT_R8_UNORM, threadGroupSize, static_cast<uint32_t>(strategy) });
+    ReleaseEvictedResources();
+    return evicted;
+}
+
+void ReductionContext::EvictAll()
+{
+    m_cache.Clear();
+    ReleaseEvictedResources();
+}
+
+void ReductionContext::ReleaseEvictedResources()
+{
+    m_cache.Release(m_submissionQueue->GetCompletedValue());
+}
+
+void ReductionContext::SetBufferReductionPipeline(ID3D12PipelineState* pipelineState, ID3D12RootSignature* rootSignature)
+{
+    if (pipelineState != m_bufferReductionPipelineState.Get())
+    {
+        m_cache.Clear();
+        ReleaseEvictedResources();
+    }
+    m_bufferReductionPipelineState = pipelineState;
+    m_bufferReductionRootSignature = rootSignature;
+}
+
+PersistentDescriptors ReductionContext::AllocateViews(DescriptorHeap& heap, uint32_t count)
+{
+    // Views of evicted entries return to the heap once the last job using them has completed, only a
+    // heap that is still full after evicting every entry waits for the jobs in flight
+    DescriptorRange range = heap.AllocatePersistent(count);
+    while (!range.IsValid())
+    {
+        uint64_t fenceValue = 0;
+        if (!m_cache.EvictLeastRecentlyUsed())
+        {
+            if (!m_cache.GetOldestRetiredFenceValue(fenceValue))
+            {
+                break;
+            }
+            m_scheduler->Wait(fenceValue);
+        }
+        ReleaseEvictedResources();
+        range = heap.AllocatePersistent(count);
+    }
+    if (!range.IsValid())
+    {
+        throw std::runtime_error("Descriptor heap too small for " + std::to_string(count) + " views");
+    }
+    return PersistentDescriptors(&heap, range);
+}
+
+PlacedResource ReductionContext::CreateBuffer(D3D12_HEAP_TYPE heapType, UINT64 size, D3D12_RESOURCE_FLAGS flags, D3D12_RESOURCE_STATES initialState, const char* name)
+{
+    PlacedResourceAllocator* allocator = m_bufferAllocator.get();
+    if (heapType == D3D12_HEAP_TYPE_UPLOAD)
+    {
+        allocator = m_uploadAllocator.get();
+    }
+    else if (heapType == D3D12_HEAP_TYPE_READBACK)
+    {
+        allocator = m_readbackAllocator.get();
+    }
+    return allocator->CreateResource(CD3DX12_RESOURCE_DESC::Buffer(size, flags), initialState, name);
+}
+
+ReductionContext::Resources ReductionContext::CreateResources(const ReductionResourceKey& key, uint64_t& sizeInBytes)
+{
+    Resources resources;
+    if (static_cast<ReductionStrategy>(key.strategy) == ReductionStrategy::AtomicMax)
+    {
+        // InterlockedMax target, nothing left to reduce afterwards
+        resources.outputCount = 1;
+    }
+    else
+    {
+        resources.outputCount = MakeReductionLayout(key.width, key.height, key.threadGroupSize).partialCount;
+        if (resources.outputCount == 0)
+        {
+            throw std::runtime_error("Texture is empty");
+        }
+        if (UsesGpuFinalReduction())
+        {
+            resources.passSizes = GetBufferReductionPassSizes(resources.outputCount);
+        }
+    }
+    resources.resultCount = (UsesGpuFinalReduction() || resources.outputCount == 1) ? 1 : resources.outputCount;
+
+    // Create input texture, its texels arrive through the upload ring
+    const D3D12_RESOURCE_DESC textureDesc = MakeInputTextureDesc(key.width, key.height, static_cast<DXGI_FORMAT>(key.format));
+    resources.inputTexture = m_textureAllocator->CreateResource(textureDesc, D3D12_RESOURCE_STATE_COPY_DEST, "input texture");
+    UINT64 textureSize;
+    m_device->GetCopyableFootprints(&textureDesc, 0, 1, 0, nullptr, nullptr, nullptr, &textureSize);
+
+    // Create intermediate buffer and the outputs of the buffer reduction passes
+    const UINT64 outputSize = resources.outputCount * sizeof(UINT);
+    resources.intermediateBuffer = CreateBuffer(D3D12_HEAP_TYPE_DEFAULT, outputSize, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, "intermediate buffer");
+    UINT64 passBufferBytes = 0;
+    for (uint32_t passSize : resources.passSizes)
+    {
+        resources.passBuffers.push_back(CreateBuffer(D3D12_HEAP_TYPE_DEFAULT, passSize * sizeof(UINT), D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, "reduction pass buffer"));
+        passBufferBytes += passSize * sizeof(UINT);
+    }
+
+    // Allocate the views from the context heaps, they never change for the lifetime of the resources
+    resources.views = AllocateViews(*m_descriptorHeap, 2 + 2 * static_cast<uint32_t>(resources.passSizes.size()));
+    resources.clearView = AllocateViews(*m_clearDescriptorHeap, 1);
+
+    const UINT descriptorSize = m_descriptorHeap->GetDescriptorSize();
+    CD3DX12_CPU_DESCRIPTOR_HANDLE handle(resources.views.GetCpuHandle());
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = DXGI_FORMAT_R8_UINT;
+    srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+    srvDesc.Texture2D.MostDetailedMip = 0;
+    srvDesc.Texture2D.MipLevels = 1;
+    m_device->CreateShaderResourceView(resources.inputTexture.Get(), &srvDesc, handle);
+    handle.Offset(1, descriptorSize);
+
+    D3D12_UNORDERED_ACCESS_VIEW_DESC uavDesc = {};
+    uavDesc.ViewDimension = D3D12_UAV_DIMENSION_BUFFER;
+    uavDesc.Buffer.NumElements = resources.outputCount;
+    uavDesc.Buffer.StructureByteStride = sizeof(UINT);
+    m_device->CreateUnorderedAccessView(resources.intermediateBuffer.Get(), nullptr, &uavDesc, handle);
+    m_device->CreateUnorderedAccessView(resources.intermediateBuffer.Get(), nullptr, &uavDesc, resources.clearView.GetCpuHandle());
+    handle.Offset(1, descriptorSize);
+
+    // Pass i reads the output of pass i - 1 (the intermediate buffer for the first pass)
+    ID3D12Resource* passInput = resources.intermediateBuffer.Get();
+    UINT passInputCount = resources.outputCount;
+    for (size_t i = 0; i < resources.passSizes.size(); ++i)
+    {
+        D3D12_SHADER_RESOURCE_VIEW_DESC bufferSrvDesc = {};
+        bufferSrvDesc.ViewDimension = D3D12_SRV_DIMENSION_BUFFER;
+        bufferSrvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+        bufferSrvDesc.Buffer.NumElements = passInputCount;
+        bufferSrvDesc.Buffer.StructureByteStride = sizeof(UINT);
+        m_device->CreateShaderResourceView(passInput, &bufferSrvDesc, handle);
+        handle.Offset(1, descriptorSize);
+
+        uavDesc.Buffer.NumElements = resources.passSizes[i];
+        m_device->CreateUnorderedAccessView(resources.passBuffers[i].Get(), nullptr, &uavDesc, handle);
+        handle.Offset(1, descriptorSize);
+
+        passInput = resources.passBuffers[i].Get();
+        passInputCount = resources.passSizes[i];
+    }
+
+    sizeInBytes = textureSize + outputSize + passBufferBytes;
+    return resources;
+}
+
+UploadRegion ReductionContext::BeginTextureUpload(UINT width, UINT height)
+{
+    const D3D12_RESOURCE_DESC textureDesc = MakeInputTextureDesc(width, height, DXGI_FORMAT_R8_UNORM);
+    UINT64 size = 0;
+    m_device->GetCopyableFootprints(&textureDesc, 0, 1, 0, nullptr, nullptr, nullptr, &size);
+    if (size != UINT64_MAX && size > m_uploadRing->GetCapacity())
+    {
+        // The old ring can go before the new one is placed once no job reads from it
+        m_scheduler->WaitIdle();
+        m_uploadRing.reset();
+        m_uploadRing = std::make_unique<UploadRingBuffer>(m_device, *m_uploadAllocator, size);
+    }
+    // An earlier upload that was never run is not read by any submission, it can go with the next fence
+    m_uploadRing->Retire(m_commandQueue);
+    return m_uploadRing->AllocateTexture(textureDesc);
+}
+
+UINT ReductionContext::Run(ID3D12PipelineState* pipelineState, ID3D12RootSignature* rootSignature, const std::vector<uint8_t>& textureBytes, UINT width, UINT height, UINT threadGroupSize, double* gpuTimeMs,
+    ReductionStrategy strategy)
+{
+    if (threadGroupSize == 0 || textureBytes.size() < static_cast<size_t>(width) * height)
+    {
+        throw std::runtime_error("Invalid arguments for reduction run");
+    }
+
+    // One streaming copy into the ring, UpdateSubresources used to map and copy a per-size upload buffer
+    const UploadRegion texture = BeginTextureUpload(width, height);
+    CopyTextureRows(texture.data, texture.footprint.Footprint.RowPitch, textureBytes.data(), width, width, height, true);
+    return Run(pipelineState, rootSignature, texture, threadGroupSize, gpuTimeMs, strategy);
+}
+
+UINT ReductionContext::Run(ID3D12PipelineState* pipelineState, ID3D12RootSignature* rootSignature, const UploadRegion& texture, UINT threadGroupSize, double* gpuTimeMs,
+    ReductionStrategy strategy)
+{
+    return WaitResult(Submit(pipelineState, rootSignature, texture, threadGroupSize, strategy), gpuTimeMs);
+}
+
+uint64_t ReductionContext::Submit(ID3D12PipelineState* pipelineState, ID3D12RootSignature* rootSignature, const UploadRegion& texture, UINT threadGroupSize,
+    ReductionStrategy strategy)
+{
+    const UINT width = texture.footprint.Footprint.Width;
+    const UINT height = texture.footprint.Footprint.Height;
+    if (threadGroupSize == 0 || texture.buffer == nullptr || texture.footprint.Footprint.Format != DXGI_FORMAT_R8_UNORM)
+    {
+        throw std::runtime_error("Invalid arguments for reduction run");
+    }
+
+    const ReductionResourceKey key = { width, height, DXGI_FORMAT_R8_UNORM, threadGroupSize, static_cast<uint32_t>(strategy) };
+    const ReductionLayout layout = MakeReductionLayout(width, height, threadGroupSize);
+    ReleaseEvictedResources();
+    Resources* resources = m_cache.Find(key);
+    if (resources == nullptr)
+    {
+        uint64_t sizeInBytes = 0;
+        Resources created = CreateResources(key, sizeInBytes);
+        resources = &m_cache.Insert(key, std::move(created), sizeInBytes);
+    }
+
+    // Timestamps and the result (single value or all partials) go to this job's region of the readback ring
+    const ReadbackRegion readback = AllocateReadback(TimestampBytes + resources->resultCount * sizeof(UINT));
+
+    // Reset the command allocator of a slot whose previous job has completed, and the list with it. A throw
+    // before the submission abandons the job, the slot is reused by the next one.
+    ScopedSubmissionJob job(*m_scheduler);
+    ID3D12CommandAllocator* commandAllocator = m_commandAllocators[job.GetSlot()].Get();
+    commandAllocator->Reset();
+    m_commandList->Reset(commandAllocator, pipelineState);
+
+    // Only the texel copy from the upload ring is per run
+    CD3DX12_TEXTURE_COPY_LOCATION copyDestination(resources->inputTexture.Get(), 0);
+    CD3DX12_TEXTURE_COPY_LOCATION copySource(texture.buffer, texture.footprint);
+    m_commandList->CopyTextureRegion(&copyDestination, 0, 0, 0, &copySource, nullptr);
+
+    CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(resources->inputTexture.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+    m_commandList->ResourceBarrier(1, &barrier);
+
+    // Set pipeline state, root signature and descriptor tables
+    m_commandList->SetPipelineState(pipelineState);
+    m_commandList->SetComputeRootSignature(rootSignature);
+    ID3D12DescriptorHeap* heaps[] = { m_descriptorHeap->Get() };
+    m_commandList->SetDescriptorHeaps(_countof(heaps), heaps);
+    D3D12_GPU_DESCRIPTOR_HANDLE srvHandle = resources->views.GetGpuHandle(0);
+    D3D12_GPU_DESCRIPTOR_HANDLE uavHandleGpu = resources->views.GetGpuHandle(1);
+    m_commandList->SetComputeRootDescriptorTable(0, srvHandle);
+    m_commandList->SetComputeRootDescriptorTable(1, uavHandleGpu);
+    m_commandList->SetComputeRoot32BitConstants(ReductionConstantsRootParameter, ReductionConstantsCount, &layout.constants, 0);
+
+    // The AtomicMax variant needs its single element at 0 before the first InterlockedMax. Every group
+    // writes its own partial, clearing the partials too keeps a shader that skips one from reading stale values.
+    const UINT zero[4] = { 0, 0, 0, 0 };
+    m_commandList->ClearUnorderedAccessViewUint(uavHandleGpu, resources->clearView.GetCpuHandle(), resources->intermediateBuffer.Get(), zero, 0, nullptr);
+    CD3DX12_RESOURCE_BARRIER clearBarrier = CD3DX12_RESOURCE_BARRIER::UAV(resources->intermediateBuffer.Get());
+    m_commandList->ResourceBarrier(1, &clearBarrier);
+
+    // Dispatch between two timestamps
+    m_commandList->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 0);
+    m_commandList->Dispatch(layout.constants.groupsX, layout.constants.groupsY, 1);
+
+    // Buffer reduction passes, every pass reads the previous output through the SRV in front of its UAV
+    std::vector<CD3DX12_RESOURCE_BARRIER> restoreBarriers;
+    ID3D12Resource* result = resources->intermediateBuffer.Get();
+    if (!resources->passSizes.empty())
+    {
+        m_commandList->SetPipelineState(m_bufferReductionPipelineState.Get());
+        m_commandList->SetComputeRootSignature(m_bufferReductionRootSignature.Get());
+    }
+    for (size_t i = 0; i < resources->passSizes.size(); ++i)
+    {
+        CD3DX12_RESOURCE_BARRIER passBarrier = CD3DX12_RESOURCE_BARRIER::Transition(result, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE);
+        m_commandList->ResourceBarrier(1, &passBarrier);
+        restoreBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(result, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
+
+        D3D12_GPU_DESCRIPTOR_HANDLE passSrv = resources->views.GetGpuHandle(static_cast<uint32_t>(2 + 2 * i));
+        D3D12_GPU_DESCRIPTOR_HANDLE passUav = resources->views.GetGpuHandle(static_cast<uint32_t>(3 + 2 * i));
+        m_commandList->SetComputeRootDescriptorTable(0, passSrv);
+        m_commandList->SetComputeRootDescriptorTable(1, passUav);
+        m_commandList->Dispatch(resources->passSizes[i], 1, 1);
+
+        result = resources->passBuffers[i].Get();
+    }
+
+    m_commandList->EndQuery(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 1);
+    m_commandList->ResolveQueryData(m_queryHeap.Get(), D3D12_QUERY_TYPE_TIMESTAMP, 0, 2, readback.buffer, readback.offset);
+
+    CD3DX12_RESOURCE_BARRIER barrier2 = CD3DX12_RESOURCE_BARRIER::Transition(result, D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_COPY_SOURCE);
+    m_commandList->ResourceBarrier(1, &barrier2);
+    m_commandList->CopyBufferRegion(readback.buffer, readback.offset + TimestampBytes, result, 0, resources->resultCount * sizeof(UINT));
+
+    // Leave everything in its creation state for the next run
+    restoreBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(result, D3D12_RESOURCE_STATE_COPY_SOURCE, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
+    restoreBarriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(resources->inputTexture.Get(), D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE, D3D12_RESOURCE_STATE_COPY_DEST));
+    m_commandList->ResourceBarrier(static_cast<UINT>(restoreBarriers.size()), restoreBarriers.data());
+
+    if (FAILED(m_commandList->Close()))
+    {
+        throw std::runtime_error("Failed to close the reduction command list");
+    }
+    ID3D12CommandList* commandLists[] = { m_commandList };
+    m_commandQueue->ExecuteCommandLists(_countof(commandLists), commandLists);
+    const uint64_t ticket = job.End();
+    m_cache.MarkUsed(key, ticket);
+
+    // Every submission of an upload region retires it again, it stays until the last one has completed.
+    // The job's ticket tags its readback region, the result is delivered once it completes.
+    m_uploadRing->Retire(m_commandQueue, texture);
+    m_readbackRing->Retire(ticket);
+    m_pendingReadbacks.push_back({ ticket, readback, resources->resultCount });
+    return ticket;
+}
+
+bool ReductionContext::PollResult(uint64_t ticket, UINT& maxValue, double* gpuTimeMs)
+{
+    if (ticket > m_scheduler->GetLastTicket())
+    {
+        throw std::runtime_error("Polling ticket " + std::to_string(ticket) + " that was never submitted");
+    }
+    if (!m_scheduler->IsComplete(ticket))
+    {
+        return false;
+    }
+    DeliverReadbacks();
+    TakeResult(ticket, maxValue, gpuTimeMs);
+    return true;
+}
+
+UINT ReductionContext::WaitResult(uint64_t ticket, double* gpuTimeMs)
+{
+    m_scheduler->Wait(ticket);
+    DeliverReadbacks();
+    UINT maxValue = 0;
+    TakeResult(ticket, maxValue, gpuTimeMs);
+    return maxValue;
+}
+
+void ReductionContext::TakeResult(uint64_t ticket, UINT& maxValue, double* gpuTimeMs)
+{
+    auto delivered = m_results.find(ticket);
+    if (delivered == m_results.end())
+    {
+        throw std::runtime_error("No result for ticket " + std::to_string(ticket) + ", it was never submitted or already taken");
+    }
+    maxValue = delivered->second.maxValue;
+    if (gpuTimeMs)
+    {
+        *gpuTimeMs = delivered->second.gpuTimeMs;
+    }
+    m_results.erase(delivered);
+}
+
+ReadbackRegion ReductionContext::AllocateReadback(UINT64 size)
+{
+    // ResolveQueryData needs an 8 byte aligned destination
+    const UINT64 alignment = sizeof(UINT64);
+    if (size > m_readbackRing->GetCapacity())
+    {
+        m_scheduler->WaitIdle();
+        DeliverReadbacks();
+        m_readbackRing.reset();
+        m_readbackRing = std::make_unique<ReadbackRingBuffer>(*m_readbackAllocator, size);
+    }
+
+    ReadbackRegion region = m_readbackRing->Allocate(size, alignment);
+    while (!region.IsValid())
+    {
+        if (m_pendingReadbacks.empty())
+        {
+            throw std::runtime_error("Readback ring is full of regions that were never submitted");
+        }
+        m_scheduler->Wait(m_pendingReadbacks.front().fenceValue);
+        DeliverReadbacks();
+        region = m_readbackRing->Allocate(size, alignment);
+    }
+    return region;
+}
+
+void ReductionContext::DeliverReadbacks()
+{
+    const UINT64 completedValue = m_submissionQueue->GetCompletedValue();
+    UINT64 deliveredValue = 0;
+    while (!m_pendingReadbacks.empty() && m_pendingReadbacks.front().fenceValue <= completedValue)
+    {
+        const PendingReadback& pending = m_pendingReadbacks.front();
+        const UINT64* timestamps = reinterpret_cast<const UINT64*>(pending.region.data);
+        const UINT* values = reinterpret_cast<const UINT*>(pending.region.data + TimestampBytes);
+
+        RunResult result;
+        result.maxValue = ReduceMax(values, pending.resultCount);
+        result.gpuTimeMs = ((timestamps[1] - timestamps[0]) * 1000.0) / m_timestampFrequency;
+        m_results[pending.fenceValue] = result;
+
+        deliveredValue = pending.fenceValue;
+        m_pendingReadbacks.pop_front();
+    }
+    if (deliveredValue != 0)
+    {
+        m_readbackRing->Release(deliveredValue);
+    }
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include "D3D12SubmissionQueue.h"
+#include "DescriptorHeap.h"
+#include "PlacedResourceAllocator.h"
+#include "ReadbackRingBuffer.h"
+#include "ReductionBackend.h"
+#include "ReductionResourceCache.h"
+#include "SubmissionScheduler.h"
+#include "UploadRingBuffer.h"
+#include <d3d12.h>
+#include <wrl.h>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+using namespace Microsoft::WRL;
+
+// Reusable state for repeated ReadBackR8UNormValues style runs.
+// Textures, buffers and their views are created once per (width, height, format, group size)
+// and kept in an LRU cache, the query heap, submission fence and descriptor heaps once per context. The
+// views are persistent ranges of the context's shader visible heap, so every run binds the same heap.
+// The resources are placed in heaps of the context's PlacedResourceAllocators rather than committed.
+// Texels come from the context's persistently mapped UploadRingBuffer, a caller that writes them in place
+// (BeginTextureUpload) avoids every host copy. A run only copies the new texels to the texture and records
+// the dispatch. Submit returns without waiting: a SubmissionScheduler recycles maxJobsInFlight command
+// allocators by the fence value of their last job, and the job's fence value is its ticket. Results and
+// timestamps are copied to a region of the persistently mapped ReadbackRingBuffer and delivered once the
+// ticket has completed; Run is Submit followed by WaitResult.
+// Jobs of one size share the cached resources. Work of separate ExecuteCommandLists calls on one queue
+// does not overlap, so sharing needs no waits. Every job tags the entry it used with its ticket, and an
+// evicted entry is released once that ticket has completed rather than waiting for the jobs in flight.
+// With a buffer reduction pipeline (BufferReduction.hlsl) the partials are reduced on the GPU as well
+// and only the final 4 bytes are read back, otherwise the whole intermediate buffer is.
+class ReductionContext
+{
+public:
+    ReductionContext(ID3D12Device* device, ID3D12CommandQueue* commandQueue, ID3D12GraphicsCommandList* commandList, ID3D12CommandAllocator* commandAllocator,
+        size_t maxCachedEntries = 4, uint64_t maxCachedBytes = 0, uint32_t maxJobsInFlight = 3);
+    ~ReductionContext();
+
+    ReductionContext(const ReductionContext&) = delete;
+    ReductionContext& operator=(const ReductionContext&) = delete;
+
+    // Same result as ReadBackR8UNormValues for tightly packed R8 texels. pipelineState has to match strategy:
+    // a CompuetShader.hlsl variant for GroupPartials, an AtomicMaxReduction.hlsl variant for AtomicMax.
+    UINT Run(ID3D12PipelineState* pipelineState, ID3D12RootSignature* rootSignature, const std::vector<uint8_t>& textureBytes, UINT width, UINT height, UINT threadGroupSize, double* gpuTimeMs = nullptr,
+        ReductionStrategy strategy = ReductionStrategy::GroupPartials);
+
+    // Upload ring region for a width x height R8 texture, the caller writes the texels at the footprint's
+    // row pitch and passes the region to Run. It stays intact until the next BeginTextureUpload, so one
+    // upload can be run several times.
+    UploadRegion BeginTextureUpload(UINT width, UINT height);
+    UINT Run(ID3D12PipelineState* pipelineState, ID3D12RootSignature* rootSignature, const UploadRegion& texture, UINT threadGroupSize, double* gpuTimeMs = nullptr,
+        ReductionStrategy strategy = ReductionStrategy::GroupPartials);
+
+    // Records and submits a run and returns its ticket, waits only while maxJobsInFlight jobs are on the GPU
+    uint64_t Submit(ID3D12PipelineState* pipelineState, ID3D12RootSignature* rootSignature, const UploadRegion& texture, UINT threadGroupSize,
+        ReductionStrategy strategy = ReductionStrategy::GroupPartials);
+    // The result of a ticket is handed out once: PollResult returns false while the job is on the GPU,
+    // WaitResult blocks until it has completed
+    bool PollResult(uint64_t ticket, UINT& maxValue, double* gpuTimeMs = nullptr);
+    UINT WaitResult(uint64_t ticket, double* gpuTimeMs = nullptr);
+    void WaitIdle() { m_scheduler->WaitIdle(); }
+    uint32_t GetJobsInFlight() { return m_scheduler->GetJobsInFlight(); }
+    uint32_t GetMaxJobsInFlight() const { return m_scheduler->GetSlotCount(); }
+
+    // Eviction policy: entries beyond the limits are evicted least recently used first, their resources
+    // are released once the last job using them has completed
+    void SetCacheLimits(size_t maxEntries, uint64_t maxBytes);
+    bool Evict(UINT width, UINT height, UINT threadGroupSize, ReductionStrategy strategy = ReductionStrategy::GroupPartials);
+    void EvictAll();
+    const ResourceCacheStats& GetCacheStats() const { return m_cache.GetStats(); }
+
+    // nullptr switches back to reducing the partials on the CPU. Cached resources are released
+    // because their pass buffers and result counts depend on the mode.
+    void SetBufferReductionPipeline(ID3D12PipelineState* pipelineState, ID3D12RootSignature* rootSignature);
+    bool UsesGpuFinalReduction() const { return m_bufferReductionPipelineState != nullptr; }
+
+    // Shader visible heap of the context. Its ring is free for per-dispatch tables of other work recorded
+    // on the same command list, e.g. the descriptors parameter of ReadBackR8UNormValues.
+    DescriptorHeap& GetDescriptorHeap() { return *m_descriptorHeap; }
+
+private:
+    struct Resources
+    {
+        PlacedResource inputTexture;
+        PlacedResource intermediateBuffer;
+        std::vector<PlacedResource> passBuffers;            // BufferReduction.hlsl outputs, the last one holds the result
+        std::vector<uint32_t> passSizes;
+        PersistentDescriptors views;                        // texture SRV, intermediate UAV, then SRV + UAV per pass
+        PersistentDescriptors clearView;                    // CPU only copy of the intermediate UAV for ClearUnorderedAccessViewUint
+        UINT outputCount = 0;
+        UINT resultCount = 0;                               // elements read back, 1 with the GPU final reduction
+    };
+
+    // Results of a submitted run in the readback ring, read once the submission fence reaches fenceValue (the ticket)
+    struct PendingReadback
+    {
+        UINT64 fenceValue;
+        ReadbackRegion region;                              // two timestamps, then resultCount values
+        UINT resultCount;
+    };
+
+    struct RunResult
+    {
+        UINT maxValue;
+        double gpuTimeMs;
+    };
+
+    Resources CreateResources(const ReductionResourceKey& key, uint64_t& sizeInBytes);
+    PlacedResource CreateBuffer(D3D12_HEAP_TYPE heapType, UINT64 size, D3D12_RESOURCE_FLAGS flags, D3D12_RESOURCE_STATES initialState, const char* name);
+    // Evicts least recently used entries while heap has no room for count descriptors
+    PersistentDescriptors AllocateViews(DescriptorHeap& heap, uint32_t count);
+    // Delivers older results while the readback ring is full, replaces it when size never fits
+    ReadbackRegion AllocateReadback(UINT64 size);
+    // Reads every pending readback whose ticket has completed into m_results and releases its region
+    void DeliverReadbacks();
+    // Releases the resources of evicted cache entries whose last job has completed
+    void ReleaseEvictedResources();
+    void TakeResult(uint64_t ticket, UINT& maxValue, double* gpuTimeMs);
+
+    ID3D12Device* m_device;
+    ID3D12CommandQueue* m_commandQueue;
+    ID3D12GraphicsCommandList* m_commandList;
+    std::vector<ComPtr<ID3D12CommandAllocator>> m_commandAllocators;    // one per scheduler slot
+    ComPtr<ID3D12PipelineState> m_bufferReductionPipelineState;
+    ComPtr<ID3D12RootSignature> m_bufferReductionRootSignature;
+
+    // Before the cache, the cached resources and views are returned to them on destruction
+    std::unique_ptr<DescriptorHeap> m_descriptorHeap;
+    std::unique_ptr<DescriptorHeap> m_clearDescriptorHeap;
+    std::unique_ptr<PlacedResourceAllocator> m_textureAllocator;
+    std::unique_ptr<PlacedResourceAllocator> m_bufferAllocator;
+    std::unique_ptr<PlacedResourceAllocator> m_uploadAllocator;
+    std::unique_ptr<PlacedResourceAllocator> m_readbackAllocator;
+    std::unique_ptr<UploadRingBuffer> m_uploadRing;
+    std::unique_ptr<ReadbackRingBuffer> m_readbackRing;
+    LruResourceCache<ReductionResourceKey, Resources> m_cache;
+    ComPtr<ID3D12QueryHeap> m_queryHeap;
+    std::unique_ptr<D3D12SubmissionQueue> m_submissionQueue;
+    std::unique_ptr<SubmissionScheduler> m_scheduler;
+    UINT64 m_timestampFrequency = 0;
+    std::deque<PendingReadback> m_pendingReadbacks;         // in fence order
+    std::unordered_map<UINT64, RunResult> m_results;        // delivered and not yet taken, by ticket
+};
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstdint>
+
+// Dispatch layout of CompuetShader.hlsl and AtomicMaxReduction.hlsl, shared by ReductionContext,
+// ReadBackR8UNormValues, the emulator ports and the CPU backend.
+// [numthreads] has to be a literal, so the kernels are still compiled once per thread group size.
+// Everything that depends on the texture comes from ReductionConstants in root constants, so one
+// PSO per group size serves every texture size, including non-square and non power of two ones.
+
+// cbuffer ReductionConstants : register(b0) of the kernels, root parameter 2 of SerializeComputeRootSignature
+struct ReductionConstants
+{
+    uint32_t textureWidth;
+    uint32_t textureHeight;
+    uint32_t groupsX;       // row stride of the partials, group (x, y) writes element y * groupsX + x
+    uint32_t groupsY;
+};
+
+const uint32_t ReductionConstantsRootParameter = 2;
+const uint32_t ReductionConstantsCount = sizeof(ReductionConstants) / sizeof(uint32_t);
+
+struct ReductionLayout
+{
+    uint32_t threadGroupSize;
+    ReductionConstants constants;
+    uint32_t partialCount;  // one per group, the partial tiles at the right and bottom edge included
+};
+
+// threadGroupSize has to be non-zero
+inline ReductionLayout MakeReductionLayout(uint32_t width, uint32_t height, uint32_t threadGroupSize)
+{
+    ReductionLayout layout;
+    layout.threadGroupSize = threadGroupSize;
+    layout.constants.textureWidth = width;
+    layout.constants.textureHeight = height;
+    layout.constants.groupsX = (width + threadGroupSize - 1) / threadGroupSize;
+    layout.constants.groupsY = (height + threadGroupSize - 1) / threadGroupSize;
+    layout.partialCount = layout.constants.groupsX * layout.constants.groupsY;
+    return layout;
+}
+
+inline uint32_t GetPartialIndex(const ReductionConstants& constants, uint32_t groupX, uint32_t groupY)
+{
+    return groupY * constants.groupsX + groupX;
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <iterator>
+#include <map>
+#include <tuple>
+#include <utility>
+
+// Identity of the GPU resources one reduction needs
+struct ReductionResourceKey
+{
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;            // DXGI_FORMAT of the input texture
+    uint32_t threadGroupSize;
+    uint32_t strategy;          // ReductionStrategy, decides the intermediate buffer size
+
+    bool operator<(const ReductionResourceKey& other) const
+    {
+        return std::tie(width, height, format, threadGroupSize, strategy) < std::tie(other.width, other.height, other.format, other.threadGroupSize, other.strategy);
+    }
+
+    bool operator==(const ReductionResourceKey& other) const
+    {
+        return !(*this < other) && !(other < *this);
+    }
+};
+
+struct ResourceCacheStats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t bytes = 0;
+};
+
+// Least recently used cache with an entry and byte budget.
+// MarkUsed tags an entry with the fence value of the last submission that uses its value. An evicted
+// value whose fence has not completed yet is kept on a retired list instead of being destroyed, and
+// Release destroys it once the owner reports the fence as completed, so eviction never waits for the GPU
+// and never frees resources a job in flight still uses (ReductionContext passes its submission tickets).
+// Values left on destruction of the cache are destroyed right away, the owner waits for the GPU first.
+template <typename Key, typename Value>
+class LruResourceCache
+{
+public:
+    // 0 disables the respective limit
+    explicit LruResourceCache(size_t maxEntries = 4, uint64_t maxBytes = 0)
+        : m_maxEntries(maxEntries), m_maxBytes(maxBytes)
+    {
+    }
+
+    // Returns nullptr on a miss, a hit becomes the most recently used entry
+    Value* Find(const Key& key)
+    {
+        auto it = m_index.find(key);
+        if (it == m_index.end())
+        {
+            ++m_stats.misses;
+            return nullptr;
+        }
+        ++m_stats.hits;
+        m_entries.splice(m_entries.begin(), m_entries, it->second);
+        return &it->second->value;
+    }
+
+    // Adds or replaces an entry and evicts least recently used entries beyond the limits.
+    // The new entry itself is never evicted.
+    Value& Insert(const Key& key, Value value, uint64_t sizeInBytes)
+    {
+        Evict(key);
+        m_entries.push_front(Entry{ key, std::move(value), sizeInBytes, 0 });
+        m_index[key] = m_entries.begin();
+        m_stats.bytes += sizeInBytes;
+        Trim(m_maxEntries, m_maxBytes);
+        return m_entries.front().value;
+    }
+
+    // The value of key stays alive until fenceValue has completed, even when it is evicted before that
+    void MarkUsed(const Key& key, uint64_t fenceValue)
+    {
+        auto it = m_index.find(key);
+        if (it != m_index.end() && it->second->fenceValue < fenceValue)
+        {
+            it->second->fenceValue = fenceValue;
+        }
+    }
+
+    bool Evict(const Key& key)
+    {
+        auto it = m_index.find(key);
+        if (it == m_index.end())
+        {
+            return false;
+        }
+        m_stats.bytes -= it->second->sizeInBytes;
+        Retire(it->second);
+        m_index.erase(it);
+        ++m_stats.evictions;
+        return true;
+    }
+
+    // Destroys the retired values whose fence value has completed
+    void Release(uint64_t completedFenceValue)
+    {
+        m_completedFenceValue = std::max(m_completedFenceValue, completedFenceValue);
+        for (auto it = m_retired.begin(); it != m_retired.end();)
+        {
+            it = (it->fenceValue <= m_completedFenceValue) ? m_retired.erase(it) : std::next(it);
+        }
+    }
+
+    // Smallest fence value a retired value waits for, false when nothing is retired
+    bool GetOldestRetiredFenceValue(uint64_t& fenceValue) const
+    {
+        if (m_retired.empty())
+        {
+            return false;
+        }
+        fenceValue = m_retired.front().fenceValue;
+        for (const Entry& entry : m_retired)
+        {
+            fenceValue = std::min(fenceValue, entry.fenceValue);
+        }
+        return true;
+    }
+
+    // Evicts from the least recently used end until both limits hold, keeping at least the newest entry
+    void Trim(size_t maxEntries, uint64_t maxBytes)
+    {
+        while (m_entries.size() > 1 &&
+            ((maxEntries != 0 && m_entries.size() > maxEntries) || (maxBytes != 0 && m_stats.bytes > maxBytes)))
+        {
+            EvictLeastRecentlyUsed();
+        }
+    }
+
+    bool EvictLeastRecentlyUsed()
+    {
+        return !m_entries.empty() && Evict(m_entries.back().key);
+    }
+
+    void SetLimits(size_t maxEntries, uint64_t maxBytes)
+    {
+        m_maxEntries = maxEntries;
+        m_maxBytes = maxBytes;
+        Trim(m_maxEntries, m_maxBytes);
+    }
+
+    void Clear()
+    {
+        m_stats.evictions += m_entries.size();
+        while (!m_entries.empty())
+        {
+            Retire(m_entries.begin());
+        }
+        m_index.clear();
+        m_stats.bytes = 0;
+    }
+
+    size_t Size() const { return m_entries.size(); }
+    size_t GetRetiredCount() const { return m_retired.size(); }
+    const ResourceCacheStats& GetStats() const { return m_stats; }
+
+private:
+    struct Entry
+    {
+        Key key;
+        Value value;
+        uint64_t sizeInBytes;
+        uint64_t fenceValue;        // last submission using the value, 0 when none
+    };
+
+    // Moves an entry to the retired list, or destroys it when its fence has already completed
+    void Retire(typename std::list<Entry>::iterator entry)
+    {
+        if (entry->fenceValue <= m_completedFenceValue)
+        {
+            m_entries.erase(entry);
+        }
+        else
+        {
+            m_retired.splice(m_retired.end(), m_entries, entry);
+        }
+    }
+
+    std::list<Entry> m_entries;     // most recently used first
+    std::list<Entry> m_retired;     // evicted, waiting for their fence value
+    uint64_t m_completedFenceValue = 0;
+    std::map<Key, typename std::list<Entry>::iterator> m_index;
+    size_t m_maxEntries;
+    uint64_t m_maxBytes;
+    ResourceCacheStats m_stats;
+};
@@ -0,0 +1,463 @@
+#include "RegressionGate.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+
+namespace
+{
+    // Just enough JSON for WriteBenchmarkJson output: objects, arrays, strings without escapes
+    // other than \" and \\, numbers, true, false and null
+    struct JsonValue
+    {
+        enum class Type { Null, Bool, Number, String, Array, Object } type = Type::Null;
+        bool boolean = false;
+        double number = 0.0;
+        std::string string;
+        std::vector<JsonValue> array;
+        std::vector<std::pair<std::string, JsonValue>> object;
+
+        const JsonValue* Find(const std::string& key) const
+        {
+            for (const auto& member : object)
+            {
+                if (member.first == key)
+                {
+                    return &member.second;
+                }
+            }
+            return nullptr;
+        }
+    };
+
+    class JsonParser
+    {
+    public:
+        JsonParser(const char* text, size_t size) : m_pos(text), m_end(text + size) {}
+
+        JsonValue ParseDocument()
+        {
+            JsonValue value = ParseValue();
+            SkipWhitespace();
+            if (m_pos != m_end)
+            {
+                Fail("trailing characters");
+            }
+            return value;
+        }
+
+    private:
+        void Fail(const char* what)
+        {
+            throw std::runtime_error(std::string("Invalid benchmark JSON: ") + what);
+        }
+
+        void SkipWhitespace()
+        {
+            while (m_pos < m_end && (*m_pos == ' ' || *m_pos == '\t' || *m_pos == '\r' || *m_pos == '\n'))
+            {
+                ++m_pos;
+            }
+        }
+
+        bool Consume(char c)
+        {
+            SkipWhitespace();
+            if (m_pos < m_end && *m_pos == c)
+            {
+                ++m_pos;
+                return true;
+            }
+            return false;
+        }
+
+        void Expect(char c)
+        {
+            if (!Consume(c))
+            {
+                Fail("unexpected character");
+            }
+        }
+
+        bool ConsumeWord(const char* word)
+        {
+            const size_t length = std::char_traits<char>::length(word);
+            if (static_cast<size_t>(m_end - m_pos) >= length && std::equal(word, word + length, m_pos))
+            {
+                m_pos += length;
+                return true;
+            }
+            return false;
+        }
+
+        std::string ParseString()
+        {
+            Expect('"');
+            std::string text;
+            while (m_pos < m_end && *m_pos != '"')
+            {
+                if (*m_pos == '\\' && m_pos + 1 < m_end)
+                {
+                    ++m_pos;
+                }
+                text += *m_pos++;
+            }
+            if (m_pos == m_end)
+            {
+                Fail("unterminated string");
+            }
+            ++m_pos;
+            return text;
+        }
+
+        JsonValue ParseValue()
+        {
+            SkipWhitespace();
+            if (m_pos == m_end)
+            {
+                Fail("unexpected end");
+            }
+
+            JsonValue value;
+            if (*m_pos == '{')
+            {
+                ++m_pos;
+                value.type = JsonValue::Type::Object;
+                if (!Consume('}'))
+                {
+                    do
+                    {
+                        SkipWhitespace();
+                        std::string key = ParseString();
+                        Expect(':');
+                        value.object.emplace_back(std::move(key), ParseValue());
+                    } while (Consume(','));
+                    Expect('}');
+                }
+            }
+            else if (*m_pos == '[')
+            {
+                ++m_pos;
+                value.type = JsonValue::Type::Array;
+                if (!Consume(']'))
+                {
+                    do
+                    {
+                        value.array.push_back(ParseValue());
+                    } while (Consume(','));
+                    Expect(']');
+                }
+            }
+            else if (*m_pos == '"')
+            {
+                value.type = JsonValue::Type::String;
+                value.string = ParseString();
+            }
+            else if (ConsumeWord("true"))
+            {
+                value.type = JsonValue::Type::Bool;
+                value.boolean = true;
+            }
+            else if (ConsumeWord("false"))
+            {
+                value.type = JsonValue::Type::Bool;
+            }
+            else if (ConsumeWord("null"))
+            {
+                value.type = JsonValue::Type::Null;
+            }
+            else
+            {
+                // strtod needs a terminated string, numbers are short
+                const char* start = m_pos;
+                while (m_pos < m_end && std::strchr("+-.0123456789eE", *m_pos) != nullptr)
+                {
+                    ++m_pos;
+                }
+                const std::string number(start, m_pos);
+                char* parsed = nullptr;
+                value.type = JsonValue::Type::Number;
+                value.number = std::strtod(number.c_str(), &parsed);
+                if (number.empty() || parsed != number.c_str() + number.size())
+                {
+                    Fail("bad number");
+                }
+            }
+            return value;
+        }
+
+        const char* m_pos;
+        const char* m_end;
+    };
+
+    std::string GetString(const JsonValue& object, const char* key)
+    {
+        const JsonValue* value = object.Find(key);
+        return value && value->type == JsonValue::Type::String ? value->string : std::string();
+    }
+
+    uint32_t GetUint(const JsonValue& object, const char* key)
+    {
+        const JsonValue* value = object.Find(key);
+        return value && value->type == JsonValue::Type::Number ? static_cast<uint32_t>(value->number) : 0;
+    }
+
+    std::vector<BenchmarkResult> ParseBenchmarkJson(const char* text, size_t size)
+    {
+        JsonValue document = JsonParser(text, size).ParseDocument();
+        if (document.type != JsonValue::Type::Array)
+        {
+            throw std::runtime_error("Benchmark JSON has to be an array of results");
+        }
+
+        std::vector<BenchmarkResult> results;
+        for (const JsonValue& entry : document.array)
+        {
+            BenchmarkResult result;
+            result.backend = GetString(entry, "backend");
+            result.strategy = GetString(entry, "strategy");
+            result.distribution = GetString(entry, "distribution");
+            result.width = GetUint(entry, "width");
+            result.height = GetUint(entry, "height");
+            result.threadGroupSize = GetUint(entry, "threadGroupSize");
+            result.maxValue = GetUint(entry, "maxValue");
+            if (const JsonValue* samples = entry.Find("samplesMs"))
+            {
+                for (const JsonValue& sample : samples->array)
+                {
+                    result.samplesMs.push_back(sample.number);
+                }
+            }
+            results.push_back(std::move(result));
+        }
+        return results;
+    }
+
+    std::vector<BenchmarkResult> ParseLegacyStats(const char* text, size_t size)
+    {
+        std::vector<BenchmarkResult> results;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        std::istringstream lines(std::string(text, size));
+        std::string line;
+        while (std::getline(lines, line))
+        {
+            if (!line.empty() && line.back() == '\r')
+            {
+                line.pop_back();
+            }
+
+            uint32_t a = 0;
+            uint32_t b = 0;
+            double ms = 0.0;
+            char label[4] = {};
+            if (std::sscanf(line.c_str(), "Texture Size: %ux%u", &a, &b) == 2)
+            {
+                width = a;
+                height = b;
+            }
+            else if (std::sscanf(line.c_str(), "Thread Group Size: %ux%u", &a, &b) == 2)
+            {
+                BenchmarkResult result;
+                result.strategy = "partials";
+                result.distribution = "uniform";
+                result.width = width;
+                result.height = height;
+                result.threadGroupSize = a;
+                results.push_back(std::move(result));
+            }
+            else if (std::sscanf(line.c_str(), "%3s Time: %lf ms", label, &ms) == 2 && !results.empty())
+            {
+                results.back().backend = std::string(label) == "GPU" ? "d3d12" : "cpu";
+                results.back().samplesMs.push_back(ms);
+            }
+            else if (std::sscanf(line.c_str(), "Final Max Value: %u", &a) == 1 && !results.empty())
+            {
+                results.back().maxValue = a;
+            }
+        }
+
+        // Configurations without per-run lines (e.g. harness summaries) carry nothing to compare
+        results.erase(std::remove_if(results.begin(), results.end(), [](const BenchmarkResult& result) { return result.samplesMs.empty(); }), results.end());
+        return results;
+    }
+
+    std::string ConfigurationName(const BenchmarkResult& result)
+    {
+        return result.backend + "/" + result.strategy + "/" + result.distribution + " " +
+            std::to_string(result.width) + "x" + std::to_string(result.height) + " group " + std::to_string(result.threadGroupSize);
+    }
+
+    const char* GetVerdictName(RegressionVerdict verdict)
+    {
+        switch (verdict)
+        {
+        case RegressionVerdict::Unchanged:
+            return "unchanged";
+        case RegressionVerdict::Regressed:
+            return "REGRESSED";
+        case RegressionVerdict::Improved:
+            return "improved";
+        case RegressionVerdict::MissingBaseline:
+            return "new";
+        case RegressionVerdict::MissingCandidate:
+            return "missing";
+        }
+        return "unknown";
+    }
+}
+
+MannWhitneyResult MannWhitneyU(const std::vector<double>& a, const std::vector<double>& b)
+{
+    MannWhitneyResult result;
+    if (a.empty() || b.empty())
+    {
+        return result;
+    }
+
+    // Rank the pooled samples, ties get the average of their ranks
+    std::vector<std::pair<double, bool>> pooled;
+    pooled.reserve(a.size() + b.size());
+    for (double value : a)
+    {
+        pooled.emplace_back(value, true);
+    }
+    for (double value : b)
+    {
+        pooled.emplace_back(value, false);
+    }
+    std::sort(pooled.begin(), pooled.end(), [](const std::pair<double, bool>& x, const std::pair<double, bool>& y) { return x.first < y.first; });
+
+    const double n1 = static_cast<double>(a.size());
+    const double n2 = static_cast<double>(b.size());
+    const double n = n1 + n2;
+    double rankSumA = 0.0;
+    double tieCorrection = 0.0;
+    for (size_t i = 0; i < pooled.size();)
+    {
+        size_t j = i;
+        while (j < pooled.size() && pooled[j].first == pooled[i].first)
+        {
+            ++j;
+        }
+        const double averageRank = (i + 1 + j) / 2.0;
+        for (size_t k = i; k < j; ++k)
+        {
+            if (pooled[k].second)
+            {
+                rankSumA += averageRank;
+            }
+        }
+        const double ties = static_cast<double>(j - i);
+        tieCorrection += ties * ties * ties - ties;
+        i = j;
+    }
+
+    result.u = rankSumA - n1 * (n1 + 1) / 2;
+    const double mean = n1 * n2 / 2;
+    const double variance = n1 * n2 / 12 * ((n + 1) - tieCorrection / (n * (n - 1)));
+    if (variance <= 0.0)
+    {
+        return result;
+    }
+
+    // Continuity correction towards the mean
+    const double difference = result.u - mean;
+    const double corrected = difference > 0.5 ? difference - 0.5 : (difference < -0.5 ? difference + 0.5 : 0.0);
+    result.z = corrected / std::sqrt(variance);
+    result.pValue = std::erfc(std::fabs(result.z) / std::sqrt(2.0));
+    return result;
+}
+
+std::vector<BenchmarkResult> LoadBenchmarkResults(const std::string& filename)
+{
+    MappedFile file(filename);
+    const char* text = reinterpret_cast<const char*>(file.Data());
+    const size_t size = file.Size();
+    if (size == 0)
+    {
+        return {};
+    }
+
+    const char* first = std::find_if(text, text + size, [](char c) { return c != ' ' && c != '\t' && c != '\r' && c != '\n'; });
+    if (first != text + size && *first == '[')
+    {
+        return ParseBenchmarkJson(text, size);
+    }
+    return ParseLegacyStats(text, size);
+}
+
+std::vector<RegressionComparison> CompareBenchmarkResults(const std::vector<BenchmarkResult>& baseline, const std::vector<BenchmarkResult>& candidate, const RegressionGateOptions& options)
+{
+    // Repeated configurations (e.g. the same size twice in one file) pool their samples
+    std::map<std::string, std::pair<std::vector<double>, std::vector<double>>> configurations;
+    for (const BenchmarkResult& result : baseline)
+    {
+        std::vector<double>& samples = configurations[ConfigurationName(result)].first;
+        samples.insert(samples.end(), result.samplesMs.begin(), result.samplesMs.end());
+    }
+    for (const BenchmarkResult& result : candidate)
+    {
+        std::vector<double>& samples = configurations[ConfigurationName(result)].second;
+        samples.insert(samples.end(), result.samplesMs.begin(), result.samplesMs.end());
+    }
+
+    std::vector<RegressionComparison> comparisons;
+    for (const auto& configuration : configurations)
+    {
+        const std::vector<double>& baseSamples = configuration.second.first;
+        const std::vector<double>& candidateSamples = configuration.second.second;
+
+        RegressionComparison comparison;
+        comparison.configuration = configuration.first;
+        if (baseSamples.empty() || candidateSamples.empty())
+        {
+            comparison.verdict = baseSamples.empty() ? RegressionVerdict::MissingBaseline : RegressionVerdict::MissingCandidate;
+            comparisons.push_back(comparison);
+            continue;
+        }
+
+        comparison.baselineMedianMs = ComputeBenchmarkStats(baseSamples, 0.0).medianMs;
+        comparison.candidateMedianMs = ComputeBenchmarkStats(candidateSamples, 0.0).medianMs;
+        comparison.deltaPercent = comparison.baselineMedianMs > 0.0 ? 100.0 * (comparison.candidateMedianMs - comparison.baselineMedianMs) / comparison.baselineMedianMs : 0.0;
+        comparison.pValue = MannWhitneyU(candidateSamples, baseSamples).pValue;
+        if (comparison.pValue < options.alpha && comparison.deltaPercent > options.thresholdPercent)
+        {
+            comparison.verdict = RegressionVerdict::Regressed;
+        }
+        else if (comparison.pValue < options.alpha && comparison.deltaPercent < -options.thresholdPercent)
+        {
+            comparison.verdict = RegressionVerdict::Improved;
+        }
+        comparisons.push_back(comparison);
+    }
+    return comparisons;
+}
+
+bool WriteRegressionReport(std::ostream& out, const std::vector<RegressionComparison>& comparisons)
+{
+    out << std::left << std::setw(48) << "Configuration" << std::setw(14) << "Baseline ms" << std::setw(14) << "Candidate ms"
+        << std::setw(10) << "Delta" << std::setw(12) << "p" << "Verdict" << std::endl;
+
+    bool regressed = false;
+    for (const RegressionComparison& comparison : comparisons)
+    {
+        std::ostringstream delta;
+        delta << std::showpos << std::fixed << std::setprecision(1) << comparison.deltaPercent << "%";
+        out << std::left << std::setw(48) << comparison.configuration
+            << std::setw(14) << comparison.baselineMedianMs
+            << std::setw(14) << comparison.candidateMedianMs
+            << std::setw(10) << delta.str()
+            << std::setw(12) << comparison.pValue
+            << GetVerdictName(comparison.verdict) << std::endl;
+        regressed = regressed || comparison.verdict == RegressionVerdict::Regressed;
+    }
+    return regressed;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "BenchmarkHarness.h"
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Compares two benchmark result sets configuration by configuration.
+//
+// A configuration is (backend, strategy, distribution, width, height, thread group size). It regresses
+// when the candidate median is more than thresholdPercent slower than the baseline median and a two-sided
+// Mann-Whitney U test of the raw samples rejects "same distribution" at alpha. Both conditions are
+// needed: the test alone flags tiny but consistent shifts, the threshold alone flags noise.
+
+struct MannWhitneyResult
+{
+    double u = 0.0;             // U statistic of the first sample set
+    double z = 0.0;             // normal approximation with tie correction, positive when a is larger
+    double pValue = 1.0;        // two-sided
+};
+
+MannWhitneyResult MannWhitneyU(const std::vector<double>& a, const std::vector<double>& b);
+
+struct RegressionGateOptions
+{
+    double thresholdPercent = 5.0;
+    double alpha = 0.01;
+};
+
+enum class RegressionVerdict
+{
+    Unchanged,
+    Regressed,
+    Improved,
+    MissingBaseline,        // only in the candidate
+    MissingCandidate        // only in the baseline
+};
+
+struct RegressionComparison
+{
+    std::string configuration;      // "backend/strategy/distribution WxH group N"
+    double baselineMedianMs = 0.0;
+    double candidateMedianMs = 0.0;
+    double deltaPercent = 0.0;
+    double pValue = 1.0;
+    RegressionVerdict verdict = RegressionVerdict::Unchanged;
+};
+
+// Reads the JSON written by WriteBenchmarkJson or the legacy per-run text output (stats.txt:
+// "Texture Size", "Thread Group Size" and one "GPU Time"/"CPU Time" line per run). Legacy runs
+// have no backend name; GPU times are taken as d3d12, CPU times as cpu, strategy partials,
+// distribution uniform, which is what the old main.cpp ran.
+std::vector<BenchmarkResult> LoadBenchmarkResults(const std::string& filename);
+
+std::vector<RegressionComparison> CompareBenchmarkResults(const std::vector<BenchmarkResult>& baseline, const std::vector<BenchmarkResult>& candidate, const RegressionGateOptions& options);
+
+// Table of every comparison, returns true if any configuration regressed
+bool WriteRegressionReport(std::ostream& out, const std::vector<RegressionComparison>& comparisons);
@@ -0,0 +1,170 @@
+#include "RingBufferAllocator.h"
+#include "TextureDistributions.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+RingBufferAllocator::RingBufferAllocator(uint64_t capacity)
+    : m_capacity(capacity)
+{
+}
+
+uint64_t RingBufferAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+    if (size == 0 || alignment == 0 || size > m_capacity - m_used)
+    {
+        return InvalidRingOffset;
+    }
+    if (m_used == 0)
+    {
+        m_head = 0;
+        m_tail = 0;
+    }
+
+    // Free bytes are [head, capacity) + [0, tail) when head is at or past tail, [head, tail) otherwise
+    uint64_t offset = (m_head + alignment - 1) / alignment * alignment;
+    if (m_head >= m_tail)
+    {
+        if (offset > m_capacity || m_capacity - offset < size)
+        {
+            if (m_tail < size)
+            {
+                return InvalidRingOffset;
+            }
+            offset = 0;
+        }
+    }
+    else if (offset > m_tail || m_tail - offset < size)
+    {
+        return InvalidRingOffset;
+    }
+
+    // Padding, or the skipped tail of the ring, belongs to this allocation
+    const uint64_t padding = (offset >= m_head) ? offset - m_head : m_capacity - m_head;
+    m_head = (offset + size == m_capacity) ? 0 : offset + size;
+    m_used += padding + size;
+    m_pending += padding + size;
+    return offset;
+}
+
+void RingBufferAllocator::Retire(uint64_t fenceValue)
+{
+    if (m_pending == 0)
+    {
+        return;
+    }
+    if (!m_retired.empty() && m_retired.back().fenceValue > fenceValue)
+    {
+        throw std::runtime_error("Ring buffer retired with a decreasing fence value");
+    }
+    m_retired.push_back({ fenceValue, m_pending });
+    m_pending = 0;
+}
+
+void RingBufferAllocator::Release(uint64_t completedFenceValue)
+{
+    while (!m_retired.empty() && m_retired.front().fenceValue <= completedFenceValue)
+    {
+        const uint64_t bytes = m_retired.front().bytes;
+        m_tail = (m_tail + bytes) % m_capacity;
+        m_used -= bytes;
+        m_retired.pop_front();
+    }
+}
+
+void RingBufferAllocator::Extend(uint64_t offset, uint64_t fenceValue)
+{
+    // Blocks are contiguous from the tail, find the one that covers offset
+    const uint64_t distance = (offset >= m_tail) ? offset - m_tail : m_capacity - m_tail + offset;
+    if (offset >= m_capacity || m_used == 0 || distance >= m_used)
+    {
+        throw std::runtime_error("Extending a ring buffer allocation that is not in use");
+    }
+
+    uint64_t blockStart = 0;
+    for (RetiredBlock& block : m_retired)
+    {
+        if (distance < blockStart + block.bytes)
+        {
+            block.fenceValue = std::max(block.fenceValue, fenceValue);
+            return;
+        }
+        blockStart += block.bytes;
+    }
+}
+
+bool RingBufferAllocator::GetOldestFenceValue(uint64_t& fenceValue) const
+{
+    if (m_retired.empty())
+    {
+        return false;
+    }
+    fenceValue = m_retired.front().fenceValue;
+    return true;
+}
+
+void WriteTextureUploadReport(std::ostream& out, uint32_t width, uint32_t height, uint32_t textures, uint32_t framesInFlight, uint64_t seed, WorkStealingThreadPool* pool)
+{
+    // D3D12_TEXTURE_DATA_PITCH_ALIGNMENT and D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT
+    const uint64_t PitchAlignment = 256;
+    const uint64_t PlacementAlignment = 512;
+    const uint64_t capacity = 64ull << 20;
+    const uint64_t rowPitch = (width + PitchAlignment - 1) / PitchAlignment * PitchAlignment;
+    const uint64_t footprintBytes = rowPitch * (height - 1) + width;
+    if (height == 0 || footprintBytes > capacity)
+    {
+        throw std::runtime_error("Texture does not fit the upload ring");
+    }
+
+    // Stand-in for the mapped upload heap
+    std::unique_ptr<uint8_t[]> memory(new uint8_t[capacity]);
+    const TextureDistributionParams params = MakeTextureDistributionParams(TextureDistribution::Uniform, width, height);
+
+    auto runUploads = [&](bool inPlace)
+    {
+        RingBufferAllocator ring(capacity);
+        uint64_t frame = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < textures; ++i)
+        {
+            // Frame n is released once frame n - framesInFlight has completed
+            uint64_t offset = ring.Allocate(footprintBytes, PlacementAlignment);
+            while (offset == InvalidRingOffset)
+            {
+                uint64_t fenceValue = 0;
+                if (!ring.GetOldestFenceValue(fenceValue))
+                {
+                    throw std::runtime_error("Upload ring is full of allocations that were never retired");
+                }
+                ring.Release(fenceValue);
+                offset = ring.Allocate(footprintBytes, PlacementAlignment);
+            }
+
+            uint8_t* destination = memory.get() + offset;
+            if (inPlace)
+            {
+                GenerateDistributionTexture(seed + i, params, destination, rowPitch, true, pool);
+            }
+            else
+            {
+                const std::vector<uint8_t> texels = GenerateDistributionTextureData(seed + i, params, pool);
+                CopyTextureRows(destination, rowPitch, texels.data(), width, width, height, false);
+            }
+
+            ring.Retire(++frame);
+            if (frame > framesInFlight)
+            {
+                ring.Release(frame - framesInFlight);
+            }
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    };
+
+    const double stagedSeconds = runUploads(false);
+    const double inPlaceSeconds = runUploads(true);
+    const double gigabytes = static_cast<double>(width) * height * textures / 1e9;
+    out << "Texture upload, " << textures << " " << width << "x" << height << " R8 textures, " << framesInFlight << " frames in flight, seed " << seed << std::endl;
+    out << "  staged copy: " << gigabytes / std::max(stagedSeconds, 1e-9) << " GB/s, in place: " << gigabytes / std::max(inPlaceSeconds, 1e-9) << " GB/s" << std::endl;
+}
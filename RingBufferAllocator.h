@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <ostream>
+
+class WorkStealingThreadPool;
+
+// Byte ring for per-submission data in a buffer, independent of D3D12: offsets only, UploadRingBuffer.h
+// maps them into a persistently mapped upload buffer. Works like DescriptorRingAllocator with 64 bit
+// sizes and an alignment per allocation; Retire tags everything allocated since the previous Retire
+// with a fence value and Release returns it once the fence has reached that value. An allocation never
+// wraps: a ring tail that is too short is skipped, alignment padding is released with the allocation.
+
+const uint64_t InvalidRingOffset = ~0ull;
+
+class RingBufferAllocator
+{
+public:
+    explicit RingBufferAllocator(uint64_t capacity);
+
+    // Offset of size bytes at a multiple of alignment, InvalidRingOffset while the ring is too full
+    uint64_t Allocate(uint64_t size, uint64_t alignment = 1);
+    // Fence values have to be passed in increasing order
+    void Retire(uint64_t fenceValue);
+    void Release(uint64_t completedFenceValue);
+    // Keeps the allocation at offset until fenceValue as well, for data that several submissions read.
+    // Raises the fence value of its retired block, an allocation that is not retired yet is tagged by the
+    // next Retire. Blocks are still released in ring order, so newer blocks wait behind an extended one.
+    void Extend(uint64_t offset, uint64_t fenceValue);
+
+    // Fence value the oldest retired allocations wait for, false when nothing is retired
+    bool GetOldestFenceValue(uint64_t& fenceValue) const;
+
+    uint64_t GetCapacity() const { return m_capacity; }
+    uint64_t GetUsedBytes() const { return m_used; }
+
+private:
+    struct RetiredBlock
+    {
+        uint64_t fenceValue;
+        uint64_t bytes;         // including padding and skipped tails
+    };
+
+    uint64_t m_capacity;
+    uint64_t m_head = 0;        // next allocation
+    uint64_t m_tail = 0;        // oldest byte in use
+    uint64_t m_used = 0;
+    uint64_t m_pending = 0;     // allocated since the last Retire
+    std::deque<RetiredBlock> m_retired;
+};
+
+// Host side of a texture upload, no device needed: width x height R8 textures of a seeded distribution
+// go into a 64 MB ring with D3D12 copy footprints (256 byte rows, 512 byte placement) and framesInFlight
+// frames in flight. Compares generating into a vector and copying the rows into the ring with generating
+// straight into the ring with streaming stores, written as GB/s of texels.
+void WriteTextureUploadReport(std::ostream& out, uint32_t width, uint32_t height, uint32_t textures, uint32_t framesInFlight, uint64_t seed, WorkStealingThreadPool* pool);
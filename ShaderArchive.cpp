@@ -0,0 +1,142 @@
+#include "ShaderArchive.h"
+#include "HashUtils.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+namespace
+{
+    bool PermutationLess(ShaderKernel kernelA, uint32_t sizeA, ShaderKernel kernelB, uint32_t sizeB)
+    {
+        return kernelA != kernelB ? kernelA < kernelB : sizeA < sizeB;
+    }
+}
+
+ShaderArchive::ShaderArchive(const std::string& filename)
+    : m_filename(filename)
+    , m_file(filename)
+{
+    const uint8_t* data = m_file.Data();
+    const size_t size = m_file.Size();
+
+    ShaderArchiveHeader header;
+    if (size < sizeof(header))
+    {
+        throw std::runtime_error("Truncated shader archive " + filename);
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != ShaderArchiveMagic || header.version != ShaderArchiveVersion)
+    {
+        throw std::runtime_error("Not a version " + std::to_string(ShaderArchiveVersion) + " shader archive: " + filename);
+    }
+    if (header.entryCount > (size - sizeof(header)) / sizeof(ShaderArchiveEntry))
+    {
+        throw std::runtime_error("Truncated shader archive index in " + filename);
+    }
+
+    // The mapping is page aligned and the header is 16 bytes, so the index can be read in place
+    m_entries = reinterpret_cast<const ShaderArchiveEntry*>(data + sizeof(header));
+    m_permutations.reserve(header.entryCount);
+    for (uint32_t i = 0; i < header.entryCount; ++i)
+    {
+        const ShaderArchiveEntry& entry = m_entries[i];
+        if (entry.offset > size || entry.size > size - entry.offset)
+        {
+            throw std::runtime_error("Shader archive entry " + std::to_string(i) + " lies outside " + filename);
+        }
+        if (i > 0 && !PermutationLess(m_permutations.back().kernel, m_permutations.back().threadGroupSize, static_cast<ShaderKernel>(entry.kernel), entry.threadGroupSize))
+        {
+            throw std::runtime_error("Unsorted shader archive index in " + filename);
+        }
+        m_permutations.push_back({ static_cast<ShaderKernel>(entry.kernel), entry.threadGroupSize, data + entry.offset, static_cast<size_t>(entry.size) });
+    }
+
+    m_verifyStates.reset(new std::atomic<uint8_t>[m_permutations.size()]);
+    for (size_t i = 0; i < m_permutations.size(); ++i)
+    {
+        m_verifyStates[i].store(Unverified, std::memory_order_relaxed);
+    }
+}
+
+const ShaderPermutation* ShaderArchive::Find(ShaderKernel kernel, uint32_t threadGroupSize)
+{
+    auto it = std::lower_bound(m_permutations.begin(), m_permutations.end(), kernel,
+        [threadGroupSize](const ShaderPermutation& permutation, ShaderKernel key)
+        {
+            return PermutationLess(permutation.kernel, permutation.threadGroupSize, key, threadGroupSize);
+        });
+    if (it == m_permutations.end() || it->kernel != kernel || it->threadGroupSize != threadGroupSize)
+    {
+        return nullptr;
+    }
+
+    // Racing first lookups both hash the blob and store the same state
+    const size_t index = static_cast<size_t>(it - m_permutations.begin());
+    uint8_t state = m_verifyStates[index].load(std::memory_order_acquire);
+    if (state == Unverified)
+    {
+        state = (HashBytes(it->bytecode, it->bytecodeSize) == m_entries[index].hash) ? Verified : Corrupt;
+        m_verifyStates[index].store(state, std::memory_order_release);
+    }
+    if (state == Corrupt)
+    {
+        throw std::runtime_error(std::string("Corrupt ") + GetShaderKernelName(kernel) + " permutation for thread group size " +
+            std::to_string(threadGroupSize) + " in " + m_filename);
+    }
+    return &*it;
+}
+
+void WriteShaderArchive(const std::string& filename, std::vector<ShaderPermutation> permutations)
+{
+    std::sort(permutations.begin(), permutations.end(), [](const ShaderPermutation& a, const ShaderPermutation& b)
+        {
+            return PermutationLess(a.kernel, a.threadGroupSize, b.kernel, b.threadGroupSize);
+        });
+    for (size_t i = 1; i < permutations.size(); ++i)
+    {
+        if (permutations[i].kernel == permutations[i - 1].kernel && permutations[i].threadGroupSize == permutations[i - 1].threadGroupSize)
+        {
+            throw std::runtime_error(std::string("Duplicate ") + GetShaderKernelName(permutations[i].kernel) + " permutation for thread group size " +
+                std::to_string(permutations[i].threadGroupSize));
+        }
+    }
+
+    ShaderArchiveHeader header = {};
+    header.magic = ShaderArchiveMagic;
+    header.version = ShaderArchiveVersion;
+    header.entryCount = static_cast<uint32_t>(permutations.size());
+
+    std::vector<ShaderArchiveEntry> entries(permutations.size());
+    uint64_t offset = sizeof(header) + entries.size() * sizeof(ShaderArchiveEntry);
+    for (size_t i = 0; i < permutations.size(); ++i)
+    {
+        offset = (offset + ShaderArchiveAlignment - 1) / ShaderArchiveAlignment * ShaderArchiveAlignment;
+        entries[i].kernel = static_cast<uint32_t>(permutations[i].kernel);
+        entries[i].threadGroupSize = permutations[i].threadGroupSize;
+        entries[i].offset = offset;
+        entries[i].size = permutations[i].bytecodeSize;
+        entries[i].hash = HashBytes(permutations[i].bytecode, permutations[i].bytecodeSize);
+        offset += permutations[i].bytecodeSize;
+    }
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open())
+    {
+        throw std::runtime_error("Failed to open " + filename + " for writing");
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(ShaderArchiveEntry)));
+    uint64_t written = sizeof(header) + entries.size() * sizeof(ShaderArchiveEntry);
+    const char padding[ShaderArchiveAlignment] = {};
+    for (size_t i = 0; i < permutations.size(); ++i)
+    {
+        file.write(padding, static_cast<std::streamsize>(entries[i].offset - written));
+        file.write(reinterpret_cast<const char*>(permutations[i].bytecode), static_cast<std::streamsize>(permutations[i].bytecodeSize));
+        written = entries[i].offset + entries[i].size;
+    }
+    if (!file)
+    {
+        throw std::runtime_error("Failed to write " + filename);
+    }
+}
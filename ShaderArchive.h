@@ -0,0 +1,75 @@
+#pragma once
+
+#include "MappedFile.h"
+#include "ShaderPermutations.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Packed archive of shader permutations, memory mapped as a whole. The permutations it hands out point
+// straight into the mapping, nothing is copied or allocated per shader.
+//
+// Layout, little endian: a ShaderArchiveHeader, entryCount ShaderArchiveEntry records sorted by
+// (kernel, threadGroupSize), then the bytecode blobs, each at a ShaderArchiveAlignment aligned offset.
+// Opening only checks the header and that every entry lies inside the file; the hash of a blob is
+// checked the first time it is looked up, so startup does not touch the bytecode.
+
+const uint32_t ShaderArchiveMagic = 0x41485352;     // "RSHA"
+const uint32_t ShaderArchiveVersion = 1;
+const uint32_t ShaderArchiveAlignment = 16;
+
+struct ShaderArchiveHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t entryCount;
+    uint32_t reserved;
+};
+static_assert(sizeof(ShaderArchiveHeader) == 16, "ShaderArchiveHeader is a file format");
+
+struct ShaderArchiveEntry
+{
+    uint32_t kernel;            // ShaderKernel
+    uint32_t threadGroupSize;
+    uint64_t offset;            // from the start of the file
+    uint64_t size;
+    uint64_t hash;              // HashBytes of the bytecode
+};
+static_assert(sizeof(ShaderArchiveEntry) == 32, "ShaderArchiveEntry is a file format");
+
+class ShaderArchive
+{
+public:
+    // Throws if the file cannot be mapped or its header or index is malformed
+    explicit ShaderArchive(const std::string& filename);
+
+    ShaderArchive(const ShaderArchive&) = delete;
+    ShaderArchive& operator=(const ShaderArchive&) = delete;
+
+    // nullptr when the archive has no such permutation, throws when its bytecode fails the hash check.
+    // The result lives as long as the archive.
+    const ShaderPermutation* Find(ShaderKernel kernel, uint32_t threadGroupSize);
+
+    size_t GetPermutationCount() const { return m_permutations.size(); }
+    const std::string& GetFilename() const { return m_filename; }
+
+private:
+    enum VerifyState : uint8_t
+    {
+        Unverified,
+        Verified,
+        Corrupt
+    };
+
+    std::string m_filename;
+    MappedFile m_file;
+    const ShaderArchiveEntry* m_entries = nullptr;
+    std::vector<ShaderPermutation> m_permutations;
+    std::unique_ptr<std::atomic<uint8_t>[]> m_verifyStates;
+};
+
+// Packs permutations (e.g. the embedded ones, or .cso files read from disk) into an archive
+void WriteShaderArchive(const std::string& filename, std::vector<ShaderPermutation> permutations);
@@ -0,0 +1,306 @@
+#include "ShaderCompileCache.h"
+#include "HashUtils.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Strings are hashed with their length so ("ab", "c") and ("a", "bc") differ
+    uint64_t HashString(const std::string& text, uint64_t hash)
+    {
+        const uint64_t size = text.size();
+        hash = HashBytes(&size, sizeof(size), hash);
+        return HashBytes(text.data(), text.size(), hash);
+    }
+
+    bool ReadTextFile(const fs::path& path, std::string& text)
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            return false;
+        }
+        std::ostringstream contents;
+        contents << file.rdbuf();
+        text = contents.str();
+        return true;
+    }
+
+    // Name of an #include "name" or #include <name> directive, empty for any other line
+    std::string GetIncludeName(const std::string& line)
+    {
+        size_t pos = line.find_first_not_of(" \t");
+        if (pos == std::string::npos || line[pos] != '#')
+        {
+            return std::string();
+        }
+        pos = line.find_first_not_of(" \t", pos + 1);
+        if (pos == std::string::npos || line.compare(pos, 7, "include") != 0)
+        {
+            return std::string();
+        }
+        pos = line.find_first_not_of(" \t", pos + 7);
+        if (pos == std::string::npos || (line[pos] != '"' && line[pos] != '<'))
+        {
+            return std::string();
+        }
+        const char close = (line[pos] == '"') ? '"' : '>';
+        const size_t end = line.find(close, pos + 1);
+        if (end == std::string::npos)
+        {
+            return std::string();
+        }
+        return line.substr(pos + 1, end - pos - 1);
+    }
+
+    // Hashes text and, depth first, every file it includes. Includes inside inactive #if blocks are
+    // hashed too, that only costs a spurious miss. A missing include is hashed by name, the compiler
+    // reports it.
+    uint64_t HashSourceTree(const fs::path& path, const std::string& text, std::set<fs::path>& visited, uint64_t hash)
+    {
+        hash = HashString(text, hash);
+
+        std::istringstream lines(text);
+        std::string line;
+        while (std::getline(lines, line))
+        {
+            const std::string name = GetIncludeName(line);
+            if (name.empty())
+            {
+                continue;
+            }
+            hash = HashString(name, hash);
+
+            const fs::path includePath = (path.parent_path() / name).lexically_normal();
+            if (!visited.insert(includePath).second)
+            {
+                continue;
+            }
+            std::string includeText;
+            if (ReadTextFile(includePath, includeText))
+            {
+                hash = HashSourceTree(includePath, includeText, visited, hash);
+            }
+            else
+            {
+                hash = HashString("<missing>", hash);
+            }
+        }
+        return hash;
+    }
+
+    // Unique within the machine, for the temporary file an entry is written to before the rename
+    std::string MakeTemporarySuffix()
+    {
+        static std::atomic<uint64_t> counter{ 0 };
+        const uint64_t thread = std::hash<std::thread::id>{}(std::this_thread::get_id());
+        const uint64_t time = static_cast<uint64_t>(std::chrono::steady_clock::now().time_since_epoch().count());
+        char suffix[64];
+        std::snprintf(suffix, sizeof(suffix), ".%016llx%04llx.tmp",
+            static_cast<unsigned long long>(HashBytes(&time, sizeof(time), thread)),
+            static_cast<unsigned long long>(counter++ & 0xffff));
+        return suffix;
+    }
+}
+
+ShaderCompileCache::ShaderCompileCache(const std::string& directory, uint64_t maxBytes)
+    : m_directory(directory)
+    , m_maxBytes(maxBytes)
+{
+}
+
+std::vector<uint8_t> ShaderCompileCache::Compile(IShaderCompiler& compiler, const ShaderCompileRequest& request, bool* hit)
+{
+    const uint64_t key = ComputeKey(request, compiler.GetIdentity());
+
+    std::vector<uint8_t> bytecode;
+    if (Load(key, bytecode))
+    {
+        if (hit != nullptr)
+        {
+            *hit = true;
+        }
+        return bytecode;
+    }
+
+    bytecode = compiler.Compile(request);
+    Store(key, bytecode);
+    Trim();
+    if (hit != nullptr)
+    {
+        *hit = false;
+    }
+    return bytecode;
+}
+
+uint64_t ShaderCompileCache::ComputeKey(const ShaderCompileRequest& request, const std::string& compilerIdentity) const
+{
+    const fs::path sourcePath = fs::path(request.sourcePath).lexically_normal();
+    std::string source;
+    if (!ReadTextFile(sourcePath, source))
+    {
+        throw std::runtime_error("Failed to read shader source: " + request.sourcePath);
+    }
+
+    uint64_t hash = HashString(compilerIdentity, HashBytes(nullptr, 0));     // FNV offset basis as seed
+    hash = HashString(request.entryPoint, hash);
+    hash = HashString(request.target, hash);
+    hash = HashBytes(&request.flags, sizeof(request.flags), hash);
+
+    // Defines in the order given, the compiler sees them in that order too
+    const uint64_t defineCount = request.defines.size();
+    hash = HashBytes(&defineCount, sizeof(defineCount), hash);
+    for (const auto& define : request.defines)
+    {
+        hash = HashString(define.first, hash);
+        hash = HashString(define.second, hash);
+    }
+
+    std::set<fs::path> visited = { sourcePath };
+    return HashSourceTree(sourcePath, source, visited, hash);
+}
+
+std::string ShaderCompileCache::GetEntryPath(uint64_t key) const
+{
+    char name[32];
+    std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+    return (fs::path(m_directory) / name).string();
+}
+
+bool ShaderCompileCache::Load(uint64_t key, std::vector<uint8_t>& bytecode)
+{
+    const std::string path = GetEntryPath(key);
+    bool valid = false;
+    {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open())
+        {
+            ++m_stats.misses;
+            return false;
+        }
+
+        std::error_code error;
+        const uint64_t fileSize = fs::file_size(path, error);
+        ShaderCacheEntryHeader header = {};
+        if (!error && fileSize >= sizeof(header) &&
+            file.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+            header.magic == ShaderCacheMagic && header.key == key && header.bytecodeSize == fileSize - sizeof(header))
+        {
+            bytecode.resize(static_cast<size_t>(header.bytecodeSize));
+            valid = file.read(reinterpret_cast<char*>(bytecode.data()), static_cast<std::streamsize>(bytecode.size())) &&
+                HashBytes(bytecode.data(), bytecode.size()) == header.bytecodeHash;
+        }
+    }
+
+    std::error_code error;
+    if (!valid)
+    {
+        ++m_stats.corruptEntries;
+        ++m_stats.misses;
+        bytecode.clear();
+        fs::remove(path, error);
+        return false;
+    }
+
+    // Mark as recently used for Trim
+    fs::last_write_time(path, fs::file_time_type::clock::now(), error);
+    ++m_stats.hits;
+    return true;
+}
+
+void ShaderCompileCache::Store(uint64_t key, const std::vector<uint8_t>& bytecode)
+{
+    std::error_code error;
+    fs::create_directories(m_directory, error);
+
+    const std::string path = GetEntryPath(key);
+    const std::string temporaryPath = path + MakeTemporarySuffix();
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!file.is_open())
+        {
+            return;
+        }
+
+        ShaderCacheEntryHeader header = {};
+        header.magic = ShaderCacheMagic;
+        header.key = key;
+        header.bytecodeSize = bytecode.size();
+        header.bytecodeHash = HashBytes(bytecode.data(), bytecode.size());
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(bytecode.data()), static_cast<std::streamsize>(bytecode.size()));
+        file.close();
+        if (!file)
+        {
+            fs::remove(temporaryPath, error);
+            return;
+        }
+    }
+
+    // Replaces an entry another process stored in the meantime, both hold the same bytecode
+    fs::rename(temporaryPath, path, error);
+    if (error)
+    {
+        fs::remove(temporaryPath, error);
+        return;
+    }
+    ++m_stats.stores;
+}
+
+void ShaderCompileCache::Trim()
+{
+    struct Entry
+    {
+        fs::path path;
+        uint64_t size;
+        fs::file_time_type lastUsed;
+    };
+
+    std::error_code error;
+    std::vector<Entry> entries;
+    uint64_t totalBytes = 0;
+    for (fs::directory_iterator it(m_directory, error), end; !error && it != end; it.increment(error))
+    {
+        if (it->path().extension() != ".bin")
+        {
+            continue;
+        }
+        std::error_code entryError;
+        Entry entry = { it->path(), it->file_size(entryError), it->last_write_time(entryError) };
+        if (entryError)
+        {
+            continue;
+        }
+        totalBytes += entry.size;
+        entries.push_back(entry);
+    }
+    if (totalBytes <= m_maxBytes)
+    {
+        return;
+    }
+
+    std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return a.lastUsed < b.lastUsed; });
+    for (const Entry& entry : entries)
+    {
+        if (totalBytes <= m_maxBytes)
+        {
+            break;
+        }
+        if (fs::remove(entry.path, error))
+        {
+            totalBytes -= entry.size;
+            ++m_stats.evictions;
+        }
+    }
+}
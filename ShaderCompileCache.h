@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Content addressed on-disk cache for runtime shader compilation. Nothing in here knows about
+// D3DCompile: the compiler is an IShaderCompiler, ShaderUtils.h has the D3DCompileFromFile one.
+//
+// The key hashes the compiler identity, entry point, target, flags, defines and the text of the
+// source file together with every file it pulls in through #include "..." (resolved relative to
+// the including file, recursively). Editing any of them gives a new key; stale entries are never
+// invalidated, they age out through the LRU size limit.
+//
+// Every entry is one file <directory>/<key as 16 hex digits>.bin, a ShaderCacheEntryHeader followed by
+// the bytecode. Entries are written to a temporary file and renamed into place, so concurrent
+// processes never see a partial entry. Recency is the file's last write time, refreshed on every hit.
+
+const uint32_t ShaderCacheMagic = 0x31434353;      // "SCC1"
+
+struct ShaderCacheEntryHeader
+{
+    uint32_t magic;
+    uint32_t reserved;
+    uint64_t key;
+    uint64_t bytecodeSize;
+    uint64_t bytecodeHash;  // HashBytes of the bytecode, a mismatch drops the entry
+};
+static_assert(sizeof(ShaderCacheEntryHeader) == 32, "ShaderCacheEntryHeader is a file format");
+
+struct ShaderCompileRequest
+{
+    std::string sourcePath;
+    std::string entryPoint = "CSMain";
+    std::string target = "cs_5_1";
+    std::vector<std::pair<std::string, std::string>> defines;
+    uint32_t flags = 0;     // compiler specific, e.g. D3DCOMPILE_* flags
+};
+
+class IShaderCompiler
+{
+public:
+    virtual ~IShaderCompiler() = default;
+
+    // Compiler name and version, part of the cache key so a compiler update misses the old entries
+    virtual std::string GetIdentity() const = 0;
+
+    // Bytecode for request, throws std::runtime_error with the compiler output on failure
+    virtual std::vector<uint8_t> Compile(const ShaderCompileRequest& request) = 0;
+};
+
+struct ShaderCompileCacheStats
+{
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t stores = 0;
+    uint64_t evictions = 0;
+    uint64_t corruptEntries = 0;    // unreadable or mismatching entries that were dropped
+};
+
+class ShaderCompileCache
+{
+public:
+    static constexpr uint64_t DefaultMaxBytes = 64ull * 1024 * 1024;
+
+    // The directory is created on demand. maxBytes bounds the total size of the entries.
+    explicit ShaderCompileCache(const std::string& directory, uint64_t maxBytes = DefaultMaxBytes);
+
+    // Bytecode for request, from the cache or from compiler (the result is then stored).
+    // hit reports which. Cache I/O errors only cost the cache, compile errors throw.
+    std::vector<uint8_t> Compile(IShaderCompiler& compiler, const ShaderCompileRequest& request, bool* hit = nullptr);
+
+    // Throws if the source file cannot be read
+    uint64_t ComputeKey(const ShaderCompileRequest& request, const std::string& compilerIdentity) const;
+
+    bool Load(uint64_t key, std::vector<uint8_t>& bytecode);
+    void Store(uint64_t key, const std::vector<uint8_t>& bytecode);
+
+    // Removes least recently used entries until the total is within maxBytes
+    void Trim();
+
+    const std::string& GetDirectory() const { return m_directory; }
+    const ShaderCompileCacheStats& GetStats() const { return m_stats; }
+
+private:
+    std::string GetEntryPath(uint64_t key) const;
+
+    std::string m_directory;
+    uint64_t m_maxBytes;
+    ShaderCompileCacheStats m_stats;
+};
@@ -0,0 +1,100 @@
+#include "ShaderPermutations.h"
+#include <stdexcept>
+
+#if defined(_WIN32) && !defined(NO_EMBEDDED_SHADERS)
+// fxc /Fh headers declare "const BYTE g_<name>[]"
+#include <windows.h>
+
+// Generated into $(IntDir)Shaders by the GenerateShaderPermutations target of test1.vcxproj
+#include "ShaderPermutationIncludes.inc"
+
+namespace
+{
+#define SHADER_PERMUTATION(kernel, threadGroupSize, variable) { ShaderKernel::kernel, threadGroupSize, variable, sizeof(variable) },
+    const ShaderPermutation Permutations[] =
+    {
+#include "ShaderPermutationTable.inc"
+    };
+#undef SHADER_PERMUTATION
+    const size_t PermutationCount = sizeof(Permutations) / sizeof(Permutations[0]);
+}
+#else
+namespace
+{
+    // No fxc, no D3D12 backend. NO_EMBEDDED_SHADERS builds (the unit tests) skip the generated table as well.
+    const ShaderPermutation* const Permutations = nullptr;
+    const size_t PermutationCount = 0;
+}
+#endif
+
+const ShaderPermutation* FindShaderPermutation(ShaderKernel kernel, uint32_t threadGroupSize)
+{
+    for (size_t i = 0; i < PermutationCount; ++i)
+    {
+        if (Permutations[i].kernel == kernel && Permutations[i].threadGroupSize == threadGroupSize)
+        {
+            return &Permutations[i];
+        }
+    }
+    return nullptr;
+}
+
+const ShaderPermutation* GetShaderPermutations(size_t& count)
+{
+    count = PermutationCount;
+    return Permutations;
+}
+
+ShaderCompileRequest MakeShaderPermutationRequest(ShaderKernel kernel, uint32_t threadGroupSize, const std::string& sourceDirectory)
+{
+    const char* source = nullptr;
+    switch (kernel)
+    {
+    case ShaderKernel::MaxReduction:
+        source = "CompuetShader.hlsl";
+        break;
+    case ShaderKernel::AtomicMaxReduction:
+        source = "AtomicMaxReduction.hlsl";
+        break;
+    case ShaderKernel::BufferReduction:
+        source = "BufferReduction.hlsl";
+        break;
+    }
+    if (source == nullptr)
+    {
+        throw std::runtime_error("Unknown shader kernel");
+    }
+
+    ShaderCompileRequest request;
+    request.sourcePath = sourceDirectory.empty() ? source : sourceDirectory + "/" + source;
+    request.entryPoint = "CSMain";
+    request.target = "cs_5_1";
+    request.defines.push_back({ "THREAD_GROUP_SIZE", std::to_string(threadGroupSize) });
+    return request;
+}
+
+const char* GetShaderKernelName(ShaderKernel kernel)
+{
+    switch (kernel)
+    {
+    case ShaderKernel::MaxReduction:
+        return "MaxReduction";
+    case ShaderKernel::AtomicMaxReduction:
+        return "AtomicMaxReduction";
+    case ShaderKernel::BufferReduction:
+        return "BufferReduction";
+    }
+    return "unknown";
+}
+
+ShaderKernel ParseShaderKernel(const std::string& name)
+{
+    for (ShaderKernel kernel : { ShaderKernel::MaxReduction, ShaderKernel::AtomicMaxReduction, ShaderKernel::BufferReduction })
+    {
+        if (name == GetShaderKernelName(kernel))
+        {
+            return kernel;
+        }
+    }
+    throw std::runtime_error("Unknown shader kernel: " + name);
+}
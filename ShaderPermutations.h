@@ -0,0 +1,44 @@
+#pragma once
+
+#include "ShaderCompileCache.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Compute shader bytecode embedded in the binary.
+//
+// The permutations are declared once, as ShaderPermutation items in test1.vcxproj (source, kernel,
+// thread group size). The GenerateShaderPermutations target compiles each one with fxc, passing the
+// group size as /D THREAD_GROUP_SIZE=<n>, into a header holding the bytecode as a byte array, and
+// writes the lookup table below from the same items. Startup reads no shader files unless a
+// ShaderArchive (ShaderArchive.h) is deployed next to the binary to replace them.
+
+enum class ShaderKernel
+{
+    MaxReduction,           // CompuetShader.hlsl
+    AtomicMaxReduction,     // AtomicMaxReduction.hlsl
+    BufferReduction         // BufferReduction.hlsl, built for BufferReductionGroupSize only
+};
+
+struct ShaderPermutation
+{
+    ShaderKernel kernel;
+    uint32_t threadGroupSize;
+    const unsigned char* bytecode;
+    size_t bytecodeSize;
+};
+
+// nullptr when the permutation is not in the table (always on platforms without fxc)
+const ShaderPermutation* FindShaderPermutation(ShaderKernel kernel, uint32_t threadGroupSize);
+
+// Every embedded permutation, count receives the number of entries
+const ShaderPermutation* GetShaderPermutations(size_t& count);
+
+// Runtime compile of a permutation that is neither embedded nor archived: the kernel's HLSL source in
+// sourceDirectory with the options of the GenerateShaderPermutations target (cs_5_1, CSMain,
+// THREAD_GROUP_SIZE=threadGroupSize)
+ShaderCompileRequest MakeShaderPermutationRequest(ShaderKernel kernel, uint32_t threadGroupSize, const std::string& sourceDirectory);
+
+const char* GetShaderKernelName(ShaderKernel kernel);
+// Inverse of GetShaderKernelName, throws on unknown names
+ShaderKernel ParseShaderKernel(const std::string& name);
@@ -5,6 +5,8 @@
 #include <d3dcompiler.h>
 #include <wrl.h>
 #include <stdexcept>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <vector>
 
@@ -39,25 +41,30 @@ ComPtr<ID3DBlob> LoadCompiledShader(const std::wstring& filename)
     return shaderBlob;
 }
 
-ComPtr<ID3DBlob> CompileComputeShader(const std::wstring& shaderPath)
+std::string D3DShaderCompiler::GetIdentity() const
+{
+    return "d3dcompiler_" + std::to_string(D3D_COMPILER_VERSION);
+}
+
+std::vector<uint8_t> D3DShaderCompiler::Compile(const ShaderCompileRequest& request)
 {
     ComPtr<ID3DBlob> computeShader;
     ComPtr<ID3DBlob> errorBlob;
 
-#if defined(_DEBUG)
-    // Enable better shader debugging with the graphics debugging tools.
-    UINT compileFlags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION | D3DCOMPILE_ENABLE_STRICTNESS;
-#else
-    UINT compileFlags = 0;
-#endif
+    std::vector<D3D_SHADER_MACRO> macros;
+    for (const auto& define : request.defines)
+    {
+        macros.push_back({ define.first.c_str(), define.second.c_str() });
+    }
+    macros.push_back({ nullptr, nullptr });
 
     HRESULT hr = D3DCompileFromFile(
-        shaderPath.c_str(),    // Path to the shader file
-        nullptr,               // Optional macros
+        std::filesystem::path(request.sourcePath).wstring().c_str(),    // Path to the shader file
+        macros.data(),         // Optional macros
         D3D_COMPILE_STANDARD_FILE_INCLUDE,               // Optional include handler
-        "CSMain",              // Entry point function name
-        "cs_5_0",              // Target shader model
-        compileFlags,                     // Compile options
+        request.entryPoint.c_str(),     // Entry point function name
+        request.target.c_str(),         // Target shader model
+        request.flags,         // Compile options
         0,                     // Effect compile options
         &computeShader,        // Compiled shader
         &errorBlob             // Error messages
@@ -70,9 +77,37 @@ ComPtr<ID3DBlob> CompileComputeShader(const std::wstring& shaderPath)
         {
             std::cerr << static_cast<char*>(errorBlob->GetBufferPointer()) << std::endl;
         }
-        throw std::runtime_error("Failed to compile compute shader");
+        throw std::runtime_error("Failed to compile compute shader: " + request.sourcePath);
     }
 
+    const uint8_t* bytecode = static_cast<const uint8_t*>(computeShader->GetBufferPointer());
+    return std::vector<uint8_t>(bytecode, bytecode + computeShader->GetBufferSize());
+}
+
+ComPtr<ID3DBlob> CompileComputeShader(const std::wstring& shaderPath)
+{
+    ShaderCompileRequest request;
+    request.sourcePath = std::filesystem::path(shaderPath).string();
+    request.target = "cs_5_0";
+#if defined(_DEBUG)
+    // Enable better shader debugging with the graphics debugging tools.
+    request.flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION | D3DCOMPILE_ENABLE_STRICTNESS;
+#endif
+    return CompileComputeShader(request, nullptr);
+}
+
+ComPtr<ID3DBlob> CompileComputeShader(const ShaderCompileRequest& request, ShaderCompileCache* cache)
+{
+    D3DShaderCompiler compiler;
+    const std::vector<uint8_t> bytecode = cache ? cache->Compile(compiler, request) : compiler.Compile(request);
+
+    ComPtr<ID3DBlob> computeShader;
+    HRESULT hr = D3DCreateBlob(bytecode.size(), &computeShader);
+    if (FAILED(hr))
+    {
+        throw std::runtime_error("Failed to create shader blob");
+    }
+    memcpy(computeShader->GetBufferPointer(), bytecode.data(), bytecode.size());
     return computeShader;
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "ShaderCompileCache.h"
 #include <d3d12.h>
 #include <d3dcompiler.h>
 #include <wrl.h>
@@ -7,5 +8,15 @@
 
 using namespace Microsoft::WRL;
 
+// IShaderCompiler on D3DCompileFromFile, includes resolved with D3D_COMPILE_STANDARD_FILE_INCLUDE
+class D3DShaderCompiler : public IShaderCompiler
+{
+public:
+    std::string GetIdentity() const override;
+    std::vector<uint8_t> Compile(const ShaderCompileRequest& request) override;
+};
+
 ComPtr<ID3DBlob> CompileComputeShader(const std::wstring & shaderPath);
+// With a cache only the first compile of a given source, include set and options reaches the compiler
+ComPtr<ID3DBlob> CompileComputeShader(const ShaderCompileRequest& request, ShaderCompileCache* cache);
 ComPtr<ID3DBlob> LoadCompiledShader(const std::wstring& filename);
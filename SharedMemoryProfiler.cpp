@@ -0,0 +1,175 @@
+#include "SharedMemoryProfiler.h"
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+
+void SharedMemoryProfile::Merge(const SharedMemoryProfile& other)
+{
+    groups += other.groups;
+    barriers += other.barriers;
+    if (phases.size() < other.phases.size())
+    {
+        phases.resize(other.phases.size());
+    }
+    for (size_t i = 0; i < other.phases.size(); ++i)
+    {
+        SharedMemoryPhaseStats& phase = phases[i];
+        const SharedMemoryPhaseStats& otherPhase = other.phases[i];
+        phase.lanes += otherPhase.lanes;
+        phase.activeLanes += otherPhase.activeLanes;
+        phase.accesses += otherPhase.accesses;
+        phase.waveAccesses += otherPhase.waveAccesses;
+        phase.conflictReplays += otherPhase.conflictReplays;
+        phase.maxConflictDegree = std::max(phase.maxConflictDegree, otherPhase.maxConflictDegree);
+        phase.endsWithBarrier = phase.endsWithBarrier || otherPhase.endsWithBarrier;
+    }
+}
+
+SharedMemoryProfiler::SharedMemoryProfiler(const SharedMemoryBankConfig& config)
+{
+    if (config.bankCount == 0 || config.bankWidthBytes == 0 || config.waveSize == 0)
+    {
+        throw std::runtime_error("Invalid shared memory bank configuration");
+    }
+    m_profile.config = config;
+}
+
+void SharedMemoryProfiler::BeginGroup()
+{
+    m_phaseIndex = 0;
+}
+
+void SharedMemoryProfiler::EndGroup()
+{
+    ++m_profile.groups;
+}
+
+void SharedMemoryProfiler::BeginPhase(uint32_t laneCount)
+{
+    if (m_laneAccesses.size() < laneCount)
+    {
+        m_laneAccesses.resize(laneCount);
+    }
+    for (uint32_t lane = 0; lane < laneCount; ++lane)
+    {
+        m_laneAccesses[lane].clear();
+    }
+    if (m_profile.phases.size() <= m_phaseIndex)
+    {
+        m_profile.phases.resize(m_phaseIndex + 1);
+    }
+    m_profile.phases[m_phaseIndex].lanes += laneCount;
+    m_phaseLaneCount = laneCount;
+    m_inPhase = true;
+}
+
+void SharedMemoryProfiler::RecordAccess(uint32_t lane, uint32_t byteAddress)
+{
+    if (m_inPhase && lane < m_phaseLaneCount)
+    {
+        m_laneAccesses[lane].push_back(byteAddress);
+    }
+}
+
+void SharedMemoryProfiler::EndPhase()
+{
+    const SharedMemoryBankConfig& config = m_profile.config;
+    SharedMemoryPhaseStats& phase = m_profile.phases[m_phaseIndex];
+    const uint32_t lanes = m_phaseLaneCount;
+
+    size_t maxAccessesPerLane = 0;
+    for (uint32_t lane = 0; lane < lanes; ++lane)
+    {
+        const std::vector<uint32_t>& accesses = m_laneAccesses[lane];
+        if (!accesses.empty())
+        {
+            ++phase.activeLanes;
+            phase.accesses += accesses.size();
+            maxAccessesPerLane = std::max(maxAccessesPerLane, accesses.size());
+        }
+    }
+
+    // The n-th access of each lane in a wave is one instruction
+    std::vector<uint32_t> words;
+    std::vector<uint32_t> wordsPerBank(config.bankCount);
+    for (size_t slot = 0; slot < maxAccessesPerLane; ++slot)
+    {
+        for (uint32_t waveStart = 0; waveStart < lanes; waveStart += config.waveSize)
+        {
+            words.clear();
+            const uint32_t waveEnd = std::min(waveStart + config.waveSize, lanes);
+            for (uint32_t lane = waveStart; lane < waveEnd; ++lane)
+            {
+                if (slot < m_laneAccesses[lane].size())
+                {
+                    words.push_back(m_laneAccesses[lane][slot] / config.bankWidthBytes);
+                }
+            }
+            if (words.empty())
+            {
+                continue;
+            }
+
+            // Lanes reading the same word are served by one broadcast
+            std::sort(words.begin(), words.end());
+            words.erase(std::unique(words.begin(), words.end()), words.end());
+            std::fill(wordsPerBank.begin(), wordsPerBank.end(), 0);
+            uint32_t degree = 0;
+            for (uint32_t word : words)
+            {
+                degree = std::max(degree, ++wordsPerBank[word % config.bankCount]);
+            }
+
+            ++phase.waveAccesses;
+            phase.conflictReplays += degree - 1;
+            phase.maxConflictDegree = std::max(phase.maxConflictDegree, degree);
+        }
+    }
+
+    ++m_phaseIndex;
+    m_inPhase = false;
+}
+
+void SharedMemoryProfiler::OnBarrier()
+{
+    ++m_profile.barriers;
+    if (m_phaseIndex > 0)
+    {
+        m_profile.phases[m_phaseIndex - 1].endsWithBarrier = true;
+    }
+}
+
+void WriteSharedMemoryProfileReport(std::ostream& out, const std::string& variantName, const SharedMemoryProfile& profile)
+{
+    const SharedMemoryBankConfig& config = profile.config;
+    out << "Variant: " << variantName << " (" << config.bankCount << " banks x " << config.bankWidthBytes << " bytes, wave " << config.waveSize << ")" << std::endl;
+    out << "Groups: " << profile.groups << "  Barriers per group: " << (profile.groups ? profile.barriers / profile.groups : 0) << std::endl;
+    out << std::left << std::setw(6) << "Step" << std::setw(14) << "ActiveLanes" << std::setw(12) << "Accesses"
+        << std::setw(14) << "WaveAccesses" << std::setw(12) << "Replays" << std::setw(10) << "MaxWay" << "Barrier" << std::endl;
+
+    SharedMemoryPhaseStats total;
+    for (size_t i = 0; i < profile.phases.size(); ++i)
+    {
+        const SharedMemoryPhaseStats& phase = profile.phases[i];
+        double activePercent = phase.lanes ? (100.0 * phase.activeLanes) / phase.lanes : 0.0;
+        out << std::left << std::setw(6) << i
+            << std::setw(14) << (std::to_string(static_cast<int>(activePercent + 0.5)) + "%")
+            << std::setw(12) << phase.accesses
+            << std::setw(14) << phase.waveAccesses
+            << std::setw(12) << phase.conflictReplays
+            << std::setw(10) << phase.maxConflictDegree
+            << (phase.endsWithBarrier ? "yes" : "no") << std::endl;
+
+        total.lanes += phase.lanes;
+        total.activeLanes += phase.activeLanes;
+        total.accesses += phase.accesses;
+        total.waveAccesses += phase.waveAccesses;
+        total.conflictReplays += phase.conflictReplays;
+        total.maxConflictDegree = std::max(total.maxConflictDegree, phase.maxConflictDegree);
+    }
+
+    double activePercent = total.lanes ? (100.0 * total.activeLanes) / total.lanes : 0.0;
+    out << "Total: lane utilization " << activePercent << "%, " << total.accesses << " accesses, "
+        << total.waveAccesses << " wave accesses, " << total.conflictReplays << " conflict replays, max "
+        << total.maxConflictDegree << "-way" << std::endl;
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+// Groupshared memory cost model for kernels running in the ComputeEmulator.
+//
+// Every ForEachThread phase records the groupshared byte addresses touched by each lane. The n-th
+// access of every lane is treated as one wave-wide instruction; lanes of a wave that hit different
+// 4 byte words in the same bank serialize (same word is a broadcast). This ranks reduction variants
+// by barriers, idle lanes and bank conflicts without a GPU.
+
+struct SharedMemoryBankConfig
+{
+    uint32_t bankCount = 32;
+    uint32_t bankWidthBytes = 4;
+    uint32_t waveSize = 32;
+};
+
+// One barrier-free step of the kernel, summed over all thread groups
+struct SharedMemoryPhaseStats
+{
+    uint64_t lanes = 0;                 // threads that executed the phase
+    uint64_t activeLanes = 0;           // threads that touched groupshared memory
+    uint64_t accesses = 0;              // per-lane loads and stores
+    uint64_t waveAccesses = 0;          // wave-wide access instructions
+    uint64_t conflictReplays = 0;       // extra passes caused by bank conflicts
+    uint32_t maxConflictDegree = 0;     // worst number of distinct words in one bank
+    bool endsWithBarrier = false;
+};
+
+struct SharedMemoryProfile
+{
+    SharedMemoryBankConfig config;
+    uint64_t groups = 0;
+    uint64_t barriers = 0;
+    std::vector<SharedMemoryPhaseStats> phases;
+
+    void Merge(const SharedMemoryProfile& other);
+};
+
+class SharedMemoryProfiler
+{
+public:
+    explicit SharedMemoryProfiler(const SharedMemoryBankConfig& config);
+
+    void BeginGroup();
+    void EndGroup();
+    void BeginPhase(uint32_t laneCount);
+    void RecordAccess(uint32_t lane, uint32_t byteAddress);
+    void EndPhase();
+    void OnBarrier();
+
+    const SharedMemoryProfile& GetProfile() const { return m_profile; }
+
+private:
+    SharedMemoryProfile m_profile;
+    std::vector<std::vector<uint32_t>> m_laneAccesses;
+    size_t m_phaseIndex = 0;
+    uint32_t m_phaseLaneCount = 0;
+    bool m_inPhase = false;
+};
+
+// Per-step table plus totals for one kernel variant
+void WriteSharedMemoryProfileReport(std::ostream& out, const std::string& variantName, const SharedMemoryProfile& profile);
@@ -0,0 +1,448 @@
+#include "SimdReduction.h"
+#include "SimdTarget.h"
+#include <algorithm>
+#include <climits>
+#include <stdexcept>
+
+namespace
+{
+    template <typename T>
+    inline void ReduceRowScalar(const T* row, uint32_t begin, uint32_t end, uint32_t& minValue, uint32_t& maxValue)
+    {
+        for (uint32_t x = begin; x < end; ++x)
+        {
+            uint32_t value = row[x];
+            minValue = std::min(minValue, value);
+            maxValue = std::max(maxValue, value);
+        }
+    }
+
+    // Lanes that never saw a texel still hold the identity value, which never wins
+    template <typename T>
+    inline void FoldLanes(const T* minLanes, const T* maxLanes, uint32_t lanes, MinMaxResult& result)
+    {
+        for (uint32_t i = 0; i < lanes; ++i)
+        {
+            result.minValue = std::min<uint32_t>(result.minValue, minLanes[i]);
+            result.maxValue = std::max<uint32_t>(result.maxValue, maxLanes[i]);
+        }
+    }
+
+    template <typename T>
+    MinMaxResult ReduceScalar(const uint8_t* base, uint32_t width, uint32_t height, size_t rowPitch)
+    {
+        MinMaxResult result = { UINT32_MAX, 0 };
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            ReduceRowScalar(reinterpret_cast<const T*>(base + y * rowPitch), 0, width, result.minValue, result.maxValue);
+        }
+        return result;
+    }
+
+#if SIMD_X86
+    // 8 bytes into both halves of the register, the copy does not change a min or max
+    SIMD_TARGET_SSE2 inline __m128i LoadLow64(const void* p)
+    {
+        const __m128i low = _mm_loadl_epi64(static_cast<const __m128i*>(p));
+        return _mm_unpacklo_epi64(low, low);
+    }
+
+    // SSE2 has unsigned min/max only for 8 bit lanes, 16 and 32 bit values are biased into signed range
+    struct Sse2U8
+    {
+        using Element = uint8_t;
+        SIMD_TARGET_SSE2 static __m128i Load(const Element* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+        SIMD_TARGET_SSE2 static __m128i LoadHalf(const Element* p) { return LoadLow64(p); }
+        SIMD_TARGET_SSE2 static __m128i InitMin() { return _mm_set1_epi8(-1); }
+        SIMD_TARGET_SSE2 static __m128i InitMax() { return _mm_setzero_si128(); }
+        SIMD_TARGET_SSE2 static __m128i Min(__m128i a, __m128i b) { return _mm_min_epu8(a, b); }
+        SIMD_TARGET_SSE2 static __m128i Max(__m128i a, __m128i b) { return _mm_max_epu8(a, b); }
+        SIMD_TARGET_SSE2 static void Store(Element* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+    };
+
+    struct Sse2U16
+    {
+        using Element = uint16_t;
+        SIMD_TARGET_SSE2 static __m128i Bias() { return _mm_set1_epi16(static_cast<short>(0x8000)); }
+        SIMD_TARGET_SSE2 static __m128i Load(const Element* p) { return _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), Bias()); }
+        SIMD_TARGET_SSE2 static __m128i LoadHalf(const Element* p) { return _mm_xor_si128(LoadLow64(p), Bias()); }
+        SIMD_TARGET_SSE2 static __m128i InitMin() { return _mm_set1_epi16(SHRT_MAX); }
+        SIMD_TARGET_SSE2 static __m128i InitMax() { return _mm_set1_epi16(SHRT_MIN); }
+        SIMD_TARGET_SSE2 static __m128i Min(__m128i a, __m128i b) { return _mm_min_epi16(a, b); }
+        SIMD_TARGET_SSE2 static __m128i Max(__m128i a, __m128i b) { return _mm_max_epi16(a, b); }
+        SIMD_TARGET_SSE2 static void Store(Element* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_xor_si128(v, Bias())); }
+    };
+
+    struct Sse2U32
+    {
+        using Element = uint32_t;
+        SIMD_TARGET_SSE2 static __m128i Bias() { return _mm_set1_epi32(INT_MIN); }
+        SIMD_TARGET_SSE2 static __m128i Select(__m128i mask, __m128i a, __m128i b) { return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b)); }
+        SIMD_TARGET_SSE2 static __m128i Load(const Element* p) { return _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), Bias()); }
+        SIMD_TARGET_SSE2 static __m128i LoadHalf(const Element* p) { return _mm_xor_si128(LoadLow64(p), Bias()); }
+        SIMD_TARGET_SSE2 static __m128i InitMin() { return _mm_set1_epi32(INT_MAX); }
+        SIMD_TARGET_SSE2 static __m128i InitMax() { return _mm_set1_epi32(INT_MIN); }
+        SIMD_TARGET_SSE2 static __m128i Min(__m128i a, __m128i b) { return Select(_mm_cmplt_epi32(a, b), a, b); }
+        SIMD_TARGET_SSE2 static __m128i Max(__m128i a, __m128i b) { return Select(_mm_cmpgt_epi32(a, b), a, b); }
+        SIMD_TARGET_SSE2 static void Store(Element* p, __m128i v) { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), _mm_xor_si128(v, Bias())); }
+    };
+
+    // Four loads per iteration into two independent min/max chains keeps the loop load bound
+    template <typename Traits>
+    SIMD_TARGET_SSE2 MinMaxResult ReduceSse2(const uint8_t* base, uint32_t width, uint32_t height, size_t rowPitch)
+    {
+        using T = typename Traits::Element;
+        const uint32_t lanes = sizeof(__m128i) / sizeof(T);
+        __m128i min0 = Traits::InitMin(), min1 = min0;
+        __m128i max0 = Traits::InitMax(), max1 = max0;
+        MinMaxResult result = { UINT32_MAX, 0 };
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const T* row = reinterpret_cast<const T*>(base + y * rowPitch);
+            uint32_t x = 0;
+            for (; x + 4 * lanes <= width; x += 4 * lanes)
+            {
+                __m128i a = Traits::Load(row + x);
+                __m128i b = Traits::Load(row + x + lanes);
+                __m128i c = Traits::Load(row + x + 2 * lanes);
+                __m128i d = Traits::Load(row + x + 3 * lanes);
+                min0 = Traits::Min(min0, Traits::Min(a, b));
+                min1 = Traits::Min(min1, Traits::Min(c, d));
+                max0 = Traits::Max(max0, Traits::Max(a, b));
+                max1 = Traits::Max(max1, Traits::Max(c, d));
+            }
+            for (; x + lanes <= width; x += lanes)
+            {
+                __m128i a = Traits::Load(row + x);
+                min0 = Traits::Min(min0, a);
+                max0 = Traits::Max(max0, a);
+            }
+
+            // The tail of a row of at least one register overlaps the last full load, shorter rows take a half
+            // register before the scalar loop; texels seen twice do not change a min or max
+            if (x < width && width >= lanes)
+            {
+                __m128i a = Traits::Load(row + width - lanes);
+                min1 = Traits::Min(min1, a);
+                max1 = Traits::Max(max1, a);
+                x = width;
+            }
+            else if (x + lanes / 2 <= width)
+            {
+                __m128i a = Traits::LoadHalf(row + x);
+                min1 = Traits::Min(min1, a);
+                max1 = Traits::Max(max1, a);
+                x += lanes / 2;
+            }
+            ReduceRowScalar(row, x, width, result.minValue, result.maxValue);
+        }
+
+        T minLanes[sizeof(__m128i) / sizeof(T)];
+        T maxLanes[sizeof(__m128i) / sizeof(T)];
+        Traits::Store(minLanes, Traits::Min(min0, min1));
+        Traits::Store(maxLanes, Traits::Max(max0, max1));
+        FoldLanes(minLanes, maxLanes, lanes, result);
+        return result;
+    }
+
+    struct Avx2U8
+    {
+        using Element = uint8_t;
+        SIMD_TARGET_AVX2 static __m256i Load(const Element* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        SIMD_TARGET_AVX2 static __m256i LoadHalf(const Element* p) { return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))); }
+        SIMD_TARGET_AVX2 static __m256i InitMin() { return _mm256_set1_epi8(-1); }
+        SIMD_TARGET_AVX2 static __m256i InitMax() { return _mm256_setzero_si256(); }
+        SIMD_TARGET_AVX2 static __m256i Min(__m256i a, __m256i b) { return _mm256_min_epu8(a, b); }
+        SIMD_TARGET_AVX2 static __m256i Max(__m256i a, __m256i b) { return _mm256_max_epu8(a, b); }
+    };
+
+    struct Avx2U16
+    {
+        using Element = uint16_t;
+        SIMD_TARGET_AVX2 static __m256i Load(const Element* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        SIMD_TARGET_AVX2 static __m256i LoadHalf(const Element* p) { return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))); }
+        SIMD_TARGET_AVX2 static __m256i InitMin() { return _mm256_set1_epi16(-1); }
+        SIMD_TARGET_AVX2 static __m256i InitMax() { return _mm256_setzero_si256(); }
+        SIMD_TARGET_AVX2 static __m256i Min(__m256i a, __m256i b) { return _mm256_min_epu16(a, b); }
+        SIMD_TARGET_AVX2 static __m256i Max(__m256i a, __m256i b) { return _mm256_max_epu16(a, b); }
+    };
+
+    struct Avx2U32
+    {
+        using Element = uint32_t;
+        SIMD_TARGET_AVX2 static __m256i Load(const Element* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+        SIMD_TARGET_AVX2 static __m256i LoadHalf(const Element* p) { return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))); }
+        SIMD_TARGET_AVX2 static __m256i InitMin() { return _mm256_set1_epi32(-1); }
+        SIMD_TARGET_AVX2 static __m256i InitMax() { return _mm256_setzero_si256(); }
+        SIMD_TARGET_AVX2 static __m256i Min(__m256i a, __m256i b) { return _mm256_min_epu32(a, b); }
+        SIMD_TARGET_AVX2 static __m256i Max(__m256i a, __m256i b) { return _mm256_max_epu32(a, b); }
+    };
+
+    template <typename Traits>
+    SIMD_TARGET_AVX2 MinMaxResult ReduceAvx2(const uint8_t* base, uint32_t width, uint32_t height, size_t rowPitch)
+    {
+        using T = typename Traits::Element;
+        const uint32_t lanes = sizeof(__m256i) / sizeof(T);
+        __m256i min0 = Traits::InitMin(), min1 = min0;
+        __m256i max0 = Traits::InitMax(), max1 = max0;
+        MinMaxResult result = { UINT32_MAX, 0 };
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const T* row = reinterpret_cast<const T*>(base + y * rowPitch);
+            uint32_t x = 0;
+            for (; x + 4 * lanes <= width; x += 4 * lanes)
+            {
+                __m256i a = Traits::Load(row + x);
+                __m256i b = Traits::Load(row + x + lanes);
+                __m256i c = Traits::Load(row + x + 2 * lanes);
+                __m256i d = Traits::Load(row + x + 3 * lanes);
+                min0 = Traits::Min(min0, Traits::Min(a, b));
+                min1 = Traits::Min(min1, Traits::Min(c, d));
+                max0 = Traits::Max(max0, Traits::Max(a, b));
+                max1 = Traits::Max(max1, Traits::Max(c, d));
+            }
+            for (; x + lanes <= width; x += lanes)
+            {
+                __m256i a = Traits::Load(row + x);
+                min0 = Traits::Min(min0, a);
+                max0 = Traits::Max(max0, a);
+            }
+
+            // Same row tail as ReduceSse2: an overlapping load, or a half register for short rows
+            if (x < width && width >= lanes)
+            {
+                __m256i a = Traits::Load(row + width - lanes);
+                min1 = Traits::Min(min1, a);
+                max1 = Traits::Max(max1, a);
+                x = width;
+            }
+            else if (x + lanes / 2 <= width)
+            {
+                __m256i a = Traits::LoadHalf(row + x);
+                min1 = Traits::Min(min1, a);
+                max1 = Traits::Max(max1, a);
+                x += lanes / 2;
+            }
+            ReduceRowScalar(row, x, width, result.minValue, result.maxValue);
+        }
+
+        T minLanes[sizeof(__m256i) / sizeof(T)];
+        T maxLanes[sizeof(__m256i) / sizeof(T)];
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(minLanes), Traits::Min(min0, min1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(maxLanes), Traits::Max(max0, max1));
+        FoldLanes(minLanes, maxLanes, lanes, result);
+        return result;
+    }
+
+    struct Avx512U8
+    {
+        using Element = uint8_t;
+        SIMD_TARGET_AVX512 static __m512i Min(__m512i a, __m512i b) { return _mm512_min_epu8(a, b); }
+        SIMD_TARGET_AVX512 static __m512i Max(__m512i a, __m512i b) { return _mm512_max_epu8(a, b); }
+    };
+
+    struct Avx512U16
+    {
+        using Element = uint16_t;
+        SIMD_TARGET_AVX512 static __m512i Min(__m512i a, __m512i b) { return _mm512_min_epu16(a, b); }
+        SIMD_TARGET_AVX512 static __m512i Max(__m512i a, __m512i b) { return _mm512_max_epu16(a, b); }
+    };
+
+    struct Avx512U32
+    {
+        using Element = uint32_t;
+        SIMD_TARGET_AVX512 static __m512i Min(__m512i a, __m512i b) { return _mm512_min_epu32(a, b); }
+        SIMD_TARGET_AVX512 static __m512i Max(__m512i a, __m512i b) { return _mm512_max_epu32(a, b); }
+    };
+
+    // The row tail is handled with a masked load instead of a scalar loop
+    template <typename Traits>
+    SIMD_TARGET_AVX512 MinMaxResult ReduceAvx512(const uint8_t* base, uint32_t width, uint32_t height, size_t rowPitch)
+    {
+        using T = typename Traits::Element;
+        const uint32_t lanes = sizeof(__m512i) / sizeof(T);
+        const uint32_t tailBytes = (width % lanes) * sizeof(T);
+        const __mmask64 tailMask = tailBytes ? ((1ull << tailBytes) - 1) : 0;
+        __m512i min0 = _mm512_set1_epi32(-1), min1 = min0;
+        __m512i max0 = _mm512_setzero_si512(), max1 = max0;
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const T* row = reinterpret_cast<const T*>(base + y * rowPitch);
+            uint32_t x = 0;
+            for (; x + 4 * lanes <= width; x += 4 * lanes)
+            {
+                __m512i a = _mm512_loadu_si512(row + x);
+                __m512i b = _mm512_loadu_si512(row + x + lanes);
+                __m512i c = _mm512_loadu_si512(row + x + 2 * lanes);
+                __m512i d = _mm512_loadu_si512(row + x + 3 * lanes);
+                min0 = Traits::Min(min0, Traits::Min(a, b));
+                min1 = Traits::Min(min1, Traits::Min(c, d));
+                max0 = Traits::Max(max0, Traits::Max(a, b));
+                max1 = Traits::Max(max1, Traits::Max(c, d));
+            }
+            for (; x + lanes <= width; x += lanes)
+            {
+                __m512i a = _mm512_loadu_si512(row + x);
+                min0 = Traits::Min(min0, a);
+                max0 = Traits::Max(max0, a);
+            }
+            if (tailMask)
+            {
+                // Masked-off bytes load as all ones for min and zero for max so they never win
+                min0 = Traits::Min(min0, _mm512_mask_loadu_epi8(_mm512_set1_epi32(-1), tailMask, row + x));
+                max0 = Traits::Max(max0, _mm512_maskz_loadu_epi8(tailMask, row + x));
+            }
+        }
+
+        T minLanes[sizeof(__m512i) / sizeof(T)];
+        T maxLanes[sizeof(__m512i) / sizeof(T)];
+        _mm512_storeu_si512(minLanes, Traits::Min(min0, min1));
+        _mm512_storeu_si512(maxLanes, Traits::Max(max0, max1));
+        MinMaxResult result = { UINT32_MAX, 0 };
+        FoldLanes(minLanes, maxLanes, lanes, result);
+        return result;
+    }
+#endif
+
+    using ReduceFunction = MinMaxResult(*)(const uint8_t*, uint32_t, uint32_t, size_t);
+
+    ReduceFunction SelectKernel(SimdLevel level, TexelFormat format)
+    {
+        const int formatIndex = static_cast<int>(format);
+#if SIMD_X86
+        static const ReduceFunction avx512[] = { ReduceAvx512<Avx512U8>, ReduceAvx512<Avx512U16>, ReduceAvx512<Avx512U32> };
+        static const ReduceFunction avx2[] = { ReduceAvx2<Avx2U8>, ReduceAvx2<Avx2U16>, ReduceAvx2<Avx2U32> };
+        static const ReduceFunction sse2[] = { ReduceSse2<Sse2U8>, ReduceSse2<Sse2U16>, ReduceSse2<Sse2U32> };
+        switch (level)
+        {
+        case SimdLevel::Avx512:
+            return avx512[formatIndex];
+        case SimdLevel::Avx2:
+            return avx2[formatIndex];
+        case SimdLevel::Sse2:
+            return sse2[formatIndex];
+        default:
+            break;
+        }
+#else
+        (void)level;
+#endif
+        static const ReduceFunction scalar[] = { ReduceScalar<uint8_t>, ReduceScalar<uint16_t>, ReduceScalar<uint32_t> };
+        return scalar[formatIndex];
+    }
+}
+
+size_t GetTexelSize(TexelFormat format)
+{
+    switch (format)
+    {
+    case TexelFormat::R8:
+        return 1;
+    case TexelFormat::R16:
+        return 2;
+    case TexelFormat::R32:
+        return 4;
+    }
+    throw std::runtime_error("Unknown texel format");
+}
+
+SimdLevel DetectSimdLevel()
+{
+#if SIMD_X86
+#if defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool sse2 = (info[3] & (1 << 26)) != 0;
+    const bool osxsave = (info[2] & (1 << 27)) != 0;
+    const bool avx = (info[2] & (1 << 28)) != 0;
+    if (!sse2)
+    {
+        return SimdLevel::Scalar;
+    }
+    if (!osxsave || !avx || maxLeaf < 7)
+    {
+        return SimdLevel::Sse2;
+    }
+
+    // The OS has to save the YMM (and ZMM) registers on context switches
+    const unsigned long long xcr0 = _xgetbv(0);
+    __cpuidex(info, 7, 0);
+    const bool avx2 = (info[1] & (1 << 5)) != 0 && (xcr0 & 0x6) == 0x6;
+    const bool avx512 = (info[1] & (1 << 16)) != 0 && (info[1] & (1 << 30)) != 0 && (xcr0 & 0xE6) == 0xE6;
+    if (avx2 && avx512)
+    {
+        return SimdLevel::Avx512;
+    }
+    return avx2 ? SimdLevel::Avx2 : SimdLevel::Sse2;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx2"))
+    {
+        return SimdLevel::Avx512;
+    }
+    if (__builtin_cpu_supports("avx2"))
+    {
+        return SimdLevel::Avx2;
+    }
+    return __builtin_cpu_supports("sse2") ? SimdLevel::Sse2 : SimdLevel::Scalar;
+#endif
+#else
+    return SimdLevel::Scalar;
+#endif
+}
+
+const char* GetSimdLevelName(SimdLevel level)
+{
+    switch (level)
+    {
+    case SimdLevel::Scalar:
+        return "scalar";
+    case SimdLevel::Sse2:
+        return "sse2";
+    case SimdLevel::Avx2:
+        return "avx2";
+    case SimdLevel::Avx512:
+        return "avx512";
+    }
+    return "unknown";
+}
+
+MinMaxResult ReduceMinMax(const void* texels, uint32_t width, uint32_t height, size_t rowPitch, TexelFormat format)
+{
+    static const SimdLevel detectedLevel = DetectSimdLevel();
+    return ReduceMinMax(texels, width, height, rowPitch, format, detectedLevel);
+}
+
+MinMaxResult ReduceMinMax(const void* texels, uint32_t width, uint32_t height, size_t rowPitch, TexelFormat format, SimdLevel level)
+{
+    static const SimdLevel detectedLevel = DetectSimdLevel();
+    if (width == 0 || height == 0)
+    {
+        return { UINT32_MAX, 0 };
+    }
+    if (texels == nullptr || rowPitch < width * GetTexelSize(format))
+    {
+        throw std::runtime_error("Invalid image for min/max reduction");
+    }
+
+    ReduceFunction kernel = SelectKernel(std::min(level, detectedLevel), format);
+    return kernel(static_cast<const uint8_t*>(texels), width, height, rowPitch);
+}
+
+uint32_t ReduceMax(const uint32_t* values, size_t count)
+{
+    // Split into rows so counts above UINT32_MAX stay representable as width x height
+    const uint32_t rowLength = 1u << 20;
+    uint32_t maxValue = 0;
+    for (size_t offset = 0; offset < count; offset += rowLength)
+    {
+        uint32_t length = static_cast<uint32_t>(std::min<size_t>(rowLength, count - offset));
+        maxValue = std::max(maxValue, ReduceMinMax(values + offset, length, 1, length * sizeof(uint32_t), TexelFormat::R32).maxValue);
+    }
+    return maxValue;
+}
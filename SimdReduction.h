@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Max/min reduction of R8/R16/R32 unsigned images on the CPU.
+// Kernels exist for SSE2, AVX2 and AVX-512 (BW) and the widest one supported by the running CPU
+// is picked once at first use, other platforms use the scalar loop.
+
+enum class TexelFormat
+{
+    R8,
+    R16,
+    R32
+};
+
+enum class SimdLevel
+{
+    Scalar,
+    Sse2,
+    Avx2,
+    Avx512
+};
+
+struct MinMaxResult
+{
+    uint32_t minValue;
+    uint32_t maxValue;
+};
+
+size_t GetTexelSize(TexelFormat format);
+
+// Widest instruction set the CPU and OS support
+SimdLevel DetectSimdLevel();
+const char* GetSimdLevelName(SimdLevel level);
+
+// rowPitch is the distance in bytes between the starts of two rows and may exceed width * texel size.
+// An empty image returns { UINT32_MAX, 0 }.
+MinMaxResult ReduceMinMax(const void* texels, uint32_t width, uint32_t height, size_t rowPitch, TexelFormat format);
+
+// Same with an explicit kernel, levels above DetectSimdLevel() fall back to the detected level
+MinMaxResult ReduceMinMax(const void* texels, uint32_t width, uint32_t height, size_t rowPitch, TexelFormat format, SimdLevel level);
+
+// Max of a UINT array such as the intermediate buffer of the compute shader
+uint32_t ReduceMax(const uint32_t* values, size_t count);
@@ -0,0 +1,163 @@
+#include "SubmissionScheduler.h"
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+SubmissionScheduler::SubmissionScheduler(ISubmissionQueue& queue, uint32_t slotCount)
+    : m_queue(queue), m_slotTickets(slotCount, 0)
+{
+    if (slotCount == 0)
+    {
+        throw std::runtime_error("Submission scheduler needs at least one slot");
+    }
+}
+
+uint32_t SubmissionScheduler::BeginJob()
+{
+    if (m_inJob)
+    {
+        throw std::runtime_error("BeginJob called twice without EndJob");
+    }
+
+    // Round robin, so the next slot always holds the oldest job
+    const uint64_t previous = m_slotTickets[m_nextSlot];
+    if (previous != 0 && !IsComplete(previous))
+    {
+        ++m_slotWaits;
+        m_queue.Wait(previous);
+    }
+    m_inJob = true;
+    return m_nextSlot;
+}
+
+uint64_t SubmissionScheduler::EndJob()
+{
+    if (!m_inJob)
+    {
+        throw std::runtime_error("EndJob called without BeginJob");
+    }
+
+    const uint64_t ticket = ++m_lastTicket;
+    m_queue.Signal(ticket);
+    m_slotTickets[m_nextSlot] = ticket;
+    m_nextSlot = (m_nextSlot + 1) % GetSlotCount();
+    m_inJob = false;
+    return ticket;
+}
+
+void SubmissionScheduler::AbandonJob()
+{
+    if (!m_inJob)
+    {
+        throw std::runtime_error("AbandonJob called without BeginJob");
+    }
+    m_inJob = false;
+}
+
+ScopedSubmissionJob::~ScopedSubmissionJob()
+{
+    if (!m_ended)
+    {
+        m_scheduler.AbandonJob();
+    }
+}
+
+uint64_t ScopedSubmissionJob::End()
+{
+    if (m_ended)
+    {
+        throw std::runtime_error("Submission job ended twice");
+    }
+    const uint64_t ticket = m_scheduler.EndJob();
+    m_ended = true;
+    return ticket;
+}
+
+void SubmissionScheduler::Wait(uint64_t ticket)
+{
+    if (ticket > m_lastTicket)
+    {
+        throw std::runtime_error("Waiting for ticket " + std::to_string(ticket) + " that was never submitted");
+    }
+    if (!IsComplete(ticket))
+    {
+        m_queue.Wait(ticket);
+    }
+}
+
+uint32_t SubmissionScheduler::GetJobsInFlight()
+{
+    const uint64_t completed = std::min(m_queue.GetCompletedValue(), m_lastTicket);
+    return static_cast<uint32_t>(m_lastTicket - completed);
+}
+
+SimulatedSubmissionQueue::SimulatedSubmissionQueue(std::function<double(uint64_t)> latencyMs)
+    : m_latencyMs(std::move(latencyMs))
+{
+}
+
+void SimulatedSubmissionQueue::Signal(uint64_t value)
+{
+    if (value != m_completionMs.size() + 1)
+    {
+        throw std::runtime_error("Simulated queue values have to increase by one");
+    }
+    const double latency = m_latencyMs(value);
+    const double start = m_completionMs.empty() ? m_nowMs : std::max(m_nowMs, m_completionMs.back());
+    m_completionMs.push_back(start + latency);
+    m_busyMs += latency;
+}
+
+uint64_t SimulatedSubmissionQueue::GetCompletedValue()
+{
+    // Completion times increase with the value
+    auto firstPending = std::upper_bound(m_completionMs.begin(), m_completionMs.end(), m_nowMs);
+    return static_cast<uint64_t>(firstPending - m_completionMs.begin());
+}
+
+void SimulatedSubmissionQueue::Wait(uint64_t value)
+{
+    if (value == 0)
+    {
+        return;
+    }
+    if (value > m_completionMs.size())
+    {
+        throw std::runtime_error("Waiting for a value that was never signalled, the simulated queue would hang");
+    }
+    m_nowMs = std::max(m_nowMs, m_completionMs[value - 1]);
+}
+
+void WriteSubmissionReport(std::ostream& out, uint32_t jobs, double cpuMs, double gpuMs, double jitter, uint64_t seed)
+{
+    out << "Submission, " << jobs << " jobs, " << cpuMs << " ms to record, " << gpuMs << " ms +- " << jitter * 100.0 << "% on the queue, seed " << seed << std::endl;
+    for (uint32_t slotCount = 1; slotCount <= 4; ++slotCount)
+    {
+        // Same latencies for every slot count
+        std::mt19937_64 random(seed);
+        std::uniform_real_distribution<double> spread(1.0 - jitter, 1.0 + jitter);
+        std::vector<double> latencies(jobs);
+        for (double& latency : latencies)
+        {
+            latency = gpuMs * spread(random);
+        }
+
+        SimulatedSubmissionQueue queue([&](uint64_t value) { return latencies[static_cast<size_t>(value - 1)]; });
+        SubmissionScheduler scheduler(queue, slotCount);
+        uint32_t maxInFlight = 0;
+        for (uint32_t i = 0; i < jobs; ++i)
+        {
+            ScopedSubmissionJob job(scheduler);
+            queue.Advance(cpuMs);
+            job.End();
+            maxInFlight = std::max(maxInFlight, scheduler.GetJobsInFlight());
+        }
+        scheduler.WaitIdle();
+
+        const double elapsedMs = queue.GetTimeMs();
+        out << "  " << slotCount << " in flight: " << elapsedMs << " ms, " << jobs * 1000.0 / std::max(elapsedMs, 1e-9) << " jobs/s, GPU busy "
+            << 100.0 * queue.GetBusyMs() / std::max(elapsedMs, 1e-9) << "%, " << scheduler.GetSlotWaits() << " slot waits, at most " << maxInFlight << " jobs in flight" << std::endl;
+    }
+}
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <vector>
+
+// Frames-in-flight bookkeeping for one queue, independent of D3D12 so the scheduling can run against
+// SimulatedSubmissionQueue on any platform; D3D12SubmissionQueue.h adapts an ID3D12CommandQueue.
+
+// One monotonic fence per queue: Signal(value) completes after all work submitted before it
+class ISubmissionQueue
+{
+public:
+    virtual ~ISubmissionQueue() = default;
+
+    virtual void Signal(uint64_t value) = 0;
+    virtual uint64_t GetCompletedValue() = 0;
+    // Blocks until GetCompletedValue() >= value
+    virtual void Wait(uint64_t value) = 0;
+};
+
+// Hands out slotCount slots (e.g. command allocators) round robin and bounds the jobs in flight to
+// slotCount. BeginJob returns the next slot once the job that used it last has completed, EndJob signals
+// the next fence value after the job's work and returns it as the job's ticket. A slot is recycled by
+// the fence value of its previous job, no fence or event is created per job.
+class SubmissionScheduler
+{
+public:
+    SubmissionScheduler(ISubmissionQueue& queue, uint32_t slotCount);
+
+    // Waits for the oldest job when all slots are in flight
+    uint32_t BeginJob();
+    // Call after submitting the work recorded with the slot of BeginJob
+    uint64_t EndJob();
+    // Gives up the job of BeginJob when nothing was submitted with its slot, the slot is handed out again
+    void AbandonJob();
+
+    bool IsComplete(uint64_t ticket) { return m_queue.GetCompletedValue() >= ticket; }
+    void Wait(uint64_t ticket);
+    void WaitIdle() { Wait(m_lastTicket); }
+
+    uint32_t GetSlotCount() const { return static_cast<uint32_t>(m_slotTickets.size()); }
+    uint64_t GetLastTicket() const { return m_lastTicket; }
+    uint32_t GetJobsInFlight();
+    uint64_t GetSlotWaits() const { return m_slotWaits; }   // BeginJob calls that had to wait
+
+private:
+    ISubmissionQueue& m_queue;
+    std::vector<uint64_t> m_slotTickets;    // ticket of the last job per slot, 0 when unused
+    uint32_t m_nextSlot = 0;
+    uint64_t m_lastTicket = 0;
+    bool m_inJob = false;
+    uint64_t m_slotWaits = 0;
+};
+
+// BeginJob on construction, AbandonJob on destruction unless End was called, so an exception while
+// recording does not leave the scheduler inside a job. Call End right after submitting the work.
+class ScopedSubmissionJob
+{
+public:
+    explicit ScopedSubmissionJob(SubmissionScheduler& scheduler) : m_scheduler(scheduler), m_slot(scheduler.BeginJob()) {}
+    ~ScopedSubmissionJob();
+
+    ScopedSubmissionJob(const ScopedSubmissionJob&) = delete;
+    ScopedSubmissionJob& operator=(const ScopedSubmissionJob&) = delete;
+
+    uint32_t GetSlot() const { return m_slot; }
+    uint64_t End();
+
+private:
+    SubmissionScheduler& m_scheduler;
+    uint32_t m_slot;
+    bool m_ended = false;
+};
+
+// In-order queue on a virtual clock in milliseconds. Work signalled at time t starts when the previous
+// work has completed (or at t) and takes latencyMs(value) to complete. The clock only moves through
+// Advance (CPU work of the caller) and Wait, which jumps to the completion of the awaited value, so a
+// schedule is reproducible without a device or real sleeps.
+class SimulatedSubmissionQueue : public ISubmissionQueue
+{
+public:
+    explicit SimulatedSubmissionQueue(std::function<double(uint64_t)> latencyMs);
+
+    void Signal(uint64_t value) override;
+    uint64_t GetCompletedValue() override;
+    void Wait(uint64_t value) override;
+
+    void Advance(double milliseconds) { m_nowMs += milliseconds; }
+    double GetTimeMs() const { return m_nowMs; }
+    double GetBusyMs() const { return m_busyMs; }           // sum of the latencies signalled so far
+
+private:
+    std::function<double(uint64_t)> m_latencyMs;
+    std::vector<double> m_completionMs;                     // index value - 1
+    double m_nowMs = 0.0;
+    double m_busyMs = 0.0;
+};
+
+// Simulated workload, no device needed: jobs that take cpuMs to record and gpuMs (+-jitter, seeded) on
+// the queue, submitted through a SubmissionScheduler with 1 to 4 slots. Writes the elapsed virtual
+// time, throughput and GPU utilization per slot count.
+void WriteSubmissionReport(std::ostream& out, uint32_t jobs, double cpuMs, double gpuMs, double jitter, uint64_t seed);
@@ -0,0 +1,251 @@
+#include "TestFramework.h"
+#include "Autotuner.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Scratch database file, removed again on destruction
+    struct ScratchDatabaseFile
+    {
+        fs::path path = fs::temp_directory_path() / "AutotunerTests.txt";
+
+        ~ScratchDatabaseFile()
+        {
+            std::error_code error;
+            fs::remove(path, error);
+        }
+    };
+
+    // Records every kernel dispatch; group size 16 is the fastest
+    class MockBackend : public IReductionBackend
+    {
+    public:
+        const char* GetName() const override { return "mock"; }
+        void CreateDevice() override {}
+        void UploadTexture(const uint8_t*, uint32_t width, uint32_t height, uint32_t) override { SetTextureSize(width, height); }
+        TextureUploadRegion BeginTextureUpload(uint32_t width, uint32_t height) override
+        {
+            SetTextureSize(width, height);
+            m_texels.resize(static_cast<size_t>(width) * height);
+            TextureUploadRegion region;
+            region.texels = m_texels.data();
+            region.rowPitch = width;
+            return region;
+        }
+        void EndTextureUpload() override {}
+        uint32_t ReadBack() override { return 0; }
+        double GetLastDispatchTimeMs() const override { return m_dispatches.back() == 16 ? 1.0 : 2.0; }
+        std::string GetDeviceId() const override { return "mock-device"; }
+        void ApplyTuningVariant(const TuningVariant& variant) override { m_applied.push_back(variant.threadGroupSize); }
+
+        std::vector<uint32_t> m_dispatches;
+        std::vector<uint32_t> m_applied;
+
+    protected:
+        void DispatchKernel(uint32_t threadGroupSize) override { m_dispatches.push_back(threadGroupSize); }
+
+    private:
+        std::vector<uint8_t> m_texels;
+    };
+
+    BenchmarkOptions MakeShortOptions()
+    {
+        BenchmarkOptions options;
+        options.warmupRuns = 0;
+        options.minRuns = 2;
+        options.maxRuns = 2;
+        return options;
+    }
+
+    TuningKey MakeKey(uint32_t width, uint32_t height)
+    {
+        TuningKey key;
+        key.deviceId = "mock-device";
+        key.backend = "mock";
+        key.strategy = "partials";
+        key.width = width;
+        key.height = height;
+        return key;
+    }
+
+    void WriteFile(const fs::path& path, const std::string& contents)
+    {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+    }
+}
+
+TEST_CASE(TuningDatabaseRoundTrip)
+{
+    ScratchDatabaseFile file;
+    TuningDatabase database;
+    TuningEntry cpu;
+    cpu.key = MakeKey(1024, 768);
+    cpu.key.backend = "cpu";
+    cpu.key.format = TexelFormat::R16;
+    cpu.variant.threadGroupSize = 32;
+    cpu.variant.workerCount = 4;
+    cpu.variant.tileWidth = 4096;
+    cpu.variant.tileHeight = 16;
+    cpu.medianMs = 0.25;
+    TuningEntry gpu;
+    gpu.key = MakeKey(64, 64);
+    gpu.variant.threadGroupSize = 8;
+    gpu.medianMs = 1.5;
+    database.Store(cpu);
+    database.Store(gpu);
+    database.Save(file.path.string());
+
+    TuningDatabase loaded;
+    loaded.Load(file.path.string());
+    CHECK_EQUAL(size_t(2), loaded.Size());
+    const TuningEntry* entry = loaded.Find(cpu.key);
+    CHECK(entry != nullptr);
+    CHECK_EQUAL(32u, entry->variant.threadGroupSize);
+    CHECK_EQUAL(4u, entry->variant.workerCount);
+    CHECK_EQUAL(4096u, entry->variant.tileWidth);
+    CHECK_EQUAL(16u, entry->variant.tileHeight);
+    CHECK_EQUAL(0.25, entry->medianMs);
+    CHECK(loaded.Find(gpu.key) != nullptr);
+    CHECK_EQUAL(8u, loaded.Find(gpu.key)->variant.threadGroupSize);
+
+    // Only the format differs
+    TuningKey r8 = cpu.key;
+    r8.format = TexelFormat::R8;
+    CHECK(loaded.Find(r8) == nullptr);
+}
+
+TEST_CASE(TuningDatabaseLoadsOlderVersions)
+{
+    // Version 1 without tile columns, version 2 with the old tileHeight column; both get the default host tile
+    ScratchDatabaseFile file;
+    WriteFile(file.path,
+        "# ReductionTuningDatabase 1\n"
+        "dev\tcpu\tpartials\tr8\t64\t64\t16\t2\t0.5\r\n"
+        "\n"
+        "dev\tcpu\tatomic\tr8\t64\t64\t32\t0\t64\t0.75\n");
+    TuningDatabase database;
+    database.Load(file.path.string());
+    CHECK_EQUAL(size_t(2), database.Size());
+
+    TuningKey key;
+    key.deviceId = "dev";
+    key.backend = "cpu";
+    key.strategy = "partials";
+    key.width = 64;
+    key.height = 64;
+    const TuningEntry* version1 = database.Find(key);
+    CHECK(version1 != nullptr);
+    CHECK_EQUAL(16u, version1->variant.threadGroupSize);
+    CHECK_EQUAL(2u, version1->variant.workerCount);
+    CHECK_EQUAL(0u, version1->variant.tileWidth);
+    CHECK_EQUAL(0u, version1->variant.tileHeight);
+    CHECK_EQUAL(0.5, version1->medianMs);
+
+    key.strategy = "atomic";
+    const TuningEntry* version2 = database.Find(key);
+    CHECK(version2 != nullptr);
+    CHECK_EQUAL(32u, version2->variant.threadGroupSize);
+    CHECK_EQUAL(0u, version2->variant.tileHeight);
+    CHECK_EQUAL(0.75, version2->medianMs);
+}
+
+TEST_CASE(TuningDatabaseRejectsMalformedLines)
+{
+    ScratchDatabaseFile file;
+    const char* const malformed[] =
+    {
+        "dev\tcpu\tpartials\tr8\t64\t64\t16\t0.5\n",                           // too few fields
+        "dev\tcpu\tpartials\tr8\t64\t64\t16\t0\t0\t0\t0\t0.5\n",               // too many fields
+        "dev\tcpu\tpartials\tr8\twide\t64\t16\t0\t0.5\n",                      // width not a number
+        "dev\tcpu\tpartials\tr8\t64\t64\t16\t0\tslow\n",                       // median not a number
+        "dev\tcpu\tpartials\tr12\t64\t64\t16\t0\t0.5\n",                       // unknown format
+    };
+    for (const char* line : malformed)
+    {
+        WriteFile(file.path, std::string("# ReductionTuningDatabase 3\n") + line);
+        TuningDatabase database;
+        CHECK_THROWS(database.Load(file.path.string()));
+    }
+
+    // A missing file is an empty database
+    std::error_code error;
+    fs::remove(file.path, error);
+    TuningDatabase database;
+    database.Load(file.path.string());
+    CHECK_EQUAL(size_t(0), database.Size());
+
+    TuningEntry entry;
+    entry.key = MakeKey(64, 64);
+    entry.key.deviceId = "gpu\t0";
+    CHECK_THROWS(database.Store(entry));
+}
+
+TEST_CASE(AutotunerSelectTunesOnceAndCaches)
+{
+    TuningDatabase database;
+    ReductionAutotuner autotuner(database, MakeShortOptions());
+    MockBackend backend;
+    backend.UploadTexture(nullptr, 64, 64, 64);
+
+    bool tuned = false;
+    const TuningVariant first = autotuner.Select(backend, MakeKey(64, 64), &tuned);
+    CHECK(tuned);
+    CHECK_EQUAL(16u, first.threadGroupSize);
+    CHECK_EQUAL(size_t(3 * 2), backend.m_dispatches.size());
+    CHECK_EQUAL(size_t(1), database.Size());
+    CHECK_EQUAL(16u, backend.m_applied.back());
+
+    // Database hit: nothing is dispatched, the stored variant is applied again
+    const TuningVariant second = autotuner.Select(backend, MakeKey(64, 64), &tuned);
+    CHECK(!tuned);
+    CHECK_EQUAL(16u, second.threadGroupSize);
+    CHECK_EQUAL(size_t(3 * 2), backend.m_dispatches.size());
+    CHECK_EQUAL(16u, backend.m_applied.back());
+
+    // Another size is tuned separately
+    autotuner.Select(backend, MakeKey(128, 64), &tuned);
+    CHECK(tuned);
+    CHECK_EQUAL(size_t(2), database.Size());
+}
+
+TEST_CASE(BackendDispatchRunsTunedVariantPerSize)
+{
+    TuningDatabase database;
+    ReductionAutotuner autotuner(database, MakeShortOptions());
+    MockBackend backend;
+    backend.SetAutotuner(&autotuner, MakeKey(0, 0));
+
+    // The first dispatch of a size runs the sweep, every dispatch runs the winner
+    backend.UploadTexture(nullptr, 64, 64, 64);
+    backend.Dispatch(32);
+    CHECK_EQUAL(size_t(3 * 2 + 1), backend.m_dispatches.size());
+    CHECK_EQUAL(16u, backend.m_dispatches.back());
+    const uint64_t ticket = backend.Submit(8);
+    backend.WaitResult(ticket);
+    CHECK_EQUAL(size_t(3 * 2 + 2), backend.m_dispatches.size());
+    CHECK_EQUAL(16u, backend.m_dispatches.back());
+
+    TuningVariant variant;
+    bool tuned = true;
+    CHECK(backend.SelectTuning(variant, &tuned));
+    CHECK(!tuned);
+    CHECK_EQUAL(16u, variant.threadGroupSize);
+
+    // In-place uploads report their size too
+    backend.BeginTextureUpload(32, 16);
+    backend.EndTextureUpload();
+    backend.Dispatch(8);
+    CHECK_EQUAL(size_t(2 * (3 * 2) + 3), backend.m_dispatches.size());
+    CHECK(database.Find(MakeKey(32, 16)) != nullptr);
+
+    // Without an autotuner the given group size runs
+    backend.SetAutotuner(nullptr, TuningKey());
+    backend.Dispatch(8);
+    CHECK_EQUAL(8u, backend.m_dispatches.back());
+    CHECK(!backend.SelectTuning(variant));
+}
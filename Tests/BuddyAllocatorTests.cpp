@@ -0,0 +1,149 @@
+#include "TestFramework.h"
+#include "BuddyAllocator.h"
+#include <random>
+#include <vector>
+
+TEST_CASE(BuddyAllocatorRoundsUpToBlocks)
+{
+    BuddyAllocator allocator(1 << 20, 4096);
+    const uint64_t a = allocator.Allocate(5000);
+    CHECK_EQUAL(0ull, a);
+    CHECK_EQUAL(8192ull, allocator.GetAllocatedBytes());
+    CHECK_EQUAL(5000ull, allocator.GetRequestedBytes());
+
+    const uint64_t b = allocator.Allocate(1);
+    CHECK_EQUAL(8192ull, b);
+    CHECK_EQUAL(2u, static_cast<unsigned>(allocator.GetAllocationCount()));
+    allocator.Free(a);
+    allocator.Free(b);
+    CHECK_EQUAL(0ull, allocator.GetAllocatedBytes());
+}
+
+TEST_CASE(BuddyAllocatorMergesFreedBuddies)
+{
+    BuddyAllocator allocator(64 * 1024, 4096);
+    std::vector<uint64_t> blocks;
+    for (int i = 0; i < 16; ++i)
+    {
+        blocks.push_back(allocator.Allocate(4096));
+    }
+    CHECK_EQUAL(InvalidAllocationOffset, allocator.Allocate(4096));
+    CHECK_EQUAL(0ull, allocator.GetLargestFreeBlock());
+
+    // Freeing in an interleaved order only merges once both buddies are free
+    for (int i = 0; i < 16; i += 2)
+    {
+        allocator.Free(blocks[i]);
+    }
+    CHECK_EQUAL(4096ull, allocator.GetLargestFreeBlock());
+    for (int i = 1; i < 16; i += 2)
+    {
+        allocator.Free(blocks[i]);
+    }
+    CHECK_EQUAL(64ull * 1024, allocator.GetLargestFreeBlock());
+    CHECK_EQUAL(0ull, allocator.Allocate(64 * 1024));
+}
+
+TEST_CASE(BuddyAllocatorHonoursAlignment)
+{
+    BuddyAllocator allocator(1 << 20, 4096);
+    allocator.Allocate(4096);
+    const uint64_t aligned = allocator.Allocate(4096, 65536);
+    CHECK(aligned != InvalidAllocationOffset);
+    CHECK_EQUAL(0ull, aligned % 65536);
+}
+
+TEST_CASE(BuddyAllocatorRejectsInvalidUse)
+{
+    CHECK_THROWS(BuddyAllocator(3000, 1024));
+    CHECK_THROWS(BuddyAllocator(4096, 8192));
+    BuddyAllocator allocator(1 << 16, 4096);
+    CHECK_EQUAL(InvalidAllocationOffset, allocator.Allocate((1 << 16) + 1));
+    CHECK_THROWS(allocator.Free(4096));
+}
+
+TEST_CASE(BuddyAllocatorRandomBlocksNeverOverlap)
+{
+    BuddyAllocator allocator(1 << 24, 4096);
+    std::mt19937_64 random(5);
+    struct Block
+    {
+        uint64_t offset;
+        uint64_t size;
+    };
+    std::vector<Block> live;
+    for (int i = 0; i < 5000; ++i)
+    {
+        if (!live.empty() && random() % 3 == 0)
+        {
+            const size_t index = static_cast<size_t>(random() % live.size());
+            allocator.Free(live[index].offset);
+            live[index] = live.back();
+            live.pop_back();
+            continue;
+        }
+        const uint64_t size = 1 + random() % (1 << 18);
+        const uint64_t alignment = (random() % 2) ? 65536 : 4096;
+        const uint64_t offset = allocator.Allocate(size, alignment);
+        if (offset == InvalidAllocationOffset)
+        {
+            continue;
+        }
+        CHECK_EQUAL(0ull, offset % alignment);
+        CHECK(offset + size <= allocator.GetCapacity());
+        for (const Block& block : live)
+        {
+            CHECK(offset + size <= block.offset || block.offset + block.size <= offset);
+        }
+        live.push_back({ offset, size });
+    }
+    for (const Block& block : live)
+    {
+        allocator.Free(block.offset);
+    }
+    CHECK_EQUAL(allocator.GetCapacity(), allocator.GetLargestFreeBlock());
+}
+
+TEST_CASE(HeapPoolGrowsByHeapSize)
+{
+    HeapPool pool(1 << 20, 4096);
+    bool newHeap = false;
+    const HeapAllocation first = pool.Allocate(768 * 1024, 4096, &newHeap);
+    CHECK(newHeap);
+    CHECK_EQUAL(0u, first.heapIndex);
+
+    const HeapAllocation second = pool.Allocate(512 * 1024, 4096, &newHeap);
+    CHECK(newHeap);
+    CHECK_EQUAL(1u, second.heapIndex);
+    CHECK_EQUAL(static_cast<uint64_t>(1 << 20), pool.GetHeapSize(1));
+
+    const HeapAllocation third = pool.Allocate(4096, 4096, &newHeap);
+    CHECK(!newHeap);
+    CHECK_EQUAL(1u, third.heapIndex);
+    CHECK_EQUAL(2u, static_cast<unsigned>(pool.GetHeapCount()));
+}
+
+TEST_CASE(HeapPoolGivesOversizedRequestsTheirOwnHeap)
+{
+    HeapPool pool(1 << 20, 4096);
+    bool newHeap = false;
+    const HeapAllocation large = pool.Allocate(3 << 20, 65536, &newHeap);
+    CHECK(newHeap);
+    CHECK_EQUAL(static_cast<uint64_t>(4 << 20), pool.GetHeapSize(large.heapIndex));
+
+    const HeapPoolStats stats = pool.GetStats();
+    CHECK_EQUAL(1ull, stats.heapCount);
+    CHECK_EQUAL(static_cast<uint64_t>(3 << 20), stats.requestedBytes);
+    CHECK_EQUAL(static_cast<uint64_t>(4 << 20), stats.allocatedBytes);
+}
+
+TEST_CASE(HeapPoolRemovesTheLastHeapOnlyWhenEmpty)
+{
+    HeapPool pool(1 << 20, 4096);
+    const HeapAllocation allocation = pool.Allocate(4096, 4096);
+    CHECK_THROWS(pool.RemoveEmptyLastHeap());
+    pool.Free(allocation);
+    pool.RemoveEmptyLastHeap();
+    CHECK_EQUAL(0u, static_cast<unsigned>(pool.GetHeapCount()));
+    CHECK_THROWS(pool.Free(allocation));
+}
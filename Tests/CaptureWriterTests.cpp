@@ -0,0 +1,80 @@
+#include "TestFramework.h"
+#include "CaptureWriter.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Scratch capture file, removed again on destruction
+    struct ScratchCaptureFile
+    {
+        fs::path path = fs::temp_directory_path() / "CaptureWriterTests.rcap";
+
+        ~ScratchCaptureFile()
+        {
+            std::error_code error;
+            fs::remove(path, error);
+        }
+    };
+
+    std::vector<uint8_t> MakeTexels(size_t size, uint8_t first)
+    {
+        std::vector<uint8_t> texels(size);
+        for (size_t i = 0; i < size; ++i)
+        {
+            texels[i] = static_cast<uint8_t>(first + i * 7);
+        }
+        return texels;
+    }
+}
+
+TEST_CASE(CaptureFileRoundTrip)
+{
+    ScratchCaptureFile file;
+    {
+        AsyncCaptureWriter writer(file.path.string());
+        CHECK(writer.Submit(16, 4, TexelFormat::R8, 42, MakeTexels(16 * 4, 1)));
+        CHECK(writer.Submit(3, 5, TexelFormat::R16, 0, MakeTexels(3 * 5 * 2, 9)));
+        writer.Flush();
+        CHECK_EQUAL(2ull, static_cast<unsigned long long>(writer.GetStats().written));
+    }
+
+    std::vector<CaptureRecord> records = ReadCaptureFile(file.path.string());
+    CHECK_EQUAL(2ull, static_cast<unsigned long long>(records.size()));
+    CHECK_EQUAL(16u, records[0].width);
+    CHECK_EQUAL(4u, records[0].height);
+    CHECK(records[0].format == TexelFormat::R8);
+    CHECK_EQUAL(42ull, static_cast<unsigned long long>(records[0].seed));
+    CHECK_EQUAL(0ull, static_cast<unsigned long long>(records[0].sequence));
+    CHECK(records[0].texels == MakeTexels(16 * 4, 1));
+
+    CHECK_EQUAL(3u, records[1].width);
+    CHECK_EQUAL(5u, records[1].height);
+    CHECK(records[1].format == TexelFormat::R16);
+    CHECK_EQUAL(1ull, static_cast<unsigned long long>(records[1].sequence));
+    CHECK(records[1].texels == MakeTexels(3 * 5 * 2, 9));
+}
+
+TEST_CASE(CaptureFileRejectsTruncatedAndForeignData)
+{
+    ScratchCaptureFile file;
+    {
+        AsyncCaptureWriter writer(file.path.string());
+        writer.Submit(8, 8, TexelFormat::R8, 1, MakeTexels(8 * 8, 0));
+        writer.Flush();
+    }
+    const uintmax_t fullSize = fs::file_size(file.path);
+    CHECK_EQUAL(static_cast<unsigned long long>(sizeof(CaptureRecordHeader) + 8 * 8), static_cast<unsigned long long>(fullSize));
+
+    // Cut inside the texels, then inside the header
+    fs::resize_file(file.path, fullSize - 1);
+    CHECK_THROWS(ReadCaptureFile(file.path.string()));
+    fs::resize_file(file.path, sizeof(CaptureRecordHeader) / 2);
+    CHECK_THROWS(ReadCaptureFile(file.path.string()));
+
+    std::ofstream(file.path, std::ios::binary | std::ios::trunc) << std::string(sizeof(CaptureRecordHeader), 'x');
+    CHECK_THROWS(ReadCaptureFile(file.path.string()));
+}
@@ -0,0 +1,81 @@
+#include "TestFramework.h"
+#include "ContentKeyedCache.h"
+#include "HashUtils.h"
+#include <string>
+#include <utility>
+
+namespace
+{
+    using PipelineKey = std::pair<uint64_t, uint64_t>;
+
+    // Keyed like PipelineCache: (root signature hash, bytecode hash) with the bytecode as content
+    PipelineKey MakePipelineKey(uint64_t rootSignatureHash, const std::string& bytecode)
+    {
+        return PipelineKey(rootSignatureHash, HashBytes(bytecode.data(), bytecode.size()));
+    }
+}
+
+TEST_CASE(ContentKeyedCacheDeduplicatesEqualContent)
+{
+    ContentKeyedCache<PipelineKey, int> cache("Pipeline state");
+    const std::string bytecode = "DXBC reduce 16x16";
+    const PipelineKey key = MakePipelineKey(1, bytecode);
+    CHECK(cache.Find(key, bytecode.data(), bytecode.size()) == nullptr);
+    cache.Insert(key, bytecode.data(), bytecode.size(), 7);
+
+    // A second copy of the same bytes finds the first entry
+    const std::string copy = bytecode;
+    int* cached = cache.Find(MakePipelineKey(1, copy), copy.data(), copy.size());
+    CHECK(cached != nullptr);
+    CHECK_EQUAL(7, *cached);
+    CHECK_EQUAL(size_t(1), cache.Size());
+}
+
+TEST_CASE(ContentKeyedCacheSeparatesKeys)
+{
+    ContentKeyedCache<PipelineKey, int> cache("Pipeline state");
+    const std::string first = "DXBC reduce 8x8";
+    const std::string second = "DXBC reduce 32x32";
+    cache.Insert(MakePipelineKey(1, first), first.data(), first.size(), 1);
+    cache.Insert(MakePipelineKey(1, second), second.data(), second.size(), 2);
+
+    // Same bytecode under another root signature is another pipeline
+    CHECK(cache.Find(MakePipelineKey(2, first), first.data(), first.size()) == nullptr);
+    cache.Insert(MakePipelineKey(2, first), first.data(), first.size(), 3);
+
+    CHECK_EQUAL(1, *cache.Find(MakePipelineKey(1, first), first.data(), first.size()));
+    CHECK_EQUAL(2, *cache.Find(MakePipelineKey(1, second), second.data(), second.size()));
+    CHECK_EQUAL(3, *cache.Find(MakePipelineKey(2, first), first.data(), first.size()));
+    CHECK_EQUAL(size_t(3), cache.Size());
+}
+
+TEST_CASE(ContentKeyedCacheDetectsHashCollisions)
+{
+    // Forced collisions: equal keys over different bytes, of equal and of different size
+    ContentKeyedCache<PipelineKey, int> cache("Pipeline state");
+    const std::string stored = "DXBC reduce 16x16";
+    const PipelineKey key(1, 42);
+    cache.Insert(key, stored.data(), stored.size(), 1);
+
+    const std::string sameSize = "DXBC reduce 32x32";
+    const std::string longer = "DXBC reduce 16x16 with more bytes";
+    const std::string prefix = "DXBC";
+    CHECK_THROWS(cache.Find(key, sameSize.data(), sameSize.size()));
+    CHECK_THROWS(cache.Find(key, longer.data(), longer.size()));
+    CHECK_THROWS(cache.Find(key, prefix.data(), prefix.size()));
+    CHECK_EQUAL(1, *cache.Find(key, stored.data(), stored.size()));
+
+    // Root signatures are keyed by the blob hash alone
+    ContentKeyedCache<uint64_t, int> rootSignatures("Root signature");
+    rootSignatures.Insert(5, stored.data(), stored.size(), 1);
+    CHECK_THROWS(rootSignatures.Find(5, sameSize.data(), sameSize.size()));
+}
+
+TEST_CASE(ContentKeyedCacheRejectsDuplicateInsert)
+{
+    ContentKeyedCache<uint64_t, int> cache("Root signature");
+    const std::string blob = "root signature";
+    cache.Insert(1, blob.data(), blob.size(), 1);
+    CHECK_THROWS(cache.Insert(1, blob.data(), blob.size(), 2));
+    CHECK_EQUAL(1, *cache.Find(1, blob.data(), blob.size()));
+}
@@ -0,0 +1,92 @@
+#include "TestFramework.h"
+#include "DescriptorAllocator.h"
+
+TEST_CASE(FreeListCoalescesNeighbours)
+{
+    DescriptorFreeListAllocator allocator(100, 30);
+    const uint32_t a = allocator.Allocate(10);
+    const uint32_t b = allocator.Allocate(10);
+    const uint32_t c = allocator.Allocate(10);
+    CHECK_EQUAL(100u, a);
+    CHECK_EQUAL(110u, b);
+    CHECK_EQUAL(120u, c);
+    CHECK_EQUAL(InvalidDescriptorOffset, allocator.Allocate(1));
+
+    // a and c stay separate blocks, freeing b merges all three
+    allocator.Free(a, 10);
+    allocator.Free(c, 10);
+    CHECK_EQUAL(2u, static_cast<unsigned>(allocator.GetFreeBlockCount()));
+    CHECK_EQUAL(10u, allocator.GetLargestFreeBlock());
+    CHECK_EQUAL(InvalidDescriptorOffset, allocator.Allocate(11));
+    allocator.Free(b, 10);
+    CHECK_EQUAL(1u, static_cast<unsigned>(allocator.GetFreeBlockCount()));
+    CHECK_EQUAL(30u, allocator.GetLargestFreeBlock());
+    CHECK_EQUAL(100u, allocator.Allocate(30));
+}
+
+TEST_CASE(FreeListFirstFitReusesHoles)
+{
+    DescriptorFreeListAllocator allocator(0, 16);
+    const uint32_t a = allocator.Allocate(4);
+    allocator.Allocate(4);
+    allocator.Free(a, 4);
+    CHECK_EQUAL(0u, allocator.Allocate(2));
+    CHECK_EQUAL(2u, allocator.Allocate(2));
+    CHECK_EQUAL(8u, allocator.Allocate(3));
+    CHECK_EQUAL(5u, allocator.GetFreeCount());
+}
+
+TEST_CASE(FreeListRejectsBadFrees)
+{
+    DescriptorFreeListAllocator allocator(8, 16);
+    const uint32_t a = allocator.Allocate(4);
+    allocator.Free(a, 4);
+    CHECK_THROWS(allocator.Free(a, 4));
+    CHECK_THROWS(allocator.Free(4, 2));
+    CHECK_THROWS(allocator.Free(20, 8));
+    // count beyond the capacity must not slip through an unsigned underflow
+    CHECK_THROWS(allocator.Free(8, 17));
+    CHECK_THROWS(allocator.Free(9, 0xffffffffu));
+    CHECK_EQUAL(16u, allocator.GetFreeCount());
+}
+
+TEST_CASE(RingWrapsAroundAndSkipsShortTail)
+{
+    DescriptorRingAllocator ring(64, 10);
+    CHECK_EQUAL(64u, ring.Allocate(4));
+    ring.Retire(1);
+    CHECK_EQUAL(68u, ring.Allocate(4));
+    ring.Retire(2);
+    CHECK_EQUAL(8u, ring.GetUsedCount());
+
+    // Two slots left at the end and none at the start until fence 1 completes
+    CHECK_EQUAL(InvalidDescriptorOffset, ring.Allocate(3));
+    ring.Release(1);
+    CHECK_EQUAL(4u, ring.GetUsedCount());
+
+    // The short tail is skipped, the range starts at the base again
+    CHECK_EQUAL(64u, ring.Allocate(3));
+    CHECK_EQUAL(9u, ring.GetUsedCount());
+    ring.Retire(3);
+
+    uint64_t oldest = 0;
+    CHECK(ring.GetOldestFenceValue(oldest));
+    CHECK_EQUAL(2ull, oldest);
+    ring.Release(2);
+    CHECK_EQUAL(5u, ring.GetUsedCount());
+    ring.Release(3);
+    CHECK_EQUAL(0u, ring.GetUsedCount());
+    CHECK(!ring.GetOldestFenceValue(oldest));
+    CHECK_EQUAL(64u, ring.Allocate(10));
+}
+
+TEST_CASE(RingRejectsOversizedAndDecreasingFences)
+{
+    DescriptorRingAllocator ring(0, 8);
+    CHECK_EQUAL(InvalidDescriptorOffset, ring.Allocate(9));
+    CHECK_EQUAL(InvalidDescriptorOffset, ring.Allocate(0));
+    ring.Allocate(2);
+    ring.Retire(5);
+    ring.Allocate(2);
+    CHECK_THROWS(ring.Retire(4));
+}
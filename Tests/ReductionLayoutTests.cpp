@@ -0,0 +1,70 @@
+#include "TestFramework.h"
+#include "ReductionLayout.h"
+#include <vector>
+
+TEST_CASE(LayoutOfExactMultiple)
+{
+    const ReductionLayout layout = MakeReductionLayout(64, 32, 16);
+    CHECK_EQUAL(16u, layout.threadGroupSize);
+    CHECK_EQUAL(64u, layout.constants.textureWidth);
+    CHECK_EQUAL(32u, layout.constants.textureHeight);
+    CHECK_EQUAL(4u, layout.constants.groupsX);
+    CHECK_EQUAL(2u, layout.constants.groupsY);
+    CHECK_EQUAL(8u, layout.partialCount);
+}
+
+TEST_CASE(LayoutCoversPartialEdgeTiles)
+{
+    // One texel past a tile boundary adds a row and a column of groups
+    const ReductionLayout layout = MakeReductionLayout(33, 17, 16);
+    CHECK_EQUAL(3u, layout.constants.groupsX);
+    CHECK_EQUAL(2u, layout.constants.groupsY);
+    CHECK_EQUAL(6u, layout.partialCount);
+
+    const ReductionLayout small = MakeReductionLayout(5, 3, 32);
+    CHECK_EQUAL(1u, small.constants.groupsX);
+    CHECK_EQUAL(1u, small.constants.groupsY);
+    CHECK_EQUAL(1u, small.partialCount);
+
+    const ReductionLayout column = MakeReductionLayout(1, 100, 8);
+    CHECK_EQUAL(1u, column.constants.groupsX);
+    CHECK_EQUAL(13u, column.constants.groupsY);
+}
+
+TEST_CASE(LayoutOfEmptyTextureHasNoPartials)
+{
+    CHECK_EQUAL(0u, MakeReductionLayout(0, 64, 16).partialCount);
+    CHECK_EQUAL(0u, MakeReductionLayout(64, 0, 16).partialCount);
+}
+
+TEST_CASE(PartialIndexIsRowMajorOverGroups)
+{
+    const ReductionLayout layout = MakeReductionLayout(100, 70, 16);
+    CHECK_EQUAL(7u, layout.constants.groupsX);
+    CHECK_EQUAL(5u, layout.constants.groupsY);
+    CHECK_EQUAL(0u, GetPartialIndex(layout.constants, 0, 0));
+    CHECK_EQUAL(6u, GetPartialIndex(layout.constants, 6, 0));
+    CHECK_EQUAL(7u, GetPartialIndex(layout.constants, 0, 1));
+    CHECK_EQUAL(layout.partialCount - 1, GetPartialIndex(layout.constants, 6, 4));
+
+    // Every group writes its own element of the intermediate buffer
+    std::vector<int> writes(layout.partialCount, 0);
+    for (uint32_t y = 0; y < layout.constants.groupsY; ++y)
+    {
+        for (uint32_t x = 0; x < layout.constants.groupsX; ++x)
+        {
+            ++writes[GetPartialIndex(layout.constants, x, y)];
+        }
+    }
+    for (int count : writes)
+    {
+        CHECK_EQUAL(1, count);
+    }
+}
+
+TEST_CASE(ConstantsMatchRootParameter)
+{
+    // Four 32 bit root constants at b0, parameter 2 after the SRV and UAV tables
+    CHECK_EQUAL(4u, ReductionConstantsCount);
+    CHECK_EQUAL(2u, ReductionConstantsRootParameter);
+}
@@ -0,0 +1,130 @@
+#include "TestFramework.h"
+#include "ReductionResourceCache.h"
+#include "SubmissionScheduler.h"
+#include <memory>
+#include <set>
+#include <string>
+
+namespace
+{
+    // Stands in for the placed resources of a cache entry, records its destruction
+    class MockResource
+    {
+    public:
+        MockResource(std::string name, std::shared_ptr<std::set<std::string>> released)
+            : m_name(std::move(name)), m_released(std::move(released))
+        {
+        }
+        MockResource(MockResource&& other) noexcept
+            : m_name(std::move(other.m_name)), m_released(std::move(other.m_released))
+        {
+        }
+        ~MockResource()
+        {
+            if (m_released)
+            {
+                m_released->insert(m_name);
+            }
+        }
+
+        MockResource(const MockResource&) = delete;
+        MockResource& operator=(const MockResource&) = delete;
+        MockResource& operator=(MockResource&&) = delete;
+
+    private:
+        std::string m_name;
+        std::shared_ptr<std::set<std::string>> m_released;
+    };
+
+    ReductionResourceKey MakeKey(uint32_t size)
+    {
+        return { size, size, 61, 16, 0 };
+    }
+}
+
+TEST_CASE(CacheEvictsLeastRecentlyUsed)
+{
+    auto released = std::make_shared<std::set<std::string>>();
+    LruResourceCache<ReductionResourceKey, MockResource> cache(2, 0);
+    cache.Insert(MakeKey(64), MockResource("64", released), 100);
+    cache.Insert(MakeKey(128), MockResource("128", released), 100);
+    CHECK(cache.Find(MakeKey(64)) != nullptr);
+
+    // 128 is the least recently used entry now, nothing uses it so it goes right away
+    cache.Insert(MakeKey(256), MockResource("256", released), 100);
+    CHECK_EQUAL(1u, static_cast<unsigned>(released->count("128")));
+    CHECK_EQUAL(2u, static_cast<unsigned>(cache.Size()));
+    CHECK(cache.Find(MakeKey(128)) == nullptr);
+
+    const ResourceCacheStats& stats = cache.GetStats();
+    CHECK_EQUAL(1ull, static_cast<unsigned long long>(stats.hits));
+    CHECK_EQUAL(1ull, static_cast<unsigned long long>(stats.misses));
+    CHECK_EQUAL(1ull, static_cast<unsigned long long>(stats.evictions));
+    CHECK_EQUAL(200ull, static_cast<unsigned long long>(stats.bytes));
+}
+
+TEST_CASE(CacheKeepsEvictedResourcesUntilTheirFence)
+{
+    auto released = std::make_shared<std::set<std::string>>();
+    SimulatedSubmissionQueue queue([](uint64_t) { return 5.0; });
+    SubmissionScheduler scheduler(queue, 3);
+    LruResourceCache<ReductionResourceKey, MockResource> cache(1, 0);
+
+    // Two jobs in flight on the 64 entry, like ReductionContext::Submit
+    cache.Insert(MakeKey(64), MockResource("64", released), 100);
+    for (int i = 0; i < 2; ++i)
+    {
+        ScopedSubmissionJob job(scheduler);
+        cache.MarkUsed(MakeKey(64), job.End());
+    }
+
+    // Evicted while ticket 2 is on the queue: retired, not destroyed
+    cache.Insert(MakeKey(128), MockResource("128", released), 100);
+    cache.Release(queue.GetCompletedValue());
+    CHECK_EQUAL(0u, static_cast<unsigned>(released->size()));
+    CHECK_EQUAL(1u, static_cast<unsigned>(cache.GetRetiredCount()));
+    CHECK_EQUAL(100ull, static_cast<unsigned long long>(cache.GetStats().bytes));
+
+    uint64_t fenceValue = 0;
+    CHECK(cache.GetOldestRetiredFenceValue(fenceValue));
+    CHECK_EQUAL(2ull, static_cast<unsigned long long>(fenceValue));
+
+    scheduler.Wait(1);
+    cache.Release(queue.GetCompletedValue());
+    CHECK_EQUAL(0u, static_cast<unsigned>(released->size()));
+    scheduler.Wait(2);
+    cache.Release(queue.GetCompletedValue());
+    CHECK_EQUAL(1u, static_cast<unsigned>(released->count("64")));
+    CHECK_EQUAL(0u, static_cast<unsigned>(cache.GetRetiredCount()));
+    CHECK(!cache.GetOldestRetiredFenceValue(fenceValue));
+}
+
+TEST_CASE(CacheClearRetiresEntriesInFlight)
+{
+    auto released = std::make_shared<std::set<std::string>>();
+    LruResourceCache<ReductionResourceKey, MockResource> cache(4, 0);
+    cache.Insert(MakeKey(64), MockResource("64", released), 100);
+    cache.Insert(MakeKey(128), MockResource("128", released), 100);
+    cache.Insert(MakeKey(256), MockResource("256", released), 100);
+    cache.MarkUsed(MakeKey(64), 3);
+    cache.MarkUsed(MakeKey(256), 5);
+    cache.MarkUsed(MakeKey(256), 4);        // never lowers the fence value
+
+    cache.Clear();
+    CHECK_EQUAL(0u, static_cast<unsigned>(cache.Size()));
+    CHECK_EQUAL(1u, static_cast<unsigned>(released->count("128")));
+    CHECK_EQUAL(2u, static_cast<unsigned>(cache.GetRetiredCount()));
+
+    cache.Release(4);
+    CHECK_EQUAL(1u, static_cast<unsigned>(released->count("64")));
+    CHECK_EQUAL(0u, static_cast<unsigned>(released->count("256")));
+
+    // Once fence 5 is known to be complete, later evictions of entries used up to it are immediate
+    cache.Release(5);
+    CHECK_EQUAL(3u, static_cast<unsigned>(released->size()));
+    cache.Insert(MakeKey(512), MockResource("512", released), 100);
+    cache.MarkUsed(MakeKey(512), 5);
+    CHECK(cache.EvictLeastRecentlyUsed());
+    CHECK_EQUAL(1u, static_cast<unsigned>(released->count("512")));
+    CHECK(!cache.EvictLeastRecentlyUsed());
+}
@@ -0,0 +1,237 @@
+#include "TestFramework.h"
+#include "RegressionGate.h"
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Scratch result file, removed again on destruction
+    struct ScratchResultFile
+    {
+        fs::path path = fs::temp_directory_path() / "RegressionGateTests.txt";
+
+        ~ScratchResultFile()
+        {
+            std::error_code error;
+            fs::remove(path, error);
+        }
+
+        void Write(const std::string& contents) const
+        {
+            std::ofstream(path, std::ios::binary | std::ios::trunc) << contents;
+        }
+    };
+
+    bool IsNear(double expected, double actual)
+    {
+        return std::fabs(expected - actual) < 1e-9;
+    }
+
+    // Nine samples around medianMs, 1/128 ms apart, so the median is exact and two sets 1/8 ms apart do not overlap
+    std::vector<double> MakeSamples(double medianMs)
+    {
+        std::vector<double> samples;
+        for (int k = -4; k <= 4; ++k)
+        {
+            samples.push_back(medianMs + k / 128.0);
+        }
+        return samples;
+    }
+
+    BenchmarkResult MakeResult(uint32_t width, const std::vector<double>& samplesMs)
+    {
+        BenchmarkResult result;
+        result.backend = "cpu";
+        result.strategy = "partials";
+        result.distribution = "uniform";
+        result.width = width;
+        result.height = width;
+        result.threadGroupSize = 16;
+        result.samplesMs = samplesMs;
+        return result;
+    }
+
+    RegressionVerdict CompareOne(const std::vector<double>& baseline, const std::vector<double>& candidate, const RegressionGateOptions& options)
+    {
+        const std::vector<RegressionComparison> comparisons = CompareBenchmarkResults({ MakeResult(64, baseline) }, { MakeResult(64, candidate) }, options);
+        return comparisons.size() == 1 ? comparisons[0].verdict : RegressionVerdict::MissingBaseline;
+    }
+}
+
+TEST_CASE(MannWhitneyWithoutTies)
+{
+    // U counts the pairs a wins; reference values of the tie and continuity corrected normal approximation
+    const MannWhitneyResult separated = MannWhitneyU({ 1, 2, 3 }, { 4, 5, 6 });
+    CHECK(IsNear(0.0, separated.u));
+    CHECK(IsNear(-1.7457431218879391, separated.z));
+    CHECK(IsNear(0.0808555983700523, separated.pValue));
+
+    const MannWhitneyResult reversed = MannWhitneyU({ 4, 5, 6 }, { 1, 2, 3 });
+    CHECK(IsNear(9.0, reversed.u));
+    CHECK(IsNear(-separated.z, reversed.z));
+    CHECK(IsNear(separated.pValue, reversed.pValue));
+}
+
+TEST_CASE(MannWhitneyWithTies)
+{
+    // Tied pairs count half: 2 ties with three values, 3 with two
+    const MannWhitneyResult tied = MannWhitneyU({ 1, 2, 2, 3 }, { 2, 3, 4, 5 });
+    CHECK(IsNear(2.5, tied.u));
+    CHECK(IsNear(-1.4883513944689681, tied.z));
+    CHECK(IsNear(0.13665824773814753, tied.pValue));
+
+    // Nothing but ties has no variance and cannot reject anything
+    const MannWhitneyResult allTied = MannWhitneyU({ 3, 3, 3 }, { 3, 3, 3 });
+    CHECK(IsNear(4.5, allTied.u));
+    CHECK(IsNear(1.0, allTied.pValue));
+    CHECK(IsNear(1.0, MannWhitneyU({}, { 1, 2 }).pValue));
+}
+
+TEST_CASE(LegacyStatsLoadPerConfiguration)
+{
+    // Layout of the checked-in stats.txt, plus a CPU run with CRLF line ends and a harness summary without runs
+    ScratchResultFile file;
+    file.Write(
+        "Texture Size: 64x64\n"
+        "Thread Group Size: 8x8\n"
+        "GPU Time: 0.0122917 ms\n"
+        "GPU Time: 0.0173958 ms\n"
+        "GPU Time: 0.0200521 ms\n"
+        "Final Max Value: 99\n"
+        "----------------------------------------------------\n"
+        "Thread Group Size: 16x16\n"
+        "GPU Time: 0.0140104 ms\n"
+        "Final Max Value: 98\n"
+        "----------------------------------------------------\n"
+        "Texture Size: 128x64\r\n"
+        "Thread Group Size: 32x32\r\n"
+        "CPU Time: 0.5 ms\r\n"
+        "CPU Time: 0.25 ms\r\n"
+        "Final Max Value: 97\r\n"
+        "Thread Group Size: 8x8\n"
+        "GPU Time: median 0.1 ms\n");
+
+    const std::vector<BenchmarkResult> results = LoadBenchmarkResults(file.path.string());
+    CHECK_EQUAL(size_t(3), results.size());
+    CHECK_EQUAL(std::string("d3d12"), results[0].backend);
+    CHECK_EQUAL(std::string("partials"), results[0].strategy);
+    CHECK_EQUAL(std::string("uniform"), results[0].distribution);
+    CHECK_EQUAL(64u, results[0].width);
+    CHECK_EQUAL(64u, results[0].height);
+    CHECK_EQUAL(8u, results[0].threadGroupSize);
+    CHECK_EQUAL(size_t(3), results[0].samplesMs.size());
+    CHECK(IsNear(0.0173958, results[0].samplesMs[1]));
+    CHECK_EQUAL(99u, results[0].maxValue);
+
+    CHECK_EQUAL(16u, results[1].threadGroupSize);
+    CHECK_EQUAL(98u, results[1].maxValue);
+
+    CHECK_EQUAL(std::string("cpu"), results[2].backend);
+    CHECK_EQUAL(128u, results[2].width);
+    CHECK_EQUAL(64u, results[2].height);
+    CHECK_EQUAL(32u, results[2].threadGroupSize);
+    CHECK_EQUAL(size_t(2), results[2].samplesMs.size());
+    CHECK(IsNear(0.25, results[2].samplesMs[1]));
+}
+
+TEST_CASE(JsonResultsLoadBack)
+{
+    ScratchResultFile file;
+    BenchmarkResult written = MakeResult(256, { 1.5, 2.25, 1.75 });
+    written.maxValue = 255;
+    std::ostringstream json;
+    WriteBenchmarkJson(json, { written });
+    file.Write(json.str());
+
+    const std::vector<BenchmarkResult> results = LoadBenchmarkResults(file.path.string());
+    CHECK_EQUAL(size_t(1), results.size());
+    CHECK_EQUAL(std::string("cpu"), results[0].backend);
+    CHECK_EQUAL(256u, results[0].width);
+    CHECK_EQUAL(255u, results[0].maxValue);
+    CHECK_EQUAL(size_t(3), results[0].samplesMs.size());
+    CHECK(IsNear(2.25, results[0].samplesMs[1]));
+}
+
+TEST_CASE(RegressionVerdictAtThresholdBoundary)
+{
+    // Medians 1 and 1.125 ms: exactly 12.5% slower, fully separated samples
+    const std::vector<double> baseline = MakeSamples(1.0);
+    const std::vector<double> slower = MakeSamples(1.125);
+    RegressionGateOptions options;
+    options.alpha = 0.01;
+
+    options.thresholdPercent = 12.5;
+    CHECK(CompareOne(baseline, slower, options) == RegressionVerdict::Unchanged);
+    CHECK(CompareOne(slower, baseline, options) == RegressionVerdict::Unchanged);
+
+    options.thresholdPercent = 12.4;
+    CHECK(CompareOne(baseline, slower, options) == RegressionVerdict::Regressed);
+
+    // 1.125 -> 1 is 11.1% faster
+    options.thresholdPercent = 11.2;
+    CHECK(CompareOne(slower, baseline, options) == RegressionVerdict::Unchanged);
+    options.thresholdPercent = 11.1;
+    CHECK(CompareOne(slower, baseline, options) == RegressionVerdict::Improved);
+}
+
+TEST_CASE(RegressionVerdictAtAlphaBoundary)
+{
+    const std::vector<double> baseline = MakeSamples(1.0);
+    const std::vector<double> slower = MakeSamples(1.125);
+    const double pValue = MannWhitneyU(slower, baseline).pValue;
+    CHECK(pValue > 0.0 && pValue < 0.01);
+
+    // The test has to reject at alpha, p == alpha does not
+    RegressionGateOptions options;
+    options.thresholdPercent = 5.0;
+    options.alpha = pValue;
+    CHECK(CompareOne(baseline, slower, options) == RegressionVerdict::Unchanged);
+    CHECK(CompareOne(slower, baseline, options) == RegressionVerdict::Unchanged);
+    options.alpha = pValue * 1.001;
+    CHECK(CompareOne(baseline, slower, options) == RegressionVerdict::Regressed);
+    CHECK(CompareOne(slower, baseline, options) == RegressionVerdict::Improved);
+
+    // Same shift hidden in noise
+    std::vector<double> noisy = baseline;
+    noisy.push_back(1.2);
+    noisy.push_back(1.25);
+    CHECK(CompareOne(noisy, slower, RegressionGateOptions()) == RegressionVerdict::Unchanged);
+}
+
+TEST_CASE(RegressionVerdictForMissingConfigurations)
+{
+    const std::vector<BenchmarkResult> baseline = { MakeResult(64, MakeSamples(1.0)), MakeResult(128, MakeSamples(2.0)) };
+    const std::vector<BenchmarkResult> candidate = { MakeResult(64, MakeSamples(1.0)), MakeResult(256, MakeSamples(4.0)) };
+    const std::vector<RegressionComparison> comparisons = CompareBenchmarkResults(baseline, candidate, RegressionGateOptions());
+    CHECK_EQUAL(size_t(3), comparisons.size());
+
+    int unchanged = 0;
+    for (const RegressionComparison& comparison : comparisons)
+    {
+        if (comparison.configuration == "cpu/partials/uniform 128x128 group 16")
+        {
+            CHECK(comparison.verdict == RegressionVerdict::MissingCandidate);
+        }
+        else if (comparison.configuration == "cpu/partials/uniform 256x256 group 16")
+        {
+            CHECK(comparison.verdict == RegressionVerdict::MissingBaseline);
+        }
+        else
+        {
+            CHECK(comparison.verdict == RegressionVerdict::Unchanged);
+            ++unchanged;
+        }
+    }
+    CHECK_EQUAL(1, unchanged);
+
+    // Missing configurations are reported, but only a regression fails the gate
+    std::ostringstream report;
+    CHECK(!WriteRegressionReport(report, comparisons));
+    CHECK(WriteRegressionReport(report, CompareBenchmarkResults({ MakeResult(64, MakeSamples(1.0)) }, { MakeResult(64, MakeSamples(1.125)) }, RegressionGateOptions())));
+}
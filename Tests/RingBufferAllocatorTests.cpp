@@ -0,0 +1,74 @@
+#include "TestFramework.h"
+#include "RingBufferAllocator.h"
+
+TEST_CASE(RingBufferReleasesInFenceOrder)
+{
+    RingBufferAllocator ring(1024);
+    CHECK_EQUAL(0ull, static_cast<unsigned long long>(ring.Allocate(100)));
+    ring.Retire(1);
+    CHECK_EQUAL(512ull, static_cast<unsigned long long>(ring.Allocate(100, 512)));
+    ring.Retire(2);
+    CHECK_EQUAL(612ull, static_cast<unsigned long long>(ring.GetUsedBytes()));
+
+    ring.Release(1);
+    CHECK_EQUAL(512ull, static_cast<unsigned long long>(ring.GetUsedBytes()));
+    ring.Release(2);
+    CHECK_EQUAL(0ull, static_cast<unsigned long long>(ring.GetUsedBytes()));
+}
+
+TEST_CASE(RingBufferSkipsShortTail)
+{
+    RingBufferAllocator ring(1000);
+    ring.Allocate(400);
+    ring.Retire(1);
+    ring.Allocate(400);
+    ring.Retire(2);
+    ring.Release(1);
+
+    // 200 bytes left at the end, the allocation goes to the start and owns the skipped tail
+    CHECK_EQUAL(0ull, static_cast<unsigned long long>(ring.Allocate(300)));
+    CHECK_EQUAL(900ull, static_cast<unsigned long long>(ring.GetUsedBytes()));
+    CHECK_EQUAL(InvalidRingOffset, ring.Allocate(200));
+    ring.Retire(3);
+    ring.Release(2);
+    CHECK_EQUAL(500ull, static_cast<unsigned long long>(ring.GetUsedBytes()));
+}
+
+TEST_CASE(RingBufferExtendKeepsSharedAllocation)
+{
+    RingBufferAllocator ring(1024);
+    const uint64_t shared = ring.Allocate(256);
+    ring.Retire(1);
+    const uint64_t next = ring.Allocate(256);
+    ring.Retire(2);
+
+    // A second submission reads the first allocation, it stays until fence 3
+    ring.Extend(shared, 3);
+    uint64_t oldest = 0;
+    CHECK(ring.GetOldestFenceValue(oldest));
+    CHECK_EQUAL(3ull, static_cast<unsigned long long>(oldest));
+    ring.Release(2);
+    CHECK_EQUAL(512ull, static_cast<unsigned long long>(ring.GetUsedBytes()));
+    ring.Release(3);
+    CHECK_EQUAL(0ull, static_cast<unsigned long long>(ring.GetUsedBytes()));
+
+    // Extending never lowers a fence value, and released memory cannot be extended
+    const uint64_t again = ring.Allocate(128);
+    ring.Retire(5);
+    ring.Extend(again, 4);
+    CHECK(ring.GetOldestFenceValue(oldest));
+    CHECK_EQUAL(5ull, static_cast<unsigned long long>(oldest));
+    CHECK_THROWS(ring.Extend(next + 128, 6));
+}
+
+TEST_CASE(RingBufferExtendOfPendingAllocationWaitsForRetire)
+{
+    RingBufferAllocator ring(1024);
+    const uint64_t offset = ring.Allocate(64);
+    ring.Extend(offset, 7);
+    uint64_t oldest = 0;
+    CHECK(!ring.GetOldestFenceValue(oldest));
+    ring.Retire(8);
+    CHECK(ring.GetOldestFenceValue(oldest));
+    CHECK_EQUAL(8ull, static_cast<unsigned long long>(oldest));
+}
@@ -0,0 +1,246 @@
+#include "TestFramework.h"
+#include "ShaderArchive.h"
+#include <cstddef>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Scratch archive file, removed again on destruction
+    struct ScratchArchiveFile
+    {
+        fs::path path = fs::temp_directory_path() / "ShaderArchiveTests.rsha";
+
+        ~ScratchArchiveFile()
+        {
+            std::error_code error;
+            fs::remove(path, error);
+        }
+    };
+
+    const unsigned char BufferReductionBlob[] = { 1, 2, 3, 4, 5 };
+    const unsigned char MaxReduction8Blob[] = { 9 };
+    const unsigned char MaxReduction16Blob[] =
+    {
+        10, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25,
+        26, 27, 28, 29, 30, 31, 32, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42
+    };
+
+    // Deliberately out of order, WriteShaderArchive sorts them
+    void WriteTestArchive(const fs::path& path)
+    {
+        WriteShaderArchive(path.string(),
+            {
+                { ShaderKernel::BufferReduction, 64, BufferReductionBlob, sizeof(BufferReductionBlob) },
+                { ShaderKernel::MaxReduction, 16, MaxReduction16Blob, sizeof(MaxReduction16Blob) },
+                { ShaderKernel::MaxReduction, 8, MaxReduction8Blob, sizeof(MaxReduction8Blob) },
+            });
+    }
+
+    std::vector<uint8_t> ReadBytes(const fs::path& path)
+    {
+        std::ifstream file(path, std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    void WriteBytes(const fs::path& path, const std::vector<uint8_t>& bytes)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    ShaderArchiveEntry ReadEntry(const std::vector<uint8_t>& bytes, size_t index)
+    {
+        ShaderArchiveEntry entry;
+        std::memcpy(&entry, bytes.data() + sizeof(ShaderArchiveHeader) + index * sizeof(entry), sizeof(entry));
+        return entry;
+    }
+
+    void WriteEntry(std::vector<uint8_t>& bytes, size_t index, const ShaderArchiveEntry& entry)
+    {
+        std::memcpy(bytes.data() + sizeof(ShaderArchiveHeader) + index * sizeof(entry), &entry, sizeof(entry));
+    }
+
+    bool HasBytecode(const ShaderPermutation* permutation, const unsigned char* bytecode, size_t size)
+    {
+        return permutation != nullptr && permutation->bytecodeSize == size && std::memcmp(permutation->bytecode, bytecode, size) == 0;
+    }
+}
+
+TEST_CASE(ShaderArchiveRoundTrip)
+{
+    ScratchArchiveFile scratch;
+    WriteTestArchive(scratch.path);
+
+    ShaderArchive archive(scratch.path.string());
+    CHECK_EQUAL(size_t(3), archive.GetPermutationCount());
+
+    const ShaderPermutation* max8 = archive.Find(ShaderKernel::MaxReduction, 8);
+    const ShaderPermutation* max16 = archive.Find(ShaderKernel::MaxReduction, 16);
+    const ShaderPermutation* buffer = archive.Find(ShaderKernel::BufferReduction, 64);
+    CHECK(HasBytecode(max8, MaxReduction8Blob, sizeof(MaxReduction8Blob)));
+    CHECK(HasBytecode(max16, MaxReduction16Blob, sizeof(MaxReduction16Blob)));
+    CHECK(HasBytecode(buffer, BufferReductionBlob, sizeof(BufferReductionBlob)));
+    CHECK(max8 != nullptr && max8->kernel == ShaderKernel::MaxReduction && max8->threadGroupSize == 8);
+
+    CHECK(archive.Find(ShaderKernel::MaxReduction, 32) == nullptr);
+    CHECK(archive.Find(ShaderKernel::AtomicMaxReduction, 8) == nullptr);
+    CHECK(archive.Find(ShaderKernel::BufferReduction, 8) == nullptr);
+}
+
+TEST_CASE(ShaderArchiveIndexIsSortedAndBlobsAligned)
+{
+    ScratchArchiveFile scratch;
+    WriteTestArchive(scratch.path);
+    const std::vector<uint8_t> bytes = ReadBytes(scratch.path);
+
+    ShaderArchiveHeader header;
+    std::memcpy(&header, bytes.data(), sizeof(header));
+    CHECK_EQUAL(ShaderArchiveMagic, header.magic);
+    CHECK_EQUAL(ShaderArchiveVersion, header.version);
+    CHECK_EQUAL(3u, header.entryCount);
+
+    const uint32_t expectedKernels[] = { 0, 0, 2 };
+    const uint32_t expectedSizes[] = { 8, 16, 64 };
+    for (size_t i = 0; i < 3; ++i)
+    {
+        const ShaderArchiveEntry entry = ReadEntry(bytes, i);
+        CHECK_EQUAL(expectedKernels[i], entry.kernel);
+        CHECK_EQUAL(expectedSizes[i], entry.threadGroupSize);
+        CHECK_EQUAL(uint64_t(0), entry.offset % ShaderArchiveAlignment);
+        CHECK(entry.offset + entry.size <= bytes.size());
+    }
+}
+
+TEST_CASE(WriteShaderArchiveRejectsDuplicates)
+{
+    ScratchArchiveFile scratch;
+    CHECK_THROWS(WriteShaderArchive(scratch.path.string(),
+        {
+            { ShaderKernel::MaxReduction, 8, MaxReduction8Blob, sizeof(MaxReduction8Blob) },
+            { ShaderKernel::MaxReduction, 8, MaxReduction16Blob, sizeof(MaxReduction16Blob) },
+        }));
+}
+
+TEST_CASE(ShaderArchiveRejectsTruncatedIndex)
+{
+    ScratchArchiveFile scratch;
+    WriteTestArchive(scratch.path);
+    const std::vector<uint8_t> bytes = ReadBytes(scratch.path);
+
+    // Ends halfway through the second entry
+    WriteBytes(scratch.path, std::vector<uint8_t>(bytes.begin(), bytes.begin() + sizeof(ShaderArchiveHeader) + sizeof(ShaderArchiveEntry) * 3 / 2));
+    CHECK_THROWS(ShaderArchive(scratch.path.string()));
+
+    // Ends inside the header
+    WriteBytes(scratch.path, std::vector<uint8_t>(bytes.begin(), bytes.begin() + sizeof(ShaderArchiveHeader) / 2));
+    CHECK_THROWS(ShaderArchive(scratch.path.string()));
+
+    // An entry count the file cannot hold
+    std::vector<uint8_t> overcounted = bytes;
+    const uint32_t entryCount = 0x10000000;
+    std::memcpy(overcounted.data() + offsetof(ShaderArchiveHeader, entryCount), &entryCount, sizeof(entryCount));
+    WriteBytes(scratch.path, overcounted);
+    CHECK_THROWS(ShaderArchive(scratch.path.string()));
+}
+
+TEST_CASE(ShaderArchiveRejectsWrongMagicAndVersion)
+{
+    ScratchArchiveFile scratch;
+    WriteTestArchive(scratch.path);
+    const std::vector<uint8_t> bytes = ReadBytes(scratch.path);
+
+    std::vector<uint8_t> badMagic = bytes;
+    badMagic[0] ^= 0xff;
+    WriteBytes(scratch.path, badMagic);
+    CHECK_THROWS(ShaderArchive(scratch.path.string()));
+
+    std::vector<uint8_t> badVersion = bytes;
+    const uint32_t version = ShaderArchiveVersion + 1;
+    std::memcpy(badVersion.data() + offsetof(ShaderArchiveHeader, version), &version, sizeof(version));
+    WriteBytes(scratch.path, badVersion);
+    CHECK_THROWS(ShaderArchive(scratch.path.string()));
+}
+
+TEST_CASE(ShaderArchiveRejectsEntryOutsideFile)
+{
+    ScratchArchiveFile scratch;
+    WriteTestArchive(scratch.path);
+    const std::vector<uint8_t> bytes = ReadBytes(scratch.path);
+
+    // Offset past the end
+    std::vector<uint8_t> patched = bytes;
+    ShaderArchiveEntry entry = ReadEntry(bytes, 1);
+    entry.offset = bytes.size() + 1;
+    WriteEntry(patched, 1, entry);
+    WriteBytes(scratch.path, patched);
+    CHECK_THROWS(ShaderArchive(scratch.path.string()));
+
+    // Starts inside, ends one byte past the end
+    patched = bytes;
+    entry = ReadEntry(bytes, 2);
+    entry.size = bytes.size() - entry.offset + 1;
+    WriteEntry(patched, 2, entry);
+    WriteBytes(scratch.path, patched);
+    CHECK_THROWS(ShaderArchive(scratch.path.string()));
+
+    // A size that wraps offset + size around
+    patched = bytes;
+    entry = ReadEntry(bytes, 0);
+    entry.size = ~uint64_t(0);
+    WriteEntry(patched, 0, entry);
+    WriteBytes(scratch.path, patched);
+    CHECK_THROWS(ShaderArchive(scratch.path.string()));
+
+    // Ending exactly at the end of the file is fine
+    patched = bytes;
+    entry = ReadEntry(bytes, 2);
+    entry.size = bytes.size() - entry.offset;
+    WriteEntry(patched, 2, entry);
+    WriteBytes(scratch.path, patched);
+    ShaderArchive archive(scratch.path.string());
+    CHECK_EQUAL(size_t(3), archive.GetPermutationCount());
+}
+
+TEST_CASE(ShaderArchiveRejectsUnsortedIndex)
+{
+    ScratchArchiveFile scratch;
+    WriteTestArchive(scratch.path);
+    const std::vector<uint8_t> bytes = ReadBytes(scratch.path);
+
+    std::vector<uint8_t> swapped = bytes;
+    WriteEntry(swapped, 0, ReadEntry(bytes, 1));
+    WriteEntry(swapped, 1, ReadEntry(bytes, 0));
+    WriteBytes(scratch.path, swapped);
+    CHECK_THROWS(ShaderArchive(scratch.path.string()));
+
+    // Duplicate keys are not sorted either
+    std::vector<uint8_t> duplicated = bytes;
+    WriteEntry(duplicated, 1, ReadEntry(bytes, 0));
+    WriteBytes(scratch.path, duplicated);
+    CHECK_THROWS(ShaderArchive(scratch.path.string()));
+}
+
+TEST_CASE(ShaderArchiveFindThrowsOnCorruptBlob)
+{
+    ScratchArchiveFile scratch;
+    WriteTestArchive(scratch.path);
+    std::vector<uint8_t> bytes = ReadBytes(scratch.path);
+    bytes[ReadEntry(bytes, 1).offset + 7] ^= 0x01;
+    WriteBytes(scratch.path, bytes);
+
+    // Blobs are only hashed on lookup, so the archive still opens
+    ShaderArchive archive(scratch.path.string());
+    CHECK_EQUAL(size_t(3), archive.GetPermutationCount());
+    CHECK_THROWS(archive.Find(ShaderKernel::MaxReduction, 16));
+    CHECK_THROWS(archive.Find(ShaderKernel::MaxReduction, 16));
+
+    // The other permutations are unaffected
+    CHECK(HasBytecode(archive.Find(ShaderKernel::MaxReduction, 8), MaxReduction8Blob, sizeof(MaxReduction8Blob)));
+    CHECK(HasBytecode(archive.Find(ShaderKernel::BufferReduction, 64), BufferReductionBlob, sizeof(BufferReductionBlob)));
+}
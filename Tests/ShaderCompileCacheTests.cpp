@@ -0,0 +1,182 @@
+#include "TestFramework.h"
+#include "ShaderCompileCache.h"
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Bytecode is the request's define values and source path, so every input change shows up in the output
+    class StubShaderCompiler : public IShaderCompiler
+    {
+    public:
+        std::string GetIdentity() const override { return m_identity; }
+
+        std::vector<uint8_t> Compile(const ShaderCompileRequest& request) override
+        {
+            ++m_compiles;
+            if (m_fail)
+            {
+                throw std::runtime_error("stub compile error");
+            }
+            std::string output = request.sourcePath + ":" + request.entryPoint;
+            for (const auto& define : request.defines)
+            {
+                output += ";" + define.first + "=" + define.second;
+            }
+            return std::vector<uint8_t>(output.begin(), output.end());
+        }
+
+        std::string m_identity = "stub 1";
+        int m_compiles = 0;
+        bool m_fail = false;
+    };
+
+    // Scratch directory with a shader and an include, removed again on destruction
+    struct ShaderSourceTree
+    {
+        fs::path root = fs::temp_directory_path() / "ShaderCompileCacheTests";
+
+        ShaderSourceTree()
+        {
+            fs::remove_all(root);
+            fs::create_directories(root / "include");
+            Write("Reduce.hlsl", "#include \"include/Common.hlsli\"\n[numthreads(THREAD_GROUP_SIZE, 1, 1)] void CSMain() {}\n");
+            Write("include/Common.hlsli", "#define COMMON 1\n");
+        }
+        ~ShaderSourceTree()
+        {
+            std::error_code error;
+            fs::remove_all(root, error);
+        }
+
+        void Write(const std::string& name, const std::string& text)
+        {
+            std::ofstream(root / name, std::ios::binary | std::ios::trunc) << text;
+        }
+
+        ShaderCompileRequest MakeRequest(uint32_t threadGroupSize) const
+        {
+            ShaderCompileRequest request;
+            request.sourcePath = (root / "Reduce.hlsl").string();
+            request.defines.push_back({ "THREAD_GROUP_SIZE", std::to_string(threadGroupSize) });
+            return request;
+        }
+
+        std::string CacheDirectory() const { return (root / "cache").string(); }
+    };
+
+    size_t CountEntries(const std::string& directory)
+    {
+        size_t count = 0;
+        for (const auto& entry : fs::directory_iterator(directory))
+        {
+            count += entry.path().extension() == ".bin";
+        }
+        return count;
+    }
+}
+
+TEST_CASE(ShaderCacheCompilesOncePerRequest)
+{
+    ShaderSourceTree tree;
+    StubShaderCompiler compiler;
+    ShaderCompileCache cache(tree.CacheDirectory());
+
+    bool hit = true;
+    const std::vector<uint8_t> first = cache.Compile(compiler, tree.MakeRequest(16), &hit);
+    CHECK(!hit);
+    CHECK_EQUAL(1, compiler.m_compiles);
+
+    const std::vector<uint8_t> second = cache.Compile(compiler, tree.MakeRequest(16), &hit);
+    CHECK(hit);
+    CHECK_EQUAL(1, compiler.m_compiles);
+    CHECK(first == second);
+
+    // A new process sees the stored entry
+    ShaderCompileCache reopened(tree.CacheDirectory());
+    CHECK(reopened.Compile(compiler, tree.MakeRequest(16), &hit) == first);
+    CHECK(hit);
+    CHECK_EQUAL(1ull, static_cast<unsigned long long>(cache.GetStats().stores));
+}
+
+TEST_CASE(ShaderCacheKeyCoversDefinesIncludesAndCompiler)
+{
+    ShaderSourceTree tree;
+    StubShaderCompiler compiler;
+    ShaderCompileCache cache(tree.CacheDirectory());
+    const uint64_t key = cache.ComputeKey(tree.MakeRequest(16), compiler.GetIdentity());
+
+    CHECK(cache.ComputeKey(tree.MakeRequest(32), compiler.GetIdentity()) != key);
+    CHECK(cache.ComputeKey(tree.MakeRequest(16), "stub 2") != key);
+
+    ShaderCompileRequest otherEntry = tree.MakeRequest(16);
+    otherEntry.entryPoint = "CSOther";
+    CHECK(cache.ComputeKey(otherEntry, compiler.GetIdentity()) != key);
+
+    // Editing a file the source includes gives a new key, restoring it the old one
+    tree.Write("include/Common.hlsli", "#define COMMON 2\n");
+    CHECK(cache.ComputeKey(tree.MakeRequest(16), compiler.GetIdentity()) != key);
+    tree.Write("include/Common.hlsli", "#define COMMON 1\n");
+    CHECK_EQUAL(key, cache.ComputeKey(tree.MakeRequest(16), compiler.GetIdentity()));
+
+    ShaderCompileRequest missing = tree.MakeRequest(16);
+    missing.sourcePath = (tree.root / "Missing.hlsl").string();
+    CHECK_THROWS(cache.ComputeKey(missing, compiler.GetIdentity()));
+}
+
+TEST_CASE(ShaderCacheDropsCorruptEntries)
+{
+    ShaderSourceTree tree;
+    StubShaderCompiler compiler;
+    ShaderCompileCache cache(tree.CacheDirectory());
+    const std::vector<uint8_t> bytecode = cache.Compile(compiler, tree.MakeRequest(8));
+
+    // Flip the last bytecode byte, the header hash no longer matches
+    const fs::path entry = fs::directory_iterator(tree.CacheDirectory())->path();
+    {
+        std::fstream file(entry, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(-1, std::ios::end);
+        file.put('\xff');
+    }
+
+    bool hit = true;
+    CHECK(cache.Compile(compiler, tree.MakeRequest(8), &hit) == bytecode);
+    CHECK(!hit);
+    CHECK_EQUAL(2, compiler.m_compiles);
+    CHECK_EQUAL(1ull, static_cast<unsigned long long>(cache.GetStats().corruptEntries));
+}
+
+TEST_CASE(ShaderCacheDoesNotStoreFailedCompiles)
+{
+    ShaderSourceTree tree;
+    StubShaderCompiler compiler;
+    ShaderCompileCache cache(tree.CacheDirectory());
+    compiler.m_fail = true;
+    CHECK_THROWS(cache.Compile(compiler, tree.MakeRequest(8)));
+    CHECK(!fs::exists(tree.CacheDirectory()) || CountEntries(tree.CacheDirectory()) == 0);
+
+    compiler.m_fail = false;
+    bool hit = true;
+    cache.Compile(compiler, tree.MakeRequest(8), &hit);
+    CHECK(!hit);
+    CHECK_EQUAL(1u, static_cast<unsigned>(CountEntries(tree.CacheDirectory())));
+}
+
+TEST_CASE(ShaderCacheTrimsToItsSizeLimit)
+{
+    ShaderSourceTree tree;
+    StubShaderCompiler compiler;
+    // Room for about two entries of 32 header bytes plus the stub bytecode
+    const uint64_t entryBytes = sizeof(ShaderCacheEntryHeader) + compiler.Compile(tree.MakeRequest(8)).size();
+    ShaderCompileCache cache(tree.CacheDirectory(), 2 * entryBytes + entryBytes / 2);
+    for (uint32_t threadGroupSize : { 8u, 16u, 32u, 64u })
+    {
+        cache.Compile(compiler, tree.MakeRequest(threadGroupSize));
+    }
+    CHECK_EQUAL(2u, static_cast<unsigned>(CountEntries(tree.CacheDirectory())));
+    CHECK_EQUAL(2ull, static_cast<unsigned long long>(cache.GetStats().evictions));
+}
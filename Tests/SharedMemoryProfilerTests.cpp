@@ -0,0 +1,104 @@
+#include "TestFramework.h"
+#include "ComputeEmulator.h"
+#include "EmulatedKernels.h"
+#include "SharedMemoryProfiler.h"
+#include <cstdint>
+#include <vector>
+
+namespace
+{
+    // One group with one phase in which lane i touches word i * wordStride
+    SharedMemoryProfile ProfileStridedPhase(uint32_t lanes, uint32_t wordStride)
+    {
+        SharedMemoryProfiler profiler{ SharedMemoryBankConfig() };
+        profiler.BeginGroup();
+        profiler.BeginPhase(lanes);
+        for (uint32_t lane = 0; lane < lanes; ++lane)
+        {
+            profiler.RecordAccess(lane, lane * wordStride * 4);
+        }
+        profiler.EndPhase();
+        profiler.EndGroup();
+        return profiler.GetProfile();
+    }
+}
+
+TEST_CASE(ProfilerConsecutiveWordsHaveNoConflicts)
+{
+    const SharedMemoryProfile profile = ProfileStridedPhase(32, 1);
+    CHECK_EQUAL(size_t(1), profile.phases.size());
+    CHECK_EQUAL(uint64_t(32), profile.phases[0].accesses);
+    CHECK_EQUAL(uint64_t(1), profile.phases[0].waveAccesses);
+    CHECK_EQUAL(uint64_t(0), profile.phases[0].conflictReplays);
+    CHECK_EQUAL(1u, profile.phases[0].maxConflictDegree);
+}
+
+TEST_CASE(ProfilerCountsStridedBankConflicts)
+{
+    // Stride 2 puts two words into every even bank, stride 32 all 32 words into bank 0
+    const SharedMemoryProfile twoWay = ProfileStridedPhase(32, 2);
+    CHECK_EQUAL(uint64_t(1), twoWay.phases[0].conflictReplays);
+    CHECK_EQUAL(2u, twoWay.phases[0].maxConflictDegree);
+
+    const SharedMemoryProfile sixteenWay = ProfileStridedPhase(32, 16);
+    CHECK_EQUAL(uint64_t(15), sixteenWay.phases[0].conflictReplays);
+    CHECK_EQUAL(16u, sixteenWay.phases[0].maxConflictDegree);
+
+    const SharedMemoryProfile thirtyTwoWay = ProfileStridedPhase(32, 32);
+    CHECK_EQUAL(uint64_t(31), thirtyTwoWay.phases[0].conflictReplays);
+    CHECK_EQUAL(32u, thirtyTwoWay.phases[0].maxConflictDegree);
+}
+
+TEST_CASE(ProfilerReplaysEveryWaveSeparately)
+{
+    // Two waves with a 2-way conflict each
+    const SharedMemoryProfile profile = ProfileStridedPhase(64, 2);
+    CHECK_EQUAL(uint64_t(2), profile.phases[0].waveAccesses);
+    CHECK_EQUAL(uint64_t(2), profile.phases[0].conflictReplays);
+    CHECK_EQUAL(2u, profile.phases[0].maxConflictDegree);
+}
+
+TEST_CASE(ProfilerTreatsSameWordAsBroadcast)
+{
+    const SharedMemoryProfile profile = ProfileStridedPhase(32, 0);
+    CHECK_EQUAL(uint64_t(0), profile.phases[0].conflictReplays);
+    CHECK_EQUAL(1u, profile.phases[0].maxConflictDegree);
+}
+
+TEST_CASE(LegacyKernelReducesFirstTileRowOnly)
+{
+    // 16x16 texture, 8x8 groups: the first row of tile (x, y) holds 10 + x + 2 * y, the rows below 200
+    const uint32_t size = 16;
+    std::vector<uint8_t> texels(size * size, 200);
+    for (uint32_t x = 0; x < size; ++x)
+    {
+        texels[x] = static_cast<uint8_t>(10 + x / 8);
+        texels[8 * size + x] = static_cast<uint8_t>(12 + x / 8);
+    }
+    EmuTexture2D<uint8_t> texture(texels.data(), size, size, size);
+    EmuRWStructuredBuffer<uint32_t> output(2 * 8 + 2);
+
+    ComputeEmulator emulator(1);
+    SharedMemoryProfile profile;
+    emulator.Dispatch(MakeLegacyMaxReductionKernel(8, texture, output), { 8, 8, 1 }, 2, 2, 1, &profile);
+
+    // Partials at GID.y * THREAD_GROUP_SIZE + GID.x
+    CHECK_EQUAL(10u, output.Load(0));
+    CHECK_EQUAL(11u, output.Load(1));
+    CHECK_EQUAL(12u, output.Load(8));
+    CHECK_EQUAL(13u, output.Load(9));
+
+    // One barrier after the stores and one per log2(8) x-only step
+    CHECK_EQUAL(uint64_t(4), profile.groups);
+    CHECK_EQUAL(uint64_t(4 * 4), profile.barriers);
+}
+
+TEST_CASE(LegacyProfileHasFewerStepsThanWholeTileProfile)
+{
+    ComputeEmulator emulator(1);
+    const SharedMemoryProfile legacy = ProfileLegacyMaxReductionKernel(emulator, 16, 16, 16, SharedMemoryBankConfig());
+    const SharedMemoryProfile wholeTile = ProfileMaxReductionKernel(emulator, 16, 16, 16, SharedMemoryBankConfig());
+    CHECK_EQUAL(uint64_t(1), legacy.groups);
+    CHECK_EQUAL(uint64_t(5), legacy.barriers);
+    CHECK_EQUAL(uint64_t(9), wholeTile.barriers);
+}
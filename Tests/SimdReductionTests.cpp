@@ -0,0 +1,131 @@
+#include "TestFramework.h"
+#include "SimdReduction.h"
+#include <algorithm>
+#include <cstring>
+#include <random>
+#include <vector>
+
+namespace
+{
+    const SimdLevel AllLevels[] = { SimdLevel::Scalar, SimdLevel::Sse2, SimdLevel::Avx2, SimdLevel::Avx512 };
+    const TexelFormat AllFormats[] = { TexelFormat::R8, TexelFormat::R16, TexelFormat::R32 };
+
+    uint32_t GetMaxTexelValue(TexelFormat format)
+    {
+        return format == TexelFormat::R32 ? UINT32_MAX : (1u << (8 * GetTexelSize(format))) - 1;
+    }
+
+    uint32_t LoadTexel(const std::vector<uint8_t>& image, size_t offset, size_t texelSize)
+    {
+        uint32_t value = 0;
+        std::memcpy(&value, image.data() + offset, texelSize);
+        return value;
+    }
+
+    void StoreTexel(std::vector<uint8_t>& image, size_t offset, size_t texelSize, uint32_t value)
+    {
+        std::memcpy(image.data() + offset, &value, texelSize);
+    }
+
+    // Random texels in [1, max - 1] and garbage in the row padding, the row tail holds the extremes
+    // so a kernel that skips or over-reads the tail gets a different answer
+    std::vector<uint8_t> MakeImage(std::mt19937& random, uint32_t width, uint32_t height, size_t rowPitch, TexelFormat format, uint32_t tailX)
+    {
+        const size_t texelSize = GetTexelSize(format);
+        const uint32_t maxValue = GetMaxTexelValue(format);
+        std::vector<uint8_t> image(rowPitch * height);
+        for (uint8_t& byte : image)
+        {
+            byte = static_cast<uint8_t>(random());
+        }
+        std::uniform_int_distribution<uint32_t> values(1, maxValue - 1);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                StoreTexel(image, y * rowPitch + x * texelSize, texelSize, values(random));
+            }
+        }
+        StoreTexel(image, (height - 1) * rowPitch + tailX * texelSize, texelSize, maxValue);
+        StoreTexel(image, (width - 1) * texelSize, texelSize, 0);
+        return image;
+    }
+
+    MinMaxResult ReferenceMinMax(const std::vector<uint8_t>& image, uint32_t width, uint32_t height, size_t rowPitch, TexelFormat format)
+    {
+        const size_t texelSize = GetTexelSize(format);
+        MinMaxResult result = { UINT32_MAX, 0 };
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                const uint32_t value = LoadTexel(image, y * rowPitch + x * texelSize, texelSize);
+                result.minValue = std::min(result.minValue, value);
+                result.maxValue = std::max(result.maxValue, value);
+            }
+        }
+        return result;
+    }
+}
+
+TEST_CASE(SimdLevelsMatchReferenceForOddWidthsAndPitches)
+{
+    // Widths around every register and half register size of every level, R8 to R32
+    std::mt19937 random(11);
+    for (TexelFormat format : AllFormats)
+    {
+        const size_t texelSize = GetTexelSize(format);
+        for (uint32_t width = 1; width <= 140; width += (width < 70 ? 1 : 7))
+        {
+            for (uint32_t paddingTexels : { 0u, 3u, 64u })
+            {
+                const size_t rowPitch = (width + paddingTexels) * texelSize;
+                const uint32_t height = 1 + width % 4;
+                const std::vector<uint8_t> image = MakeImage(random, width, height, rowPitch, format, width - 1);
+                const MinMaxResult expected = ReferenceMinMax(image, width, height, rowPitch, format);
+                for (SimdLevel level : AllLevels)
+                {
+                    const MinMaxResult actual = ReduceMinMax(image.data(), width, height, rowPitch, format, level);
+                    CHECK_EQUAL(expected.minValue, actual.minValue);
+                    CHECK_EQUAL(expected.maxValue, actual.maxValue);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE(SimdLevelsFindExtremesAnywhereInTheRow)
+{
+    // The max moves over every position of a row, so each of the main loop, the overlapping or half
+    // register tail and the scalar remainder has to see it
+    std::mt19937 random(5);
+    for (TexelFormat format : AllFormats)
+    {
+        for (uint32_t width : { 7u, 15u, 23u, 37u, 71u })
+        {
+            const size_t rowPitch = (width + 1) * GetTexelSize(format);
+            for (uint32_t tailX = 0; tailX < width; ++tailX)
+            {
+                const std::vector<uint8_t> image = MakeImage(random, width, 2, rowPitch, format, tailX);
+                for (SimdLevel level : AllLevels)
+                {
+                    const MinMaxResult actual = ReduceMinMax(image.data(), width, 2, rowPitch, format, level);
+                    CHECK_EQUAL(0u, actual.minValue);
+                    CHECK_EQUAL(GetMaxTexelValue(format), actual.maxValue);
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE(SimdReductionOfEmptyImageIsIdentity)
+{
+    const uint8_t texel = 7;
+    for (SimdLevel level : AllLevels)
+    {
+        const MinMaxResult result = ReduceMinMax(&texel, 0, 1, 1, TexelFormat::R8, level);
+        CHECK_EQUAL(UINT32_MAX, result.minValue);
+        CHECK_EQUAL(0u, result.maxValue);
+    }
+    CHECK_THROWS(ReduceMinMax(&texel, 4, 1, 2, TexelFormat::R8));
+}
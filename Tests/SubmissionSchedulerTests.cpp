@@ -0,0 +1,68 @@
+#include "TestFramework.h"
+#include "SubmissionScheduler.h"
+#include <stdexcept>
+
+namespace
+{
+    SimulatedSubmissionQueue MakeQueue(double latencyMs)
+    {
+        return SimulatedSubmissionQueue([=](uint64_t) { return latencyMs; });
+    }
+}
+
+TEST_CASE(SchedulerHandsOutSlotsRoundRobin)
+{
+    SimulatedSubmissionQueue queue = MakeQueue(10.0);
+    SubmissionScheduler scheduler(queue, 3);
+    for (uint32_t i = 0; i < 3; ++i)
+    {
+        CHECK_EQUAL(i, scheduler.BeginJob());
+        CHECK_EQUAL(static_cast<uint64_t>(i + 1), scheduler.EndJob());
+    }
+    CHECK_EQUAL(3u, scheduler.GetJobsInFlight());
+    CHECK_EQUAL(0ull, static_cast<unsigned long long>(scheduler.GetSlotWaits()));
+
+    // The fourth job reuses slot 0 and has to wait for ticket 1
+    CHECK_EQUAL(0u, scheduler.BeginJob());
+    CHECK_EQUAL(1ull, static_cast<unsigned long long>(scheduler.GetSlotWaits()));
+    CHECK(scheduler.IsComplete(1));
+    CHECK(!scheduler.IsComplete(2));
+    scheduler.EndJob();
+
+    scheduler.WaitIdle();
+    CHECK_EQUAL(0u, scheduler.GetJobsInFlight());
+    CHECK_EQUAL(40.0, queue.GetTimeMs());
+}
+
+TEST_CASE(SchedulerRejectsUnbalancedJobs)
+{
+    SimulatedSubmissionQueue queue = MakeQueue(1.0);
+    SubmissionScheduler scheduler(queue, 2);
+    CHECK_THROWS(scheduler.EndJob());
+    CHECK_THROWS(scheduler.AbandonJob());
+    scheduler.BeginJob();
+    CHECK_THROWS(scheduler.BeginJob());
+    CHECK_THROWS(scheduler.Wait(2));
+}
+
+TEST_CASE(ScopedJobAbandonsOnException)
+{
+    SimulatedSubmissionQueue queue = MakeQueue(1.0);
+    SubmissionScheduler scheduler(queue, 2);
+    try
+    {
+        ScopedSubmissionJob job(scheduler);
+        CHECK_EQUAL(0u, job.GetSlot());
+        throw std::runtime_error("recording failed");
+    }
+    catch (const std::runtime_error&)
+    {
+    }
+
+    // No ticket was spent and the slot is handed out again
+    CHECK_EQUAL(0ull, static_cast<unsigned long long>(scheduler.GetLastTicket()));
+    ScopedSubmissionJob job(scheduler);
+    CHECK_EQUAL(0u, job.GetSlot());
+    CHECK_EQUAL(1ull, static_cast<unsigned long long>(job.End()));
+    CHECK_THROWS(job.End());
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <exception>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Minimal self-registering unit tests for the portable modules, no third party framework and no device.
+// TEST_CASE(Name) defines and registers a test, the CHECK macros throw a TestFailure that TestMain.cpp
+// reports with the failing expression and its location.
+
+struct TestCase
+{
+    const char* name;
+    std::function<void()> body;
+};
+
+std::vector<TestCase>& GetTestCases();
+
+struct TestRegistrar
+{
+    TestRegistrar(const char* name, std::function<void()> body) { GetTestCases().push_back({ name, std::move(body) }); }
+};
+
+class TestFailure : public std::exception
+{
+public:
+    TestFailure(const char* file, int line, const std::string& message)
+    {
+        std::ostringstream out;
+        out << file << "(" << line << "): " << message;
+        m_message = out.str();
+    }
+
+    const char* what() const noexcept override { return m_message.c_str(); }
+
+private:
+    std::string m_message;
+};
+
+#define TEST_CASE(name)                                             \
+    static void name();                                             \
+    static TestRegistrar name##Registrar(#name, name);              \
+    static void name()
+
+#define CHECK(condition)                                                        \
+    do                                                                          \
+    {                                                                           \
+        if (!(condition))                                                       \
+        {                                                                       \
+            throw TestFailure(__FILE__, __LINE__, "CHECK(" #condition ")");     \
+        }                                                                       \
+    } while (0)
+
+#define CHECK_EQUAL(expected, actual)                                                               \
+    do                                                                                              \
+    {                                                                                               \
+        const auto& expectedValue = (expected);                                                     \
+        const auto& actualValue = (actual);                                                         \
+        if (!(expectedValue == actualValue))                                                        \
+        {                                                                                           \
+            std::ostringstream message;                                                             \
+            message << "CHECK_EQUAL(" #expected ", " #actual "): " << expectedValue << " != " << actualValue; \
+            throw TestFailure(__FILE__, __LINE__, message.str());                                   \
+        }                                                                                           \
+    } while (0)
+
+#define CHECK_THROWS(expression)                                                        \
+    do                                                                                  \
+    {                                                                                   \
+        bool threw = false;                                                             \
+        try                                                                             \
+        {                                                                               \
+            expression;                                                                 \
+        }                                                                               \
+        catch (const std::exception&)                                                   \
+        {                                                                               \
+            threw = true;                                                               \
+        }                                                                               \
+        if (!threw)                                                                     \
+        {                                                                               \
+            throw TestFailure(__FILE__, __LINE__, "CHECK_THROWS(" #expression ")");     \
+        }                                                                               \
+    } while (0)
@@ -0,0 +1,36 @@
+#include "TestFramework.h"
+#include <iostream>
+#include <string>
+
+std::vector<TestCase>& GetTestCases()
+{
+    static std::vector<TestCase> testCases;
+    return testCases;
+}
+
+int main(int argc, char* argv[])
+{
+    // Optional argument: run only the tests whose name contains it
+    const std::string filter = argc > 1 ? argv[1] : "";
+    size_t run = 0;
+    size_t failed = 0;
+    for (const TestCase& testCase : GetTestCases())
+    {
+        if (!filter.empty() && std::string(testCase.name).find(filter) == std::string::npos)
+        {
+            continue;
+        }
+        ++run;
+        try
+        {
+            testCase.body();
+        }
+        catch (const std::exception& e)
+        {
+            ++failed;
+            std::cerr << testCase.name << " failed: " << e.what() << std::endl;
+        }
+    }
+    std::cout << run - failed << " of " << run << " tests passed" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
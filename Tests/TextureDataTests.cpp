@@ -0,0 +1,93 @@
+#include "TestFramework.h"
+#include "TextureData.h"
+#include <filesystem>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    TextureDataText Parse(const std::string& text)
+    {
+        return ParseTextureDataText(text.data(), text.size());
+    }
+}
+
+TEST_CASE(TextureDataTextParsesRows)
+{
+    const TextureDataText texture = Parse("1 2 3\n40\t50  60\n255 0 7\n");
+    CHECK_EQUAL(3u, texture.width);
+    CHECK_EQUAL(3u, texture.height);
+    const std::vector<uint8_t> expected = { 1, 2, 3, 40, 50, 60, 255, 0, 7 };
+    CHECK(texture.texels == expected);
+}
+
+TEST_CASE(TextureDataTextAcceptsCrlfAndMissingFinalNewline)
+{
+    const TextureDataText crlf = Parse("1 2\r\n3 4\r\n");
+    CHECK_EQUAL(2u, crlf.width);
+    CHECK_EQUAL(2u, crlf.height);
+    CHECK(crlf.texels == std::vector<uint8_t>({ 1, 2, 3, 4 }));
+
+    const TextureDataText unterminated = Parse("1 2\n3 4");
+    CHECK_EQUAL(2u, unterminated.height);
+    CHECK(unterminated.texels == std::vector<uint8_t>({ 1, 2, 3, 4 }));
+
+    // Empty lines and trailing separators do not make rows
+    const TextureDataText padded = Parse("\n5 6 \r\n\r\n\n7 8\t\n\n");
+    CHECK_EQUAL(2u, padded.width);
+    CHECK_EQUAL(2u, padded.height);
+    CHECK(padded.texels == std::vector<uint8_t>({ 5, 6, 7, 8 }));
+}
+
+TEST_CASE(TextureDataTextOfEmptyFileIsEmpty)
+{
+    const TextureDataText empty = ParseTextureDataText("", 0);
+    CHECK_EQUAL(0u, empty.width);
+    CHECK_EQUAL(0u, empty.height);
+    CHECK(empty.texels.empty());
+
+    const TextureDataText blank = Parse(" \r\n\n\t");
+    CHECK_EQUAL(0u, blank.height);
+    CHECK(blank.texels.empty());
+}
+
+TEST_CASE(TextureDataTextRejectsRowsOfDifferentLength)
+{
+    CHECK_THROWS(Parse("1 2 3\n4 5\n"));
+    CHECK_THROWS(Parse("1 2\n3 4 5\n"));
+    CHECK_THROWS(Parse("1 2\n3 4\n5"));
+}
+
+TEST_CASE(TextureDataTextRejectsValuesAbove255)
+{
+    CHECK_EQUAL(255u, static_cast<uint32_t>(Parse("255").texels[0]));
+    CHECK_EQUAL(7u, static_cast<uint32_t>(Parse("007").texels[0]));
+    CHECK_THROWS(Parse("256"));
+    CHECK_THROWS(Parse("1 2\n3 1000\n"));
+    CHECK_THROWS(Parse("99999999999999999999"));
+}
+
+TEST_CASE(TextureDataTextRejectsInvalidCharacters)
+{
+    CHECK_THROWS(Parse("1 -2\n"));
+    CHECK_THROWS(Parse("1,2\n"));
+    CHECK_THROWS(Parse("1 2.5\n"));
+    CHECK_THROWS(Parse("0x10\n"));
+    CHECK_THROWS(Parse(std::string("1 \0 2", 5)));
+    CHECK_THROWS(Parse("1 2\n\xff"));
+}
+
+TEST_CASE(TextureDataTextRoundTrip)
+{
+    const fs::path path = fs::temp_directory_path() / "TextureDataTests.txt";
+    const std::vector<uint8_t> texels = { 0, 9, 10, 99, 100, 255, 17, 3 };
+    WriteTextureDataText(texels, 4, path.string());
+    const TextureDataText texture = LoadTextureDataText(path.string());
+    std::error_code error;
+    fs::remove(path, error);
+    CHECK_EQUAL(4u, texture.width);
+    CHECK_EQUAL(2u, texture.height);
+    CHECK(texture.texels == texels);
+}
@@ -0,0 +1,100 @@
+#include "TestFramework.h"
+#include "TiledReduction.h"
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    MinMaxResult ReferenceMinMax(const std::vector<uint8_t>& texels, uint32_t width, uint32_t height, size_t rowPitch)
+    {
+        MinMaxResult result = { UINT32_MAX, 0 };
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                const uint32_t value = texels[y * rowPitch + x];
+                result.minValue = std::min(result.minValue, value);
+                result.maxValue = std::max(result.maxValue, value);
+            }
+        }
+        return result;
+    }
+}
+
+TEST_CASE(TiledReductionMatchesReferenceForEveryTileShape)
+{
+    WorkStealingThreadPool pool(4);
+    std::mt19937 random(7);
+    const uint32_t width = 300;
+    const uint32_t height = 77;
+    const size_t rowPitch = 320;    // padding past the width must be ignored
+    std::vector<uint8_t> texels(rowPitch * height, 255);
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        for (uint32_t x = 0; x < width; ++x)
+        {
+            texels[y * rowPitch + x] = static_cast<uint8_t>(10 + random() % 200);
+        }
+    }
+    const MinMaxResult expected = ReferenceMinMax(texels, width, height, rowPitch);
+
+    for (uint32_t tileWidth : { 1u, 16u, 64u, 256u, 512u })
+    {
+        for (uint32_t tileHeight : { 1u, 8u, 64u, 100u })
+        {
+            TiledReductionConfig config;
+            config.tileWidth = tileWidth;
+            config.tileHeight = tileHeight;
+            config.tilesPerTask = 3;
+            const MinMaxResult result = TiledReduceMinMax(pool, texels.data(), width, height, rowPitch, TexelFormat::R8, config);
+            CHECK_EQUAL(expected.minValue, result.minValue);
+            CHECK_EQUAL(expected.maxValue, result.maxValue);
+        }
+    }
+}
+
+TEST_CASE(TiledReductionFindsMaxInLastPartialTile)
+{
+    WorkStealingThreadPool pool(2);
+    std::vector<uint8_t> texels(33 * 17, 1);
+    texels[16 * 33 + 32] = 250;     // bottom right texel, alone in its tile
+    TiledReductionConfig config;
+    config.tileWidth = 16;
+    config.tileHeight = 16;
+    const MinMaxResult result = TiledReduceMinMax(pool, texels.data(), 33, 17, 33, TexelFormat::R8, config);
+    CHECK_EQUAL(1u, result.minValue);
+    CHECK_EQUAL(250u, result.maxValue);
+}
+
+TEST_CASE(TiledReductionRejectsEmptyTiles)
+{
+    WorkStealingThreadPool pool(1);
+    std::vector<uint8_t> texels(16, 0);
+    TiledReductionConfig config;
+    config.tileHeight = 0;
+    CHECK_THROWS(TiledReduceMinMax(pool, texels.data(), 4, 4, 4, TexelFormat::R8, config));
+    CHECK_EQUAL(0u, TiledReduceMinMax(pool, texels.data(), 0, 4, 4, TexelFormat::R8).maxValue);
+}
+
+TEST_CASE(ThreadPoolRunsEveryIndexWhenBodyThrows)
+{
+    // One chunk holds every index, the rest of it still runs after index 3 threw
+    WorkStealingThreadPool pool(1);
+    std::vector<int> calls(10, 0);
+    CHECK_THROWS(pool.ParallelFor(calls.size(), calls.size(), [&](size_t index, unsigned int)
+    {
+        ++calls[index];
+        if (index == 3)
+        {
+            throw std::runtime_error("body failed");
+        }
+    }));
+    CHECK_EQUAL(size_t(10), static_cast<size_t>(std::count(calls.begin(), calls.end(), 1)));
+
+    // The pool keeps working after the failed job
+    size_t sum = 0;
+    pool.ParallelFor(100, 7, [&](size_t index, unsigned int) { sum += index; });
+    CHECK_EQUAL(size_t(4950), sum);
+}
@@ -0,0 +1,204 @@
+#include "TextureData.h"
+#include "MappedFile.h"
+#include "SimdTarget.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+
+std::vector<uint8_t> GenerateRandomTextureData(uint32_t width, uint32_t height)
+{
+    std::vector<uint8_t> textureBytes(static_cast<size_t>(width) * height);
+    std::generate(textureBytes.begin(), textureBytes.end(), []() { return static_cast<uint8_t>(rand() % MAX_VALUE_FOR_RANDOM); });
+    return textureBytes;
+}
+
+void WriteTextureDataText(const std::vector<uint8_t>& textureBytes, uint32_t width, const std::string& filename)
+{
+    std::ofstream outFile(filename);
+    if (!outFile.is_open())
+    {
+        throw std::runtime_error("Failed to open " + filename + " for writing");
+    }
+
+    for (size_t i = 0; i < textureBytes.size(); ++i)
+    {
+        outFile << static_cast<int>(textureBytes[i]) << " ";
+        if ((i + 1) % width == 0)
+        {
+            outFile << "\n";
+        }
+    }
+}
+
+namespace
+{
+    enum CharClass : uint8_t
+    {
+        Digit,
+        Separator,
+        Newline,
+        Invalid
+    };
+
+    struct CharClassTable
+    {
+        uint8_t classes[256];
+
+        CharClassTable()
+        {
+            for (int c = 0; c < 256; ++c)
+            {
+                classes[c] = Invalid;
+            }
+            for (int c = '0'; c <= '9'; ++c)
+            {
+                classes[c] = Digit;
+            }
+            classes[' '] = Separator;
+            classes['\t'] = Separator;
+            classes['\r'] = Separator;
+            classes['\n'] = Newline;
+        }
+    };
+
+    const CharClassTable charClasses;
+}
+
+TextureDataText ParseTextureDataText(const char* text, size_t size)
+{
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(text);
+    const uint8_t* end = p + size;
+
+    // Every value takes at least two characters (digit and separator) except possibly the last one,
+    // so the output never grows past this and the loop writes through a raw pointer
+    TextureDataText result;
+    result.texels.resize(size / 2 + 1);
+    uint8_t* out = result.texels.data();
+    const uint8_t* rowStart = out;
+
+    auto endRow = [&]()
+    {
+        const uint32_t count = static_cast<uint32_t>(out - rowStart);
+        if (count == 0)
+        {
+            return;
+        }
+        if (result.height == 0)
+        {
+            result.width = count;
+        }
+        else if (count != result.width)
+        {
+            throw std::runtime_error("Row " + std::to_string(result.height) + " has " + std::to_string(count) + " values, expected " + std::to_string(result.width));
+        }
+        ++result.height;
+        rowStart = out;
+    };
+
+    while (p < end)
+    {
+        const uint8_t c = *p;
+        const uint8_t charClass = charClasses.classes[c];
+        if (charClass == Digit)
+        {
+            // R8 values have at most three digits, the 255 check also catches longer numbers
+            uint32_t value = c - '0';
+            ++p;
+            uint32_t digit;
+            while (p < end && (digit = static_cast<uint32_t>(*p) - '0') < 10)
+            {
+                value = value * 10 + digit;
+                if (value > 255)
+                {
+                    throw std::runtime_error("Texel value out of range at offset " + std::to_string(p - reinterpret_cast<const uint8_t*>(text)));
+                }
+                ++p;
+            }
+            *out++ = static_cast<uint8_t>(value);
+        }
+        else if (charClass == Separator)
+        {
+            ++p;
+        }
+        else if (charClass == Newline)
+        {
+            endRow();
+            ++p;
+        }
+        else
+        {
+            throw std::runtime_error("Unexpected character at offset " + std::to_string(p - reinterpret_cast<const uint8_t*>(text)));
+        }
+    }
+    endRow();
+
+    result.texels.resize(static_cast<size_t>(result.width) * result.height);
+    result.texels.shrink_to_fit();
+    return result;
+}
+
+TextureDataText LoadTextureDataText(const std::string& filename)
+{
+    MappedFile file(filename);
+    return ParseTextureDataText(reinterpret_cast<const char*>(file.Data()), file.Size());
+}
+
+#if SIMD_X86
+namespace
+{
+    // Unaligned head and tail with plain stores, whole 16 byte lines in between bypass the cache
+    SIMD_TARGET_SSE2 void StreamRow(uint8_t* destination, const uint8_t* source, size_t bytes)
+    {
+        size_t head = (16 - reinterpret_cast<uintptr_t>(destination) % 16) % 16;
+        head = std::min(head, bytes);
+        std::memcpy(destination, source, head);
+        size_t i = head;
+        for (; i + 64 <= bytes; i += 64)
+        {
+            const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+            const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 16));
+            const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 32));
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i + 48));
+            _mm_stream_si128(reinterpret_cast<__m128i*>(destination + i), a);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(destination + i + 16), b);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(destination + i + 32), c);
+            _mm_stream_si128(reinterpret_cast<__m128i*>(destination + i + 48), d);
+        }
+        for (; i + 16 <= bytes; i += 16)
+        {
+            _mm_stream_si128(reinterpret_cast<__m128i*>(destination + i), _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i)));
+        }
+        std::memcpy(destination + i, source + i, bytes - i);
+    }
+
+    SIMD_TARGET_SSE2 void StreamFence()
+    {
+        _mm_sfence();
+    }
+}
+#endif
+
+void CopyTextureRows(uint8_t* destination, size_t destinationPitch, const uint8_t* source, size_t sourcePitch, uint32_t width, uint32_t height, bool streaming)
+{
+#if SIMD_X86
+    if (streaming)
+    {
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            StreamRow(destination + y * destinationPitch, source + y * sourcePitch, width);
+        }
+        // Non-temporal stores are weakly ordered, make them visible before the caller publishes the rows
+        StreamFence();
+        return;
+    }
+#else
+    (void)streaming;
+#endif
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        std::memcpy(destination + y * destinationPitch, source + y * sourcePitch, width);
+    }
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#define MAX_VALUE_FOR_RANDOM    100
+
+// R8 texels in [0, MAX_VALUE_FOR_RANDOM) from rand(), tightly packed
+std::vector<uint8_t> GenerateRandomTextureData(uint32_t width, uint32_t height);
+
+// Copies height rows of width texels between pitched images. streaming writes the destination with
+// non-temporal stores, for memory the CPU never reads back such as a write-combined upload heap.
+void CopyTextureRows(uint8_t* destination, size_t destinationPitch, const uint8_t* source, size_t sourcePitch, uint32_t width, uint32_t height, bool streaming);
+
+// Texels as space separated decimal values, one texture row per line
+void WriteTextureDataText(const std::vector<uint8_t>& textureBytes, uint32_t width, const std::string& filename);
+
+struct TextureDataText
+{
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<uint8_t> texels;    // tightly packed R8
+};
+
+// Parses the WriteTextureDataText format. Width is the value count of the first row, every row
+// must have the same count. Spaces, tabs and \r are separators, empty lines are skipped.
+// Throws on other characters or values above 255.
+TextureDataText ParseTextureDataText(const char* text, size_t size);
+
+// Memory-maps filename and parses it with ParseTextureDataText
+TextureDataText LoadTextureDataText(const std::string& filename);
@@ -0,0 +1,283 @@
+#include "TextureDistributions.h"
+#include "TextureGenerator.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+    const uint32_t TexelsPerBlock = 8;
+
+    // 16-bit uniforms of texels [blockX * 8, blockX * 8 + 8) of row y from one Philox stream
+    void GenerateUniforms(uint64_t seed, uint32_t blockX, uint32_t y, uint32_t stream, uint32_t uniforms[TexelsPerBlock])
+    {
+        const uint32_t counter[4] = { blockX, y, stream, 0 };
+        PhiloxBlock block = Philox4x32(counter, seed);
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            uniforms[2 * i] = block.words[i] & 0xFFFF;
+            uniforms[2 * i + 1] = block.words[i] >> 16;
+        }
+    }
+
+    inline uint8_t Scale(uint32_t uniform, uint32_t maxValue)
+    {
+        return static_cast<uint8_t>((uniform * maxValue) >> 16);
+    }
+
+    // Sum of four 16-bit uniforms (Irwin-Hall) is close to normal with standard deviation
+    // 65536 * sqrt(4 / 12) ~= 37837. Integer math keeps the result identical on every compiler.
+    inline uint8_t Gaussian(const uint32_t sum)
+    {
+        const int64_t centered = static_cast<int64_t>(sum) - 2 * 65535;
+        const int64_t value = 128 + (centered * 32) / 37837;
+        return static_cast<uint8_t>(std::min<int64_t>(255, std::max<int64_t>(0, value)));
+    }
+
+    // Texels [x0, x0 + width) of row y for the distributions that need per texel random draws
+    void GenerateRow(uint64_t seed, uint32_t x0, uint32_t y, uint32_t width, const TextureDistributionParams& params, uint8_t* row)
+    {
+        const uint32_t spikeThreshold = static_cast<uint32_t>((static_cast<uint64_t>(params.spikesPerMillion) * 65536) / 1000000);
+        const uint32_t end = x0 + width;
+        uint32_t x = x0;
+        while (x < end)
+        {
+            const uint32_t blockX = x / TexelsPerBlock;
+            const uint32_t first = x % TexelsPerBlock;
+            const uint32_t count = std::min(TexelsPerBlock - first, end - x);
+
+            uint32_t values[TexelsPerBlock];
+            uint32_t extra[TexelsPerBlock];
+            GenerateUniforms(seed, blockX, y, 0, values);
+
+            uint8_t texels[TexelsPerBlock];
+            switch (params.type)
+            {
+            case TextureDistribution::Gaussian:
+                for (uint32_t stream = 1; stream < 4; ++stream)
+                {
+                    GenerateUniforms(seed, blockX, y, stream, extra);
+                    for (uint32_t i = 0; i < TexelsPerBlock; ++i)
+                    {
+                        values[i] += extra[i];
+                    }
+                }
+                for (uint32_t i = 0; i < TexelsPerBlock; ++i)
+                {
+                    texels[i] = Gaussian(values[i]);
+                }
+                break;
+            case TextureDistribution::SparseSpikes:
+                GenerateUniforms(seed, blockX, y, 1, extra);
+                for (uint32_t i = 0; i < TexelsPerBlock; ++i)
+                {
+                    texels[i] = extra[i] < spikeThreshold ? 255 : Scale(values[i], params.maxValue);
+                }
+                break;
+            default:
+                for (uint32_t i = 0; i < TexelsPerBlock; ++i)
+                {
+                    texels[i] = Scale(values[i], params.maxValue);
+                }
+                break;
+            }
+
+            std::copy(texels + first, texels + first + count, row + (x - x0));
+            x += count;
+        }
+    }
+
+    uint8_t GradientTexel(uint32_t x, uint32_t y, const TextureDistributionParams& params)
+    {
+        const uint64_t range = static_cast<uint64_t>(params.textureWidth) + params.textureHeight - 2;
+        return range == 0 ? 255 : static_cast<uint8_t>(((static_cast<uint64_t>(x) + y) * 255) / range);
+    }
+
+    // Tile maxima sit at the last row and column of their tile, the texel a tree reduction folds in
+    // last and one a reduction along x only would miss. Background is [0, 16).
+    uint8_t AdversarialTileMax(uint32_t tileX, uint32_t tileY, const TextureDistributionParams& params)
+    {
+        const uint32_t tilesX = (params.textureWidth + params.tileSize - 1) / params.tileSize;
+        const uint32_t tilesY = (params.textureHeight + params.tileSize - 1) / params.tileSize;
+        if (tileX + 1 == tilesX && tileY + 1 == tilesY)
+        {
+            return 255;
+        }
+        return static_cast<uint8_t>(128 + (tileX * 7 + tileY * 13) % 127);
+    }
+}
+
+TextureDistribution ParseTextureDistribution(const std::string& name)
+{
+    const TextureDistribution distributions[] =
+    {
+        TextureDistribution::Uniform, TextureDistribution::UniformFull, TextureDistribution::Gaussian, TextureDistribution::SparseSpikes,
+        TextureDistribution::SingleMax, TextureDistribution::Gradient, TextureDistribution::Constant, TextureDistribution::AdversarialTiles
+    };
+    for (TextureDistribution distribution : distributions)
+    {
+        if (name == GetTextureDistributionName(distribution))
+        {
+            return distribution;
+        }
+    }
+
+    throw std::runtime_error("Unknown texture distribution: " + name);
+}
+
+const char* GetTextureDistributionName(TextureDistribution distribution)
+{
+    switch (distribution)
+    {
+    case TextureDistribution::Uniform:
+        return "uniform";
+    case TextureDistribution::UniformFull:
+        return "uniform-full";
+    case TextureDistribution::Gaussian:
+        return "gaussian";
+    case TextureDistribution::SparseSpikes:
+        return "spikes";
+    case TextureDistribution::SingleMax:
+        return "single-max";
+    case TextureDistribution::Gradient:
+        return "gradient";
+    case TextureDistribution::Constant:
+        return "constant";
+    case TextureDistribution::AdversarialTiles:
+        return "adversarial";
+    }
+    return "unknown";
+}
+
+TextureDistributionParams MakeTextureDistributionParams(TextureDistribution distribution, uint32_t width, uint32_t height)
+{
+    TextureDistributionParams params;
+    params.type = distribution;
+    params.textureWidth = width;
+    params.textureHeight = height;
+    if (distribution == TextureDistribution::UniformFull)
+    {
+        params.maxValue = 256;
+    }
+    else if (distribution == TextureDistribution::AdversarialTiles)
+    {
+        params.maxValue = 16;
+    }
+    return params;
+}
+
+void GenerateDistributionTile(uint64_t seed, uint32_t x0, uint32_t y0, uint32_t width, uint32_t height, const TextureDistributionParams& params, uint8_t* texels, size_t rowPitch)
+{
+    if (params.maxValue == 0 || params.maxValue > 256 || params.tileSize == 0 || params.constantValue > 255)
+    {
+        throw std::runtime_error("Invalid texture distribution parameters");
+    }
+
+    switch (params.type)
+    {
+    case TextureDistribution::Uniform:
+    case TextureDistribution::UniformFull:
+        // Stream 0 only, the SIMD fill kernel produces exactly these values
+        GeneratePhiloxTile(seed, x0, y0, width, height, params.maxValue, texels, rowPitch);
+        return;
+    case TextureDistribution::Constant:
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            std::fill(texels + y * rowPitch, texels + y * rowPitch + width, static_cast<uint8_t>(params.constantValue));
+        }
+        return;
+    case TextureDistribution::Gradient:
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                texels[y * rowPitch + x] = GradientTexel(x0 + x, y0 + y, params);
+            }
+        }
+        return;
+    case TextureDistribution::SingleMax:
+    {
+        GeneratePhiloxTile(seed, x0, y0, width, height, std::min(params.maxValue, 255u), texels, rowPitch);
+        const uint32_t maxX = params.maxX != UINT32_MAX ? params.maxX : params.textureWidth - 1;
+        const uint32_t maxY = params.maxY != UINT32_MAX ? params.maxY : params.textureHeight - 1;
+        if (maxX >= x0 && maxX < x0 + width && maxY >= y0 && maxY < y0 + height)
+        {
+            texels[(maxY - y0) * rowPitch + (maxX - x0)] = 255;
+        }
+        return;
+    }
+    case TextureDistribution::AdversarialTiles:
+        GeneratePhiloxTile(seed, x0, y0, width, height, params.maxValue, texels, rowPitch);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                const uint32_t gx = x0 + x;
+                const uint32_t gy = y0 + y;
+                const uint32_t lastX = std::min((gx / params.tileSize + 1) * params.tileSize, params.textureWidth) - 1;
+                const uint32_t lastY = std::min((gy / params.tileSize + 1) * params.tileSize, params.textureHeight) - 1;
+                if (gx == lastX && gy == lastY)
+                {
+                    texels[y * rowPitch + x] = AdversarialTileMax(gx / params.tileSize, gy / params.tileSize, params);
+                }
+            }
+        }
+        return;
+    default:
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            GenerateRow(seed, x0, y0 + y, width, params, texels + y * rowPitch);
+        }
+        return;
+    }
+}
+
+void GenerateDistributionTexture(uint64_t seed, const TextureDistributionParams& params, uint8_t* texels, size_t rowPitch, bool writeCombined, WorkStealingThreadPool* pool)
+{
+    const uint32_t width = params.textureWidth;
+    const uint32_t height = params.textureHeight;
+    const uint32_t rowsPerTask = 16;
+    const size_t taskCount = (height + rowsPerTask - 1) / rowsPerTask;
+
+    // Some distributions patch texels after the fill, which must not read uncached memory
+    std::vector<std::vector<uint8_t>> staging;
+    auto generateTask = [&](size_t task, unsigned int workerIndex)
+    {
+        const uint32_t y0 = static_cast<uint32_t>(task) * rowsPerTask;
+        const uint32_t rows = std::min(rowsPerTask, height - y0);
+        uint8_t* destination = texels + y0 * rowPitch;
+        if (!writeCombined)
+        {
+            GenerateDistributionTile(seed, 0, y0, width, rows, params, destination, rowPitch);
+            return;
+        }
+        std::vector<uint8_t>& rowBuffer = staging[workerIndex];
+        rowBuffer.resize(static_cast<size_t>(width) * rowsPerTask);
+        GenerateDistributionTile(seed, 0, y0, width, rows, params, rowBuffer.data(), width);
+        CopyTextureRows(destination, rowPitch, rowBuffer.data(), width, width, rows, true);
+    };
+
+    if (pool == nullptr)
+    {
+        if (!writeCombined)
+        {
+            GenerateDistributionTile(seed, 0, 0, width, height, params, texels, rowPitch);
+            return;
+        }
+        staging.resize(1);
+        for (size_t task = 0; task < taskCount; ++task)
+        {
+            generateTask(task, 0);
+        }
+        return;
+    }
+    staging.resize(pool->GetWorkerCount());
+    pool->ParallelFor(taskCount, 1, generateTask);
+}
+
+std::vector<uint8_t> GenerateDistributionTextureData(uint64_t seed, const TextureDistributionParams& params, WorkStealingThreadPool* pool)
+{
+    std::vector<uint8_t> textureBytes(static_cast<size_t>(params.textureWidth) * params.textureHeight);
+    GenerateDistributionTexture(seed, params, textureBytes.data(), params.textureWidth, false, pool);
+    return textureBytes;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "TextureData.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class WorkStealingThreadPool;
+
+// Named input distributions for benchmarking the reductions beyond "uniform below 100".
+// Like GeneratePhiloxTile every texel only depends on (seed, x, y) and the parameters, so tiles can
+// be generated in parallel. Random draws use Philox streams: stream 0 is exactly the value
+// GeneratePhiloxTile uses, further streams (counter word 2) give independent values per texel.
+enum class TextureDistribution
+{
+    Uniform,            // [0, maxValue), the original benchmark input
+    UniformFull,        // [0, 255]
+    Gaussian,           // mean 128, standard deviation 32, clamped
+    SparseSpikes,       // [0, maxValue) background, 255 with probability spikesPerMillion
+    SingleMax,          // [0, maxValue) background, one 255 at (maxX, maxY)
+    Gradient,           // monotonic in x + y, 0 at the top left, 255 at the bottom right
+    Constant,           // every texel constantValue, every comparison ties
+    AdversarialTiles    // low background, each tile's max in its last row and column, the global max in the last tile
+};
+
+struct TextureDistributionParams
+{
+    TextureDistribution type = TextureDistribution::Uniform;
+    uint32_t maxValue = MAX_VALUE_FOR_RANDOM;   // exclusive bound of Uniform and of the background values
+    uint32_t textureWidth = 0;                  // full texture size for Gradient, SingleMax defaults and AdversarialTiles
+    uint32_t textureHeight = 0;
+    uint32_t spikesPerMillion = 100;
+    uint32_t maxX = UINT32_MAX;                 // UINT32_MAX places the single max at the last texel
+    uint32_t maxY = UINT32_MAX;
+    uint32_t constantValue = 128;
+    uint32_t tileSize = 32;                     // AdversarialTiles tile edge
+};
+
+// "uniform", "uniform-full", "gaussian", "spikes", "single-max", "gradient", "constant", "adversarial"
+TextureDistribution ParseTextureDistribution(const std::string& name);
+const char* GetTextureDistributionName(TextureDistribution distribution);
+
+// Parameters for a width x height texture, everything else at its default
+TextureDistributionParams MakeTextureDistributionParams(TextureDistribution distribution, uint32_t width, uint32_t height);
+
+void GenerateDistributionTile(uint64_t seed, uint32_t x0, uint32_t y0, uint32_t width, uint32_t height, const TextureDistributionParams& params, uint8_t* texels, size_t rowPitch);
+
+// Whole params.textureWidth x params.textureHeight texture into texels, rows rowPitch bytes apart, e.g.
+// straight into a mapped upload buffer. With writeCombined every task generates its rows into a small
+// cached buffer and streams them out with CopyTextureRows, so uncached memory is written once,
+// sequentially and never read. Rows are spread over pool when one is given.
+void GenerateDistributionTexture(uint64_t seed, const TextureDistributionParams& params, uint8_t* texels, size_t rowPitch, bool writeCombined, WorkStealingThreadPool* pool = nullptr);
+
+std::vector<uint8_t> GenerateDistributionTextureData(uint64_t seed, const TextureDistributionParams& params, WorkStealingThreadPool* pool = nullptr);
@@ -0,0 +1,211 @@
+#include "TextureGenerator.h"
+#include "SimdTarget.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace
+{
+    const uint32_t PhiloxM0 = 0xD2511F53;
+    const uint32_t PhiloxM1 = 0xCD9E8D57;
+    const uint32_t PhiloxW0 = 0x9E3779B9;
+    const uint32_t PhiloxW1 = 0xBB67AE85;
+    const uint32_t PhiloxRounds = 10;
+
+    // Texels produced by one Philox call
+    const uint32_t TexelsPerBlock = 8;
+
+    inline uint8_t ScaleToTexel(uint32_t value16, uint32_t maxValue)
+    {
+        return static_cast<uint8_t>((value16 * maxValue) >> 16);
+    }
+
+    inline void BlockToTexels(const PhiloxBlock& block, uint32_t maxValue, uint8_t texels[TexelsPerBlock])
+    {
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            texels[2 * i] = ScaleToTexel(block.words[i] & 0xFFFF, maxValue);
+            texels[2 * i + 1] = ScaleToTexel(block.words[i] >> 16, maxValue);
+        }
+    }
+
+    // Texels [x0, x0 + width) of row y, one block at a time
+    void GenerateRowScalar(uint64_t seed, uint32_t x0, uint32_t y, uint32_t width, uint32_t maxValue, uint8_t* row)
+    {
+        uint32_t x = x0;
+        const uint32_t end = x0 + width;
+        while (x < end)
+        {
+            const uint32_t counter[4] = { x / TexelsPerBlock, y, 0, 0 };
+            uint8_t texels[TexelsPerBlock];
+            BlockToTexels(Philox4x32(counter, seed), maxValue, texels);
+
+            const uint32_t first = x % TexelsPerBlock;
+            const uint32_t count = std::min(TexelsPerBlock - first, end - x);
+            std::copy(texels + first, texels + first + count, row + (x - x0));
+            x += count;
+        }
+    }
+
+#if SIMD_X86
+    // High halves of the 32x32 bit products of all eight lanes
+    SIMD_TARGET_AVX2 inline __m256i MulHi(__m256i a, __m256i multiplier)
+    {
+        __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(a, multiplier), 32);
+        __m256i odd = _mm256_mul_epu32(_mm256_srli_epi64(a, 32), multiplier);
+        return _mm256_blend_epi32(even, odd, 0xAA);
+    }
+
+    // Two texels per 32-bit lane: (low16 * maxValue) >> 16 in byte 0, (high16 * maxValue) >> 16 in byte 1
+    SIMD_TARGET_AVX2 inline __m256i ScaleToTexels(__m256i words, __m256i maxValue)
+    {
+        __m256i low = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_and_si256(words, _mm256_set1_epi32(0xFFFF)), maxValue), 16);
+        __m256i high = _mm256_srli_epi32(_mm256_mullo_epi32(_mm256_srli_epi32(words, 16), maxValue), 16);
+        return _mm256_or_si256(low, _mm256_slli_epi32(high, 8));
+    }
+
+    // Eight Philox blocks (64 texels) per iteration, counters in structure of arrays layout
+    SIMD_TARGET_AVX2 void GenerateRowAvx2(uint64_t seed, uint32_t x0, uint32_t y, uint32_t width, uint32_t maxValue, uint8_t* row)
+    {
+        const uint32_t end = x0 + width;
+
+        // Unaligned head and everything that does not fill eight blocks go through the scalar path
+        uint32_t x = std::min(end, (x0 + TexelsPerBlock - 1) / TexelsPerBlock * TexelsPerBlock);
+        GenerateRowScalar(seed, x0, y, x - x0, maxValue, row);
+
+        const __m256i m0 = _mm256_set1_epi32(static_cast<int>(PhiloxM0));
+        const __m256i m1 = _mm256_set1_epi32(static_cast<int>(PhiloxM1));
+        const __m256i scale = _mm256_set1_epi32(static_cast<int>(maxValue));
+        const __m256i laneOffsets = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+        for (; x + 8 * TexelsPerBlock <= end; x += 8 * TexelsPerBlock)
+        {
+            __m256i c0 = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(x / TexelsPerBlock)), laneOffsets);
+            __m256i c1 = _mm256_set1_epi32(static_cast<int>(y));
+            __m256i c2 = _mm256_setzero_si256();
+            __m256i c3 = _mm256_setzero_si256();
+            uint32_t k0 = static_cast<uint32_t>(seed);
+            uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+
+            for (uint32_t round = 0; round < PhiloxRounds; ++round)
+            {
+                __m256i hi0 = MulHi(c0, m0);
+                __m256i lo0 = _mm256_mullo_epi32(c0, m0);
+                __m256i hi1 = MulHi(c2, m1);
+                __m256i lo1 = _mm256_mullo_epi32(c2, m1);
+                c0 = _mm256_xor_si256(_mm256_xor_si256(hi1, c1), _mm256_set1_epi32(static_cast<int>(k0)));
+                c1 = lo1;
+                c2 = _mm256_xor_si256(_mm256_xor_si256(hi0, c3), _mm256_set1_epi32(static_cast<int>(k1)));
+                c3 = lo0;
+                k0 += PhiloxW0;
+                k1 += PhiloxW1;
+            }
+
+            // Lane j holds texels 0-3 of block j in t01 and texels 4-7 in t23
+            __m256i t01 = _mm256_or_si256(ScaleToTexels(c0, scale), _mm256_slli_epi32(ScaleToTexels(c1, scale), 16));
+            __m256i t23 = _mm256_or_si256(ScaleToTexels(c2, scale), _mm256_slli_epi32(ScaleToTexels(c3, scale), 16));
+
+            // Blocks 0, 1 | 4, 5 and 2, 3 | 6, 7, then back into memory order
+            __m256i lo = _mm256_unpacklo_epi32(t01, t23);
+            __m256i hi = _mm256_unpackhi_epi32(t01, t23);
+            uint8_t* out = row + (x - x0);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _mm256_permute2x128_si256(lo, hi, 0x20));
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 32), _mm256_permute2x128_si256(lo, hi, 0x31));
+        }
+
+        GenerateRowScalar(seed, x, y, end - x, maxValue, row + (x - x0));
+    }
+#endif
+
+    void CheckMaxValue(uint32_t maxValue)
+    {
+        if (maxValue == 0 || maxValue > 256)
+        {
+            throw std::runtime_error("maxValue has to be in [1, 256]");
+        }
+    }
+}
+
+PhiloxBlock Philox4x32(const uint32_t counter[4], uint64_t seed)
+{
+    uint32_t c0 = counter[0];
+    uint32_t c1 = counter[1];
+    uint32_t c2 = counter[2];
+    uint32_t c3 = counter[3];
+    uint32_t k0 = static_cast<uint32_t>(seed);
+    uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+
+    for (uint32_t round = 0; round < PhiloxRounds; ++round)
+    {
+        const uint64_t product0 = static_cast<uint64_t>(PhiloxM0) * c0;
+        const uint64_t product1 = static_cast<uint64_t>(PhiloxM1) * c2;
+        const uint32_t hi0 = static_cast<uint32_t>(product0 >> 32);
+        const uint32_t hi1 = static_cast<uint32_t>(product1 >> 32);
+        c0 = hi1 ^ c1 ^ k0;
+        c1 = static_cast<uint32_t>(product1);
+        c2 = hi0 ^ c3 ^ k1;
+        c3 = static_cast<uint32_t>(product0);
+        k0 += PhiloxW0;
+        k1 += PhiloxW1;
+    }
+
+    return { { c0, c1, c2, c3 } };
+}
+
+uint8_t GeneratePhiloxTexel(uint64_t seed, uint32_t x, uint32_t y, uint32_t maxValue)
+{
+    CheckMaxValue(maxValue);
+    const uint32_t counter[4] = { x / TexelsPerBlock, y, 0, 0 };
+    uint8_t texels[TexelsPerBlock];
+    BlockToTexels(Philox4x32(counter, seed), maxValue, texels);
+    return texels[x % TexelsPerBlock];
+}
+
+void GeneratePhiloxTile(uint64_t seed, uint32_t x0, uint32_t y0, uint32_t width, uint32_t height, uint32_t maxValue, uint8_t* texels, size_t rowPitch)
+{
+    GeneratePhiloxTile(seed, x0, y0, width, height, maxValue, texels, rowPitch, DetectSimdLevel());
+}
+
+void GeneratePhiloxTile(uint64_t seed, uint32_t x0, uint32_t y0, uint32_t width, uint32_t height, uint32_t maxValue, uint8_t* texels, size_t rowPitch, SimdLevel level)
+{
+    CheckMaxValue(maxValue);
+    if (rowPitch < width)
+    {
+        throw std::runtime_error("rowPitch is smaller than the tile width");
+    }
+    level = std::min(level, DetectSimdLevel());
+
+    for (uint32_t y = 0; y < height; ++y)
+    {
+        uint8_t* row = texels + y * rowPitch;
+#if SIMD_X86
+        if (level >= SimdLevel::Avx2)
+        {
+            GenerateRowAvx2(seed, x0, y0 + y, width, maxValue, row);
+            continue;
+        }
+#endif
+        GenerateRowScalar(seed, x0, y0 + y, width, maxValue, row);
+    }
+}
+
+std::vector<uint8_t> GeneratePhiloxTextureData(uint64_t seed, uint32_t width, uint32_t height, uint32_t maxValue, WorkStealingThreadPool* pool)
+{
+    std::vector<uint8_t> textureBytes(static_cast<size_t>(width) * height);
+    if (pool == nullptr)
+    {
+        GeneratePhiloxTile(seed, 0, 0, width, height, maxValue, textureBytes.data(), width);
+        return textureBytes;
+    }
+
+    // Bands of rows, each band is independent of the others
+    const uint32_t rowsPerTask = 16;
+    const size_t taskCount = (height + rowsPerTask - 1) / rowsPerTask;
+    pool->ParallelFor(taskCount, 1, [&](size_t task, unsigned int)
+    {
+        const uint32_t y0 = static_cast<uint32_t>(task) * rowsPerTask;
+        const uint32_t rows = std::min(rowsPerTask, height - y0);
+        GeneratePhiloxTile(seed, 0, y0, width, rows, maxValue, textureBytes.data() + static_cast<size_t>(y0) * width, width);
+    });
+    return textureBytes;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "SimdReduction.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class WorkStealingThreadPool;
+
+// Deterministic R8 test textures from the Philox4x32-10 counter-based generator.
+//
+// Texel (x, y) depends only on (seed, x, y): one Philox call with counter { x / 8, y, 0, 0 } and
+// key { low, high 32 bits of seed } gives four 32-bit words, i.e. eight 16-bit values for texels
+// x / 8 * 8 ... + 7 (word i low half -> texel 2i, high half -> texel 2i + 1). A 16-bit value v
+// becomes the texel (v * maxValue) >> 16, so texels are in [0, maxValue).
+// Any tile can therefore be generated on its own, in any order, on any thread, with the same bits
+// on every platform and SIMD level.
+
+struct PhiloxBlock
+{
+    uint32_t words[4];
+};
+
+// Philox4x32 with 10 rounds (Random123 constants)
+PhiloxBlock Philox4x32(const uint32_t counter[4], uint64_t seed);
+
+// Single texel, the reference for the fill kernels
+uint8_t GeneratePhiloxTexel(uint64_t seed, uint32_t x, uint32_t y, uint32_t maxValue);
+
+// Fills the width x height tile starting at texel (x0, y0) of the virtual texture into texels,
+// rowPitch bytes apart. maxValue has to be in [1, 256].
+void GeneratePhiloxTile(uint64_t seed, uint32_t x0, uint32_t y0, uint32_t width, uint32_t height, uint32_t maxValue, uint8_t* texels, size_t rowPitch);
+
+// Same with an explicit kernel, levels above DetectSimdLevel() fall back to the detected level
+void GeneratePhiloxTile(uint64_t seed, uint32_t x0, uint32_t y0, uint32_t width, uint32_t height, uint32_t maxValue, uint8_t* texels, size_t rowPitch, SimdLevel level);
+
+// Whole tightly packed texture, rows are spread over pool when one is given
+std::vector<uint8_t> GeneratePhiloxTextureData(uint64_t seed, uint32_t width, uint32_t height, uint32_t maxValue, WorkStealingThreadPool* pool = nullptr);
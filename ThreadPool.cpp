@@ -0,0 +1,163 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+WorkStealingThreadPool::WorkStealingThreadPool(unsigned int workerCount)
+{
+    if (workerCount == 0)
+    {
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    m_ranges.reset(new WorkerRange[workerCount]);
+    m_threads.reserve(workerCount);
+    for (unsigned int i = 0; i < workerCount; ++i)
+    {
+        m_threads.emplace_back(&WorkStealingThreadPool::WorkerMain, this, i);
+    }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        m_shutdown = true;
+    }
+    m_jobReady.notify_all();
+    for (std::thread& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+void WorkStealingThreadPool::ParallelFor(size_t count, size_t grain, const std::function<void(size_t, unsigned int)>& body)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    std::lock_guard<std::mutex> job(m_jobMutex);
+    const size_t workerCount = m_threads.size();
+
+    // Contiguous start ranges keep neighbouring tiles on the same core
+    for (size_t i = 0; i < workerCount; ++i)
+    {
+        std::lock_guard<std::mutex> lock(m_ranges[i].mutex);
+        m_ranges[i].begin = count * i / workerCount;
+        m_ranges[i].end = count * (i + 1) / workerCount;
+    }
+    m_body = &body;
+    m_grain = std::max<size_t>(1, grain);
+
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(m_stateMutex);
+        m_activeWorkers = static_cast<unsigned int>(workerCount);
+        m_error = nullptr;
+        ++m_jobGeneration;
+        m_jobReady.notify_all();
+        m_jobDone.wait(lock, [this]() { return m_activeWorkers == 0; });
+        error = m_error;
+        m_error = nullptr;
+    }
+    m_body = nullptr;
+
+    if (error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+void WorkStealingThreadPool::WorkerMain(unsigned int workerIndex)
+{
+    uint64_t seenGeneration = 0;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(m_stateMutex);
+            m_jobReady.wait(lock, [&]() { return m_shutdown || m_jobGeneration != seenGeneration; });
+            if (m_shutdown)
+            {
+                return;
+            }
+            seenGeneration = m_jobGeneration;
+        }
+
+        // Once nothing is left to take or steal, everything left is already running on other workers
+        for (;;)
+        {
+            size_t begin;
+            size_t end;
+            if (!TakeOwnWork(workerIndex, begin, end))
+            {
+                if (!StealWork(workerIndex))
+                {
+                    break;
+                }
+                continue;
+            }
+            for (size_t index = begin; index < end; ++index)
+            {
+                try
+                {
+                    (*m_body)(index, workerIndex);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(m_stateMutex);
+                    if (!m_error)
+                    {
+                        m_error = std::current_exception();
+                    }
+                }
+            }
+        }
+
+        std::lock_guard<std::mutex> lock(m_stateMutex);
+        if (--m_activeWorkers == 0)
+        {
+            m_jobDone.notify_all();
+        }
+    }
+}
+
+bool WorkStealingThreadPool::TakeOwnWork(unsigned int workerIndex, size_t& begin, size_t& end)
+{
+    WorkerRange& range = m_ranges[workerIndex];
+    std::lock_guard<std::mutex> lock(range.mutex);
+    if (range.begin >= range.end)
+    {
+        return false;
+    }
+
+    begin = range.begin;
+    end = std::min(range.end, range.begin + m_grain);
+    range.begin = end;
+    return true;
+}
+
+bool WorkStealingThreadPool::StealWork(unsigned int workerIndex)
+{
+    const unsigned int workerCount = static_cast<unsigned int>(m_threads.size());
+    for (unsigned int offset = 1; offset < workerCount; ++offset)
+    {
+        // Both locks at once, so a stolen range is never invisible to the other thieves on its way over
+        WorkerRange& victim = m_ranges[(workerIndex + offset) % workerCount];
+        WorkerRange& own = m_ranges[workerIndex];
+        std::lock(victim.mutex, own.mutex);
+        std::lock_guard<std::mutex> victimLock(victim.mutex, std::adopt_lock);
+        std::lock_guard<std::mutex> ownLock(own.mutex, std::adopt_lock);
+        if (victim.begin >= victim.end)
+        {
+            continue;
+        }
+        const size_t available = victim.end - victim.begin;
+
+        // Take the back half, or everything when only one chunk is left
+        own.begin = available > m_grain ? victim.begin + available / 2 : victim.begin;
+        own.end = victim.end;
+        victim.end = own.begin;
+        return true;
+    }
+    return false;
+}
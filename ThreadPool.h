@@ -0,0 +1,62 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads running index ranges with work stealing.
+// ParallelFor splits [0, count) into one contiguous range per worker. A worker takes grain sized
+// chunks from the front of its own range; once it runs dry it steals the back half of the largest
+// range left on another worker, so uneven tiles still keep every core busy. Ranges only shrink while a job
+// runs, so a worker that finds nothing to take or steal waits for the next job instead of spinning.
+class WorkStealingThreadPool
+{
+public:
+    // workerCount 0 uses all hardware threads
+    explicit WorkStealingThreadPool(unsigned int workerCount = 0);
+    ~WorkStealingThreadPool();
+
+    WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+    WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
+
+    unsigned int GetWorkerCount() const { return static_cast<unsigned int>(m_threads.size()); }
+
+    // Calls body(index, workerIndex) for every index in [0, count) and returns once all calls are done.
+    // workerIndex is in [0, GetWorkerCount()) and can address per-worker partial results.
+    // The first exception thrown by body is rethrown here after the remaining indices ran, those of the
+    // chunk that threw included.
+    void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, unsigned int)>& body);
+
+private:
+    struct alignas(64) WorkerRange
+    {
+        std::mutex mutex;
+        size_t begin = 0;
+        size_t end = 0;
+    };
+
+    void WorkerMain(unsigned int workerIndex);
+    bool TakeOwnWork(unsigned int workerIndex, size_t& begin, size_t& end);
+    bool StealWork(unsigned int workerIndex);
+
+    std::vector<std::thread> m_threads;
+    std::unique_ptr<WorkerRange[]> m_ranges;
+
+    std::mutex m_jobMutex;                  // serializes ParallelFor callers
+    std::mutex m_stateMutex;
+    std::condition_variable m_jobReady;
+    std::condition_variable m_jobDone;
+    uint64_t m_jobGeneration = 0;
+    bool m_shutdown = false;
+
+    const std::function<void(size_t, unsigned int)>* m_body = nullptr;
+    size_t m_grain = 1;
+    unsigned int m_activeWorkers = 0;
+    std::exception_ptr m_error;
+};
@@ -0,0 +1,52 @@
+#include "TiledReduction.h"
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+namespace
+{
+    // Own cache line per worker so partial results do not false share
+    struct alignas(64) WorkerPartial
+    {
+        MinMaxResult value = { UINT32_MAX, 0 };
+    };
+}
+
+MinMaxResult TiledReduceMinMax(WorkStealingThreadPool& pool, const void* texels, uint32_t width, uint32_t height, size_t rowPitch, TexelFormat format, const TiledReductionConfig& config)
+{
+    if (config.tileWidth == 0 || config.tileHeight == 0)
+    {
+        throw std::runtime_error("Tile size must be non-zero");
+    }
+    if (width == 0 || height == 0)
+    {
+        return { UINT32_MAX, 0 };
+    }
+
+    const uint32_t tilesX = (width + config.tileWidth - 1) / config.tileWidth;
+    const uint32_t tilesY = (height + config.tileHeight - 1) / config.tileHeight;
+    const size_t texelSize = GetTexelSize(format);
+    const uint8_t* base = static_cast<const uint8_t*>(texels);
+
+    std::vector<WorkerPartial> partials(pool.GetWorkerCount());
+    pool.ParallelFor(static_cast<size_t>(tilesX) * tilesY, config.tilesPerTask, [&](size_t tile, unsigned int worker)
+    {
+        const uint32_t x0 = static_cast<uint32_t>(tile % tilesX) * config.tileWidth;
+        const uint32_t y0 = static_cast<uint32_t>(tile / tilesX) * config.tileHeight;
+        const uint32_t tileWidth = std::min(config.tileWidth, width - x0);
+        const uint32_t tileHeight = std::min(config.tileHeight, height - y0);
+
+        MinMaxResult tileResult = ReduceMinMax(base + y0 * rowPitch + x0 * texelSize, tileWidth, tileHeight, rowPitch, format);
+        MinMaxResult& partial = partials[worker].value;
+        partial.minValue = std::min(partial.minValue, tileResult.minValue);
+        partial.maxValue = std::max(partial.maxValue, tileResult.maxValue);
+    });
+
+    MinMaxResult result = { UINT32_MAX, 0 };
+    for (const WorkerPartial& partial : partials)
+    {
+        result.minValue = std::min(result.minValue, partial.value.minValue);
+        result.maxValue = std::max(result.maxValue, partial.value.maxValue);
+    }
+    return result;
+}
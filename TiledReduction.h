@@ -0,0 +1,17 @@
+#pragma once
+
+#include "SimdReduction.h"
+#include "ThreadPool.h"
+
+// Min/max of a whole image split into tiles that are spread over a WorkStealingThreadPool.
+// Each worker folds its tiles into its own partial result, the partials are combined once at the end.
+// Tiles of 8/16/32 mirror the thread group tiling of the compute shaders, larger tiles amortize
+// scheduling for big textures.
+struct TiledReductionConfig
+{
+    uint32_t tileWidth = 256;
+    uint32_t tileHeight = 64;
+    size_t tilesPerTask = 1;    // grain handed to the pool
+};
+
+MinMaxResult TiledReduceMinMax(WorkStealingThreadPool& pool, const void* texels, uint32_t width, uint32_t height, size_t rowPitch, TexelFormat format, const TiledReductionConfig& config = TiledReductionConfig());
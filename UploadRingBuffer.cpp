@@ -0,0 +1,87 @@
+#include "UploadRingBuffer.h"
+#include "d3dx12.h"
+#include <stdexcept>
+#include <string>
+
+UploadRingBuffer::UploadRingBuffer(ID3D12Device* device, PlacedResourceAllocator& allocator, uint64_t capacity)
+    : m_device(device), m_ring(capacity)
+{
+    m_buffer = allocator.CreateResource(CD3DX12_RESOURCE_DESC::Buffer(capacity), D3D12_RESOURCE_STATE_GENERIC_READ, "upload ring");
+
+    // Upload heap resources may stay mapped while the GPU reads them, the CPU never reads
+    const D3D12_RANGE noRead = { 0, 0 };
+    void* mapped = nullptr;
+    if (FAILED(m_buffer->Map(0, &noRead, &mapped)))
+    {
+        throw std::runtime_error("Failed to map upload ring");
+    }
+    m_mapped = static_cast<uint8_t*>(mapped);
+
+    if (FAILED(device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence))))
+    {
+        throw std::runtime_error("Failed to create fence");
+    }
+    m_fenceEvent = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (m_fenceEvent == nullptr)
+    {
+        throw std::runtime_error("Failed to create event handle");
+    }
+}
+
+UploadRingBuffer::~UploadRingBuffer()
+{
+    if (m_fenceEvent)
+    {
+        CloseHandle(m_fenceEvent);
+    }
+}
+
+UploadRegion UploadRingBuffer::AllocateTexture(const D3D12_RESOURCE_DESC& desc)
+{
+    UploadRegion region;
+    UINT64 size = 0;
+    m_device->GetCopyableFootprints(&desc, 0, 1, 0, &region.footprint, nullptr, nullptr, &size);
+    if (size == UINT64_MAX || size > m_ring.GetCapacity())
+    {
+        throw std::runtime_error("Cannot allocate " + std::to_string(size) + " bytes from an upload ring of " + std::to_string(m_ring.GetCapacity()));
+    }
+
+    m_ring.Release(m_fence->GetCompletedValue());
+    uint64_t offset = m_ring.Allocate(size, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+    while (offset == InvalidRingOffset)
+    {
+        uint64_t fenceValue = 0;
+        if (!m_ring.GetOldestFenceValue(fenceValue))
+        {
+            throw std::runtime_error("Upload ring is full of allocations that were never retired");
+        }
+        if (m_fence->GetCompletedValue() < fenceValue)
+        {
+            m_fence->SetEventOnCompletion(fenceValue, m_fenceEvent);
+            WaitForSingleObject(m_fenceEvent, INFINITE);
+        }
+        m_ring.Release(fenceValue);
+        offset = m_ring.Allocate(size, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+    }
+
+    region.data = m_mapped + offset;
+    region.buffer = m_buffer.Get();
+    region.footprint.Offset = offset;
+    return region;
+}
+
+void UploadRingBuffer::Retire(ID3D12CommandQueue* commandQueue)
+{
+    commandQueue->Signal(m_fence.Get(), ++m_fenceValue);
+    m_ring.Retire(m_fenceValue);
+}
+
+void UploadRingBuffer::Retire(ID3D12CommandQueue* commandQueue, const UploadRegion& region)
+{
+    if (region.buffer != m_buffer.Get())
+    {
+        throw std::runtime_error("Upload region does not belong to this ring");
+    }
+    Retire(commandQueue);
+    m_ring.Extend(region.footprint.Offset, m_fenceValue);
+}
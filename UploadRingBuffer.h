@@ -0,0 +1,53 @@
+#pragma once
+
+#include "PlacedResourceAllocator.h"
+#include "RingBufferAllocator.h"
+#include <d3d12.h>
+#include <wrl.h>
+#include <cstdint>
+
+using namespace Microsoft::WRL;
+
+// Subresource data in an upload ring, laid out for CopyTextureRegion
+struct UploadRegion
+{
+    uint8_t* data = nullptr;                            // mapped memory at footprint.Offset
+    ID3D12Resource* buffer = nullptr;
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = {};
+};
+
+// One upload heap buffer that stays mapped for its whole lifetime, so producers write straight into
+// it instead of into a host copy that Map/memcpy/Unmap moves over. Regions are handed out by a
+// RingBufferAllocator and retired on the ring's own fence, like the transient descriptors of
+// DescriptorHeap. Upload heap memory is write-combined: write it sequentially and never read it.
+class UploadRingBuffer
+{
+public:
+    UploadRingBuffer(ID3D12Device* device, PlacedResourceAllocator& allocator, uint64_t capacity);
+    ~UploadRingBuffer();
+
+    UploadRingBuffer(const UploadRingBuffer&) = delete;
+    UploadRingBuffer& operator=(const UploadRingBuffer&) = delete;
+
+    // Subresource 0 of desc at its GetCopyableFootprints layout (256 byte rows, 512 byte placement).
+    // Releases completed regions and, when the ring is still full, waits for the oldest submission.
+    // Throws when the footprint can never fit or nothing has been retired yet.
+    UploadRegion AllocateTexture(const D3D12_RESOURCE_DESC& desc);
+    // Regions allocated so far stay reserved until the GPU passes this point of queue
+    void Retire(ID3D12CommandQueue* commandQueue);
+    // Retire after every submission that reads region: a region submitted again is kept until the
+    // last of them has completed, not only the first
+    void Retire(ID3D12CommandQueue* commandQueue, const UploadRegion& region);
+
+    uint64_t GetCapacity() const { return m_ring.GetCapacity(); }
+    uint64_t GetUsedBytes() const { return m_ring.GetUsedBytes(); }
+
+private:
+    ID3D12Device* m_device;
+    PlacedResource m_buffer;
+    uint8_t* m_mapped = nullptr;
+    RingBufferAllocator m_ring;
+    ComPtr<ID3D12Fence> m_fence;
+    uint64_t m_fenceValue = 0;
+    HANDLE m_fenceEvent = nullptr;
+};
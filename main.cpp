@@ -1,38 +1,437 @@
-#include "DeviceResources.h"
-#include "ShaderUtils.h"
-#include "PipelineState.h"
+#include "ReductionBackend.h"
+#include "ReductionLayout.h"
+#include "Autotuner.h"
+#include "BenchmarkHarness.h"
+#include "RegressionGate.h"
+#include "ShaderArchive.h"
+#include "BuddyAllocator.h"
+#include "CaptureWriter.h"
+#include "DescriptorAllocator.h"
+#include "RingBufferAllocator.h"
+#include "SubmissionScheduler.h"
+#include "EmulatedKernels.h"
+#include "SimdReduction.h"
+#include "TextureData.h"
+#include "TextureDistributions.h"
+#include "TextureGenerator.h"
+#include "ThreadPool.h"
+#include <deque>
+#include <fstream>
 #include <vector>
 #include <numeric>
 #include <iostream>
 #include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
 
-int main()
+int main(int argc, char* argv[])
 {
-    ComPtr<ID3D12Device> device;
-    ComPtr<ID3D12CommandQueue> commandQueue;
-    ComPtr<ID3D12CommandAllocator> commandAllocator;
-    ComPtr<ID3D12GraphicsCommandList> commandList;
+    // Backend selection - d3d12 (default on Windows), cpu or emulator, "profile" prints the groupshared cost model,
+    // "validate" checks the full GPU reduction in the emulator. The optional second argument selects the
+    // reduction strategy, partials (default) or atomic. "--capture <file>" records every input texture
+    // into a binary capture file (see CaptureWriter.h), "--replay <textureData.txt>" benchmarks a saved
+    // text dump instead of random data, "--seed <n>" picks the Philox seed of the first run (every run
+    // uses the next seed, so a run is reproducible from the seed stored in its capture record).
+    // "--distribution <name>" picks the input distribution (see TextureDistributions.h), uniform by default.
+    // Every configuration is timed by the benchmark harness (see BenchmarkHarness.h): "--json <file>" and
+    // "--csv <file>" write the statistics of all configurations, "--mock-timing" replaces the backend
+    // timings with a deterministic fake source to exercise the harness without a GPU.
+    // "compare <baseline> <candidate>" is the regression gate (see RegressionGate.h) over two JSON result
+    // files or legacy stats.txt dumps, "--threshold <percent>" and "--alpha <p>" tune it; it exits with 1
+    // when a configuration regressed.
+    // "--autotune" replaces the thread group size sweep with the variant ReductionAutotuner picks per texture
+    // size, remembered in "--tuning-db <file>" (TuningDatabase.txt by default) under the backend's device id
+    // or "--device-id <id>"
+    // "pack-shaders <archive> [<kernel>:<group size>=<bytecode file> ...]" writes a ShaderArchive (see
+    // ShaderArchive.h) of the given compiled shaders, or of the embedded permutations when none are given.
+    // "descriptors" and "heaps" run the descriptor allocators (see DescriptorAllocator.h) and the placed
+    // resource heap pool (see BuddyAllocator.h) on a synthetic workload, "upload" the host side of the
+    // texture upload ring (see RingBufferAllocator.h), "submission" the frames-in-flight scheduling
+    // against a simulated queue (see SubmissionScheduler.h).
+    // "scaling" times the CPU backend on a 16384x16384 texture with 1, 2, 4, ... workers and reports GB/s per
+    // worker count, always with real timings.
+#if defined(_WIN32)
+    std::string backendName = "d3d12";
+#else
+    std::string backendName = "cpu";
+#endif
+    std::string strategyName = "partials";
+    std::string captureFile;
+    std::string replayFile;
+    uint64_t seed = 1;
+    std::string distributionName = "uniform";
+    std::string jsonFile;
+    std::string csvFile;
+    bool mockTiming = false;
+    RegressionGateOptions gateOptions;
+    bool autotune = false;
+    std::string tuningDatabaseFile = "TuningDatabase.txt";
+    std::string deviceId;
+    std::vector<std::string> positional;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--capture" && i + 1 < argc)
+        {
+            captureFile = argv[++i];
+        }
+        else if (arg == "--replay" && i + 1 < argc)
+        {
+            replayFile = argv[++i];
+        }
+        else if (arg == "--seed" && i + 1 < argc)
+        {
+            seed = std::stoull(argv[++i]);
+        }
+        else if (arg == "--distribution" && i + 1 < argc)
+        {
+            distributionName = argv[++i];
+        }
+        else if (arg == "--json" && i + 1 < argc)
+        {
+            jsonFile = argv[++i];
+        }
+        else if (arg == "--csv" && i + 1 < argc)
+        {
+            csvFile = argv[++i];
+        }
+        else if (arg == "--mock-timing")
+        {
+            mockTiming = true;
+        }
+        else if (arg == "--autotune")
+        {
+            autotune = true;
+        }
+        else if (arg == "--tuning-db" && i + 1 < argc)
+        {
+            tuningDatabaseFile = argv[++i];
+        }
+        else if (arg == "--device-id" && i + 1 < argc)
+        {
+            deviceId = argv[++i];
+        }
+        else if (arg == "--threshold" && i + 1 < argc)
+        {
+            gateOptions.thresholdPercent = std::stod(argv[++i]);
+        }
+        else if (arg == "--alpha" && i + 1 < argc)
+        {
+            gateOptions.alpha = std::stod(argv[++i]);
+        }
+        else
+        {
+            positional.push_back(arg);
+        }
+    }
+    if (positional.size() > 0)
+    {
+        backendName = positional[0];
+    }
+    if (positional.size() > 1)
+    {
+        strategyName = positional[1];
+    }
+
+    // Regression gate, candidate against baseline
+    if (backendName == "compare")
+    {
+        if (positional.size() != 3)
+        {
+            std::cerr << "compare needs a baseline and a candidate result file" << std::endl;
+            return -1;
+        }
+        try
+        {
+            std::vector<RegressionComparison> comparisons = CompareBenchmarkResults(LoadBenchmarkResults(positional[1]), LoadBenchmarkResults(positional[2]), gateOptions);
+            bool regressed = WriteRegressionReport(std::cout, comparisons);
+            std::cout << (regressed ? "Performance regression detected" : "No performance regression") << std::endl;
+            return regressed ? 1 : 0;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    // Shader archive for deployment, read back once so a broken archive fails here rather than at startup
+    if (backendName == "pack-shaders")
+    {
+        if (positional.size() < 2)
+        {
+            std::cerr << "pack-shaders needs an archive file" << std::endl;
+            return -1;
+        }
+        try
+        {
+            std::vector<ShaderPermutation> permutations;
+            std::vector<std::unique_ptr<MappedFile>> bytecodeFiles;
+            for (size_t i = 2; i < positional.size(); ++i)
+            {
+                const std::string& spec = positional[i];
+                const size_t colon = spec.find(':');
+                const size_t equals = spec.find('=', colon);
+                if (colon == std::string::npos || equals == std::string::npos)
+                {
+                    throw std::runtime_error("Expected <kernel>:<group size>=<bytecode file>, got " + spec);
+                }
+                bytecodeFiles.push_back(std::make_unique<MappedFile>(spec.substr(equals + 1)));
+                permutations.push_back({ ParseShaderKernel(spec.substr(0, colon)), static_cast<uint32_t>(std::stoul(spec.substr(colon + 1, equals - colon - 1))),
+                    bytecodeFiles.back()->Data(), bytecodeFiles.back()->Size() });
+            }
+            if (positional.size() == 2)
+            {
+                size_t count = 0;
+                const ShaderPermutation* embedded = GetShaderPermutations(count);
+                permutations.assign(embedded, embedded + count);
+            }
+
+            WriteShaderArchive(positional[1], permutations);
+            ShaderArchive archive(positional[1]);
+            for (const ShaderPermutation& permutation : permutations)
+            {
+                archive.Find(permutation.kernel, permutation.threadGroupSize);
+            }
+            std::cout << "Packed " << archive.GetPermutationCount() << " shader permutations into " << positional[1] << std::endl;
+            return 0;
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+    }
+
+    // Allocator throughput and fragmentation, no device is created
+    if (backendName == "descriptors")
+    {
+        WriteDescriptorAllocatorReport(std::cout, 4096, 1000000, 3, seed);
+        return 0;
+    }
+    if (backendName == "heaps")
+    {
+        WriteHeapPoolReport(std::cout, 1000000, seed);
+        return 0;
+    }
+    if (backendName == "upload")
+    {
+        WorkStealingThreadPool uploadPool;
+        WriteTextureUploadReport(std::cout, 4096, 4096, 64, 3, seed, &uploadPool);
+        return 0;
+    }
+    if (backendName == "submission")
+    {
+        WriteSubmissionReport(std::cout, 10000, 0.2, 0.5, 0.3, seed);
+        return 0;
+    }
+
+    // Memory bandwidth of the CPU reduction per worker count, on a texture far larger than the caches
+    if (backendName == "scaling")
+    {
+        const uint32_t size = 16384;
+        std::unique_ptr<IReductionBackend> backend = CreateReductionBackend(ReductionBackendType::Cpu);
+        backend->CreateDevice();
+        TextureUploadRegion region = backend->BeginTextureUpload(size, size);
+        WorkStealingThreadPool generatorPool;
+        GenerateDistributionTexture(seed, MakeTextureDistributionParams(TextureDistribution::Uniform, size, size), region.texels, region.rowPitch, false, &generatorPool);
+        const uint32_t expected = ReduceMinMax(region.texels, size, size, region.rowPitch, TexelFormat::R8).maxValue;
+        backend->EndTextureUpload();
+
+        const unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        std::vector<unsigned int> workerCounts;
+        for (unsigned int workers = 1; workers < hardwareThreads; workers *= 2)
+        {
+            workerCounts.push_back(workers);
+        }
+        workerCounts.push_back(hardwareThreads);
+
+        const double gigabytes = static_cast<double>(size) * size / 1e9;
+        double singleWorkerMs = 0.0;
+        std::cout << "CPU reduction scaling, " << size << "x" << size << " R8, seed " << seed << std::endl;
+        for (unsigned int workers : workerCounts)
+        {
+            TuningVariant variant;
+            variant.workerCount = workers;
+            backend->ApplyTuningVariant(variant);
+            bool matches = true;
+            const BenchmarkStats stats = RunBenchmark(BenchmarkOptions(), [&]()
+            {
+                backend->Dispatch(16);
+                matches = matches && backend->ReadBack() == expected;
+                return backend->GetLastDispatchTimeMs();
+            });
+            if (!matches)
+            {
+                std::cout << "Mismatch with " << workers << " workers" << std::endl;
+                return -1;
+            }
+            if (workers == 1)
+            {
+                singleWorkerMs = stats.medianMs;
+            }
+            std::cout << "Workers " << workers << ": median " << stats.medianMs << " ms, " << gigabytes / (stats.medianMs / 1000.0) << " GB/s, speedup "
+                << singleWorkerMs / stats.medianMs << std::endl;
+        }
+        return 0;
+    }
+
+    // Groupshared memory cost report of every thread group size, for the current CompuetShader.hlsl and the
+    // original x-only one, plus the InterlockedMax contention of the AtomicMax variant on a random texture
+    if (backendName == "profile")
+    {
+        ComputeEmulator emulator;
+        const std::vector<uint8_t> atomicTexture = GenerateRandomTextureData(1024, 1024);
+        for (uint32_t threadGroupSize : { 8u, 16u, 32u })
+        {
+            std::string variant = std::to_string(threadGroupSize) + "x" + std::to_string(threadGroupSize) + "x1";
+            WriteSharedMemoryProfileReport(std::cout, variant, ProfileMaxReductionKernel(emulator, threadGroupSize, 1024, 1024, SharedMemoryBankConfig()));
+            WriteSharedMemoryProfileReport(std::cout, "legacy " + variant, ProfileLegacyMaxReductionKernel(emulator, threadGroupSize, 1024, 1024, SharedMemoryBankConfig()));
+            EmulatorDispatchStats atomicStats;
+            EmulateAtomicMaxReduction(emulator, atomicTexture, 1024, 1024, threadGroupSize, &atomicStats);
+            std::cout << "AtomicMax " << variant << ": deviceAtomics " << atomicStats.deviceAtomics << ", atomicRetries " << atomicStats.atomicRetries << std::endl;
+            std::cout << "----------------------------------------------------" << std::endl;
+        }
+        WriteSharedMemoryProfileReport(std::cout, "groupshared_mem 16x16x1", ProfileRowMaxReductionKernel(emulator, 1024, 1024, SharedMemoryBankConfig()));
+        std::cout << "----------------------------------------------------" << std::endl;
+        return 0;
+    }
 
-    CreateDeviceAndCommandObjects(device, commandQueue, commandAllocator, commandList);
+    // Full GPU reduction (BufferReduction.hlsl passes) against the CPU finish of the intermediate buffer,
+    // both against the host side layout (ReductionLayout.h) on square and non-square sizes
+    if (backendName == "validate")
+    {
+        ComputeEmulator emulator;
+        std::unique_ptr<IReductionBackend> cpuAtomic = CreateReductionBackend(ReductionBackendType::Cpu, ReductionStrategy::AtomicMax);
+        cpuAtomic->CreateDevice();
+        int mismatches = 0;
+        const std::vector<std::pair<uint32_t, uint32_t>> sizes = { { 8, 8 }, { 64, 64 }, { 100, 100 }, { 512, 512 }, { 1024, 1024 }, { 4096, 4096 }, { 100, 37 }, { 7, 1000 }, { 333, 1000 }, { 1920, 1080 } };
+        for (const auto& validateSize : sizes)
+        {
+            const uint32_t width = validateSize.first;
+            const uint32_t height = validateSize.second;
+            const std::string sizeName = std::to_string(width) + "x" + std::to_string(height);
+            for (uint32_t threadGroupSize : { 8u, 16u, 32u })
+            {
+                std::vector<uint8_t> textureBytes = GenerateRandomTextureData(width, height);
+                uint32_t expected = EmulateReadBackR8UNormValues(emulator, textureBytes, width, height, threadGroupSize);
+                uint32_t actual = EmulateGpuReduction(emulator, textureBytes, width, height, threadGroupSize);
+                if (actual != expected)
+                {
+                    std::cout << "Mismatch " << sizeName << " group " << threadGroupSize << ": " << actual << " != " << expected << std::endl;
+                    ++mismatches;
+                }
+
+                // Every group of CompuetShader.hlsl reduces its whole tile, partial edge tiles included
+                const ReductionLayout layout = MakeReductionLayout(width, height, threadGroupSize);
+                std::vector<uint32_t> partials(layout.partialCount);
+                for (uint32_t groupY = 0; groupY < layout.constants.groupsY; ++groupY)
+                {
+                    for (uint32_t groupX = 0; groupX < layout.constants.groupsX; ++groupX)
+                    {
+                        const uint32_t x0 = groupX * threadGroupSize;
+                        const uint32_t y0 = groupY * threadGroupSize;
+                        const uint32_t tileWidth = std::min(threadGroupSize, width - x0);
+                        const uint32_t tileHeight = std::min(threadGroupSize, height - y0);
+                        partials[GetPartialIndex(layout.constants, groupX, groupY)] = ReduceMinMax(textureBytes.data() + static_cast<size_t>(y0) * width + x0, tileWidth, tileHeight, width, TexelFormat::R8).maxValue;
+                    }
+                }
+                const uint32_t layoutMax = ReduceMax(partials.data(), partials.size());
+                const uint32_t trueMax = ReduceMinMax(textureBytes.data(), width, height, width, TexelFormat::R8).maxValue;
+                if (expected != layoutMax || expected != trueMax)
+                {
+                    std::cout << "Layout mismatch " << sizeName << " group " << threadGroupSize << ": " << expected << " != " << layoutMax << " (true max " << trueMax << ")" << std::endl;
+                    ++mismatches;
+                }
+
+                // The InterlockedMax variant reduces whole tiles too, in the emulator and on the CPU backend
+                EmulatorDispatchStats atomicStats;
+                uint32_t atomicMax = EmulateAtomicMaxReduction(emulator, textureBytes, width, height, threadGroupSize, &atomicStats);
+                if (atomicMax != trueMax)
+                {
+                    std::cout << "Atomic mismatch " << sizeName << " group " << threadGroupSize << ": " << atomicMax << " != " << trueMax << std::endl;
+                    ++mismatches;
+                }
+                cpuAtomic->UploadTexture(textureBytes.data(), width, height, width);
+                cpuAtomic->Dispatch(threadGroupSize);
+                AtomicReductionStats cpuAtomicStats;
+                cpuAtomic->GetLastAtomicStats(cpuAtomicStats);
+                if (cpuAtomic->ReadBack() != trueMax)
+                {
+                    std::cout << "CPU atomic mismatch " << sizeName << " group " << threadGroupSize << ": " << cpuAtomic->ReadBack() << " != " << trueMax << std::endl;
+                    ++mismatches;
+                }
+                std::cout << "Atomic " << sizeName << " group " << threadGroupSize << ": emulator deviceAtomics " << atomicStats.deviceAtomics << ", atomicRetries " << atomicStats.atomicRetries
+                    << "; cpu deviceAtomics " << cpuAtomicStats.deviceAtomics << ", atomicRetries " << cpuAtomicStats.atomicRetries << std::endl;
+            }
+        }
+
+        // ComputeShader_groupshared_mem.hlsl on 256 texel wide textures where every group owns one output
+        // element, which receives the max of one of the 16 rows of its tile (0 for rows below the texture)
+        for (uint32_t height : { 256u, 100u })
+        {
+            const uint32_t width = 256;
+            std::vector<uint8_t> textureBytes = GenerateRandomTextureData(width, height);
+            std::vector<float> rowMaxima = EmulateRowMaxReduction(emulator, textureBytes, width, height);
+            for (uint32_t groupY = 0; groupY < (height + 15) / 16; ++groupY)
+            {
+                for (uint32_t groupX = 0; groupX < width / 16; ++groupX)
+                {
+                    bool matchesRow = false;
+                    for (uint32_t y = groupY * 16; y < groupY * 16 + 16; ++y)
+                    {
+                        const uint32_t rowMax = y < height ? ReduceMinMax(textureBytes.data() + static_cast<size_t>(y) * width + groupX * 16, 16, 1, width, TexelFormat::R8).maxValue : 0;
+                        matchesRow = matchesRow || rowMaxima[groupY * 16 + groupX] == rowMax / 255.0f;
+                    }
+                    if (!matchesRow)
+                    {
+                        std::cout << "Row mismatch 256x" << height << " group " << groupX << "," << groupY << ": " << rowMaxima[groupY * 16 + groupX] << std::endl;
+                        ++mismatches;
+                    }
+                }
+            }
+        }
+        std::cout << (mismatches == 0 ? "Emulated reductions match their references" : "Emulated reduction validation failed") << std::endl;
+        return mismatches == 0 ? 0 : 1;
+    }
 
-    // Load the compiled shader
-    ComPtr<ID3DBlob> computeShader8x8x1;
-    ComPtr<ID3DBlob> computeShader16x16x1;
-    ComPtr<ID3DBlob> computeShader32x32x1;
+    std::unique_ptr<IReductionBackend> backend;
+    std::unique_ptr<AsyncCaptureWriter> capture;
+    WorkStealingThreadPool generatorPool;
+    TextureDataText replay;
+    TextureDistribution distribution = TextureDistribution::Uniform;
+    TuningDatabase tuningDatabase;
     try
     {
-        computeShader8x8x1 = LoadCompiledShader(L"ComputeShader8x8x1.cso");
-        computeShader16x16x1 = LoadCompiledShader(L"ComputeShader16x16x1.cso");
-        computeShader32x32x1 = LoadCompiledShader(L"ComputeShader32x32x1.cso");
+        distribution = ParseTextureDistribution(distributionName);
+        backend = CreateReductionBackend(ParseReductionBackendType(backendName), ParseReductionStrategy(strategyName));
+        backend->CreateDevice();
+        if (autotune)
+        {
+            tuningDatabase.Load(tuningDatabaseFile);
+            if (deviceId.empty())
+            {
+                deviceId = backend->GetDeviceId();
+            }
+        }
+        if (!captureFile.empty())
+        {
+            capture = std::make_unique<AsyncCaptureWriter>(captureFile);
+        }
+        if (!replayFile.empty())
+        {
+            replay = LoadTextureDataText(replayFile);
+        }
     }
     catch (const std::exception& e)
     {
         std::cerr << e.what() << std::endl;
         return -1;
-    }    
+    }
 
     // Define texture dimensions
-    std::vector<std::pair<UINT, UINT>> textureSizes = 
+    std::vector<std::pair<uint32_t, uint32_t>> textureSizes =
     {
         {64, 64},
         {128, 128},
@@ -41,54 +440,209 @@ int main()
         {1024, 1024}
     };
 
-    ComPtr<ID3D12RootSignature> rootSignature;
-    ComPtr<ID3D12PipelineState> pipelineState;
+    // A replayed dump only has its own size
+    if (!replayFile.empty())
+    {
+        textureSizes = { { replay.width, replay.height } };
+    }
 
     // Define thread group sizes
-    std::vector<UINT> threadGroupSizes = { 8, 16, 32 };
+    std::vector<uint32_t> threadGroupSizes = { 8, 16, 32 };
+
+    const std::string timeLabel = mockTiming ? "Mock Time: " : ((backendName == "d3d12") ? "GPU Time: " : "CPU Time: ");
+    const BenchmarkOptions benchmarkOptions;
+    std::vector<BenchmarkResult> results;
+    ReductionAutotuner autotuner(tuningDatabase);
+    if (autotune)
+    {
+        TuningKey tuningKey;
+        tuningKey.deviceId = deviceId;
+        tuningKey.backend = backendName;
+        tuningKey.strategy = strategyName;
+        backend->SetAutotuner(&autotuner, tuningKey);
+    }
 
     // Measure performance over multiple runs for each texture size and thread group size
     for (const auto& size : textureSizes)
     {
-        UINT width = size.first;
-        UINT height = size.second;
+        uint32_t width = size.first;
+        uint32_t height = size.second;
 
         std::cout << "Texture Size: " << width << "x" << height << std::endl;
-        for (UINT threadGroupSize : threadGroupSizes)
+        if (replayFile.empty())
         {
-            std::cout << "Thread Group Size: " << threadGroupSize << "x" << threadGroupSize << std::endl;
-            if (threadGroupSize == 8)
+            std::cout << "Distribution: " << GetTextureDistributionName(distribution) << std::endl;
+        }
+        const TextureDistributionParams distributionParams = MakeTextureDistributionParams(distribution, width, height);
+
+        // Only the tuned variant is measured; the sweep runs on the first texture of the size
+        std::vector<uint32_t> sizeGroupSizes = threadGroupSizes;
+        if (autotune)
+        {
+            try
             {
-                pipelineState = CreateComputePipelineState(device.Get(), computeShader8x8x1, rootSignature);
+                std::vector<uint8_t> textureBytes = replayFile.empty() ? GenerateDistributionTextureData(seed, distributionParams, &generatorPool) : replay.texels;
+                backend->UploadTexture(textureBytes.data(), width, height, width);
+
+                // Dispatch and Submit run this variant for the size whatever group size they are given
+                TuningVariant variant;
+                bool tuned = false;
+                backend->SelectTuning(variant, &tuned);
+                sizeGroupSizes = { variant.threadGroupSize };
+                std::cout << "Tuned Variant: group " << variant.threadGroupSize
+                    << (variant.tileWidth ? ", host tile " + std::to_string(variant.tileWidth) + "x" + std::to_string(variant.tileHeight) : std::string())
+                    << ", workers " << (variant.workerCount ? std::to_string(variant.workerCount) : "all")
+                    << (tuned ? " (tuned now)" : " (from " + tuningDatabaseFile + ")") << std::endl;
             }
-            else if (threadGroupSize == 16)
+            catch (const std::exception& e)
             {
-                pipelineState = CreateComputePipelineState(device.Get(), computeShader16x16x1, rootSignature);
+                std::cerr << e.what() << std::endl;
+                return -1;
             }
-            else if (threadGroupSize == 32)
+        }
+
+        for (uint32_t threadGroupSize : sizeGroupSizes)
+        {
+            std::cout << "Thread Group Size: " << threadGroupSize << "x" << threadGroupSize << std::endl;
+
+            // Every sample is one run; warmup runs are reduced and captured too, only their time is dropped.
+            // Up to GetMaxJobsInFlight runs are submitted ahead, so the next texture is generated and
+            // recorded while the GPU still works on the previous ones.
+            std::vector<uint32_t> maxValues;
+            AtomicReductionStats atomicTotals;
+            uint64_t atomicRuns = 0;
+            std::deque<uint64_t> tickets;
+            const size_t jobsInFlight = backend->GetMaxJobsInFlight();
+            std::function<double()> mockSource = MakeMockTimingSource(0.01 + width * height * 2e-8, 0.05, 0.02, 2.5, threadGroupSize);
+            auto submitRun = [&]()
             {
-                pipelineState = CreateComputePipelineState(device.Get(), computeShader32x32x1, rootSignature);
-            }
-            else // default 16x16x1
-            {
-                pipelineState = CreateComputePipelineState(device.Get(), computeShader16x16x1, rootSignature);
-            }
+                // Initialize texture with random data or the replayed dump. Without a capture, which needs the
+                // texels on the host, generated data goes straight into the backend's upload memory.
+                const uint64_t runSeed = seed++;
+                std::vector<uint8_t> textureBytes;
+                if (replayFile.empty() && !capture)
+                {
+                    const TextureUploadRegion region = backend->BeginTextureUpload(width, height);
+                    GenerateDistributionTexture(runSeed, distributionParams, region.texels, region.rowPitch, region.writeCombined, &generatorPool);
+                    backend->EndTextureUpload();
+                }
+                else
+                {
+                    textureBytes = replayFile.empty() ? GenerateDistributionTextureData(runSeed, distributionParams, &generatorPool) : replay.texels;
+                    backend->UploadTexture(textureBytes.data(), width, height, width);
+                }
+                tickets.push_back(backend->Submit(threadGroupSize));
+
+                // The backend has its own copy, hand the texels to the writer thread
+                if (capture)
+                {
+                    // The seed only reproduces the texels through GeneratePhiloxTextureData, i.e. for uniform input
+                    const bool reproducible = replayFile.empty() && distribution == TextureDistribution::Uniform;
+                    capture->Submit(width, height, TexelFormat::R8, reproducible ? runSeed : 0, std::move(textureBytes));
+                }
+            };
+            auto takeOldestRun = [&]()
+            {
+                const ReductionResult run = backend->WaitResult(tickets.front());
+                tickets.pop_front();
+                maxValues.push_back(run.maxValue);
+                if (run.hasAtomicStats)
+                {
+                    atomicTotals.deviceAtomics += run.atomicStats.deviceAtomics;
+                    atomicTotals.atomicRetries += run.atomicStats.atomicRetries;
+                    ++atomicRuns;
+                }
+                return run.dispatchTimeMs;
+            };
+            auto runOnce = [&]()
+            {
+                while (tickets.size() < jobsInFlight)
+                {
+                    submitRun();
+                }
+                const double dispatchTimeMs = takeOldestRun();
+                return mockTiming ? mockSource() : dispatchTimeMs;
+            };
+
+            BenchmarkResult result;
+            try
             {
+                result.stats = RunBenchmark(benchmarkOptions, runOnce, &result.samplesMs);
+
+                // Runs submitted ahead of the last sample are reduced but not timed
+                while (!tickets.empty())
+                {
+                    takeOldestRun();
+                }
             }
-            const int numRuns = 10;
-            std::vector<UINT> maxValues;
-            for (int i = 0; i < numRuns; ++i)
+            catch (const std::exception& e)
             {
-                UINT maxValue = ReadBackR8UNormValues(device.Get(), commandQueue.Get(), commandList.Get(), commandAllocator.Get(), pipelineState.Get(), rootSignature.Get(), width, height, threadGroupSize);
-                maxValues.push_back(maxValue);
+                std::cerr << e.what() << std::endl;
+                return -1;
             }
+            WriteBenchmarkSummary(std::cout, timeLabel, result.stats);
 
             // Calculate the final maximum value
-            UINT finalMaxValue = *std::max_element(maxValues.begin(), maxValues.end());
+            uint32_t finalMaxValue = *std::max_element(maxValues.begin(), maxValues.end());
             std::cout << "Final Max Value: " << finalMaxValue << std::endl;
+            if (atomicRuns > 0)
+            {
+                result.hasAtomicStats = true;
+                result.deviceAtomics = static_cast<double>(atomicTotals.deviceAtomics) / atomicRuns;
+                result.atomicRetries = static_cast<double>(atomicTotals.atomicRetries) / atomicRuns;
+                std::cout << "Device Atomics: " << result.deviceAtomics << ", Atomic Retries: " << result.atomicRetries << " (per run)" << std::endl;
+            }
+
+            result.backend = backendName;
+            result.strategy = strategyName;
+            result.distribution = replayFile.empty() ? GetTextureDistributionName(distribution) : "replay";
+            result.width = width;
+            result.height = height;
+            result.threadGroupSize = threadGroupSize;
+            result.maxValue = finalMaxValue;
+            results.push_back(result);
             std::cout << "----------------------------------------------------" << std::endl;
         }
     }
 
+    if (autotune)
+    {
+        try
+        {
+            tuningDatabase.Save(tuningDatabaseFile);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+        }
+    }
+
+    // Structured results of every configuration
+    if (!jsonFile.empty())
+    {
+        std::ofstream json(jsonFile);
+        WriteBenchmarkJson(json, results);
+    }
+    if (!csvFile.empty())
+    {
+        std::ofstream csv(csvFile);
+        WriteBenchmarkCsv(csv, results);
+    }
+
+    if (capture)
+    {
+        try
+        {
+            capture->Flush();
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << e.what() << std::endl;
+            return -1;
+        }
+        CaptureWriterStats stats = capture->GetStats();
+        std::cout << "Captured " << stats.written << " textures (" << stats.bytesWritten << " bytes) to " << captureFile << std::endl;
+    }
+
     return 0;
-}
\ No newline at end of file
+}